@@ -16,6 +16,7 @@
 #include "core/outputlayer.h"
 #include "core/session.h"
 #include "drm_backend.h"
+#include "drm_commit.h"
 #include "drm_connector.h"
 #include "drm_crtc.h"
 #include "drm_egl_backend.h"
@@ -87,6 +88,7 @@ private Q_SLOTS:
     void testModeset_data();
     void testModeset();
     void testVrrChange();
+    void testTestCache();
 };
 
 static void verifyCleanup(MockGpu *mockGpu)
@@ -488,5 +490,64 @@ void DrmTest::testVrrChange()
     QVERIFY(output->capabilities() & Output::Capability::Vrr);
 }
 
+void DrmTest::testTestCache()
+{
+    const auto mockGpu = findPrimaryDevice(5);
+    mockGpu->deviceCaps[MOCKDRM_DEVICE_CAP_ATOMIC] = 1;
+
+    const auto conn = std::make_shared<MockConnector>(mockGpu.get());
+    mockGpu->connectors.push_back(conn);
+
+    const auto session = Session::create(Session::Type::Noop);
+    const auto backend = std::make_unique<DrmBackend>(session.get());
+    const auto renderBackend = backend->createQPainterBackend();
+    auto gpu = std::make_unique<DrmGpu>(backend.get(), mockGpu->fd, DrmDevice::open(mockGpu->devNode));
+
+    QVERIFY(gpu->updateOutputs());
+    DrmConnector *const connector = gpu->drmOutputs().front()->connector();
+    DrmTestCache *const cache = gpu->testCache();
+    const uint64_t hits = cache->hits();
+    int testOnlyCommits = mockGpu->testOnlyCommits;
+
+    // the first test has to hit the kernel, an identical one can be answered from the cache
+    DrmAtomicCommit commit(gpu.get());
+    commit.addProperty(connector->crtcId, 0);
+    QVERIFY(commit.testCached(cache));
+    QCOMPARE(mockGpu->testOnlyCommits, testOnlyCommits + 1);
+
+    DrmAtomicCommit identical(gpu.get());
+    identical.addProperty(connector->crtcId, 0);
+    QVERIFY(identical.testCached(cache));
+    QCOMPARE(mockGpu->testOnlyCommits, testOnlyCommits + 1);
+    QCOMPARE(cache->hits(), hits + 1);
+
+    // failures are cached as well, including the error
+    DrmAtomicCommit failing(gpu.get());
+    failing.addProperty(connector->crtcId, mockGpu->crtcs.front()->id);
+    QVERIFY(!failing.testCached(cache));
+    QCOMPARE(errno, EINVAL);
+    errno = 0;
+    QVERIFY(!failing.testCached(cache));
+    QCOMPARE(errno, EINVAL);
+    QCOMPARE(mockGpu->testOnlyCommits, testOnlyCommits + 2);
+
+    // hotplugs may change the kernel state, so they invalidate the cache
+    QVERIFY(gpu->updateOutputs());
+    testOnlyCommits = mockGpu->testOnlyCommits;
+    QVERIFY(identical.testCached(cache));
+    QCOMPARE(mockGpu->testOnlyCommits, testOnlyCommits + 1);
+
+    // whether an async flip passes depends on the current crtc state, so it's never cached
+    const uint64_t hitsBeforeAsync = cache->hits();
+    for (int i = 0; i < 2; ++i) {
+        DrmAtomicCommit tearing(gpu.get());
+        tearing.addProperty(connector->crtcId, 0);
+        tearing.setPresentationMode(PresentationMode::Async);
+        tearing.testCached(cache);
+        QCOMPARE(mockGpu->testOnlyCommits, testOnlyCommits + 2 + i);
+    }
+    QCOMPARE(cache->hits(), hitsBeforeAsync);
+}
+
 QTEST_GUILESS_MAIN(DrmTest)
 #include "mockDrmTest.moc"
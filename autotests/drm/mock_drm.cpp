@@ -972,6 +972,10 @@ int drmModeAtomicCommit(int fd, drmModeAtomicReqPtr req, uint32_t flags, void *u
         return -(errno = EINVAL);
     }
 
+    if (flags & DRM_MODE_ATOMIC_TEST_ONLY) {
+        gpu->testOnlyCommits++;
+    }
+
     // verify flags
     if ((flags & DRM_MODE_ATOMIC_NONBLOCK) && (flags & DRM_MODE_ATOMIC_ALLOW_MODESET)) {
         qWarning() << "NONBLOCK and MODESET are not allowed together";
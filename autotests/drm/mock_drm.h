@@ -166,6 +166,7 @@ public:
     QMap<uint32_t, uint64_t> deviceCaps;
 
     uint32_t idCounter = 1;
+    int testOnlyCommits = 0;
     QList<MockObject *> objects;
 
     QList<std::shared_ptr<MockConnector>> connectors;
@@ -0,0 +1,444 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "compositor.h"
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "cursor.h"
+#include "effect/effecthandler.h"
+#include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "opengl/glrendertimequery.h"
+#include "scene/windowitem.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <KWayland/Client/blur.h>
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/surface.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <numeric>
+#include <optional>
+
+/**
+ * The number of heap allocations is counted by replacing the global allocation functions of
+ * the test executable, which also covers all allocations done by libkwin.
+ */
+static std::atomic<uint64_t> s_allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+    const std::size_t alignedSize = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    if (void *ptr = std::aligned_alloc(align, alignedSize)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_compositing_benchmark-0");
+
+/**
+ * How the windows are damaged in every frame.
+ */
+enum class DamagePattern {
+    Cursor, // a blinking text cursor in the active window
+    Video, // a video playing in the active window
+    Full, // every window is repainted, e.g. while scrolling or during an animation
+};
+
+} // namespace KWin
+
+Q_DECLARE_METATYPE(KWin::DamagePattern)
+
+namespace KWin
+{
+
+struct FrameStatistics
+{
+    std::chrono::nanoseconds frameTime;
+    std::optional<std::chrono::nanoseconds> gpuTime;
+    uint64_t allocations;
+    bool missedDeadline;
+};
+
+struct PendingFrame
+{
+    std::chrono::nanoseconds frameTime;
+    uint64_t allocations;
+    std::chrono::nanoseconds targetTimestamp;
+    std::unique_ptr<GLRenderTimeQuery> query;
+};
+
+struct RunningFrame
+{
+    std::chrono::steady_clock::time_point start;
+    uint64_t allocations;
+    std::chrono::nanoseconds targetTimestamp;
+    std::unique_ptr<GLRenderTimeQuery> query;
+};
+
+static double toMilliseconds(std::chrono::nanoseconds duration)
+{
+    return duration.count() / 1'000'000.0;
+}
+
+static double percentile(QList<double> values, double p)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::ranges::sort(values);
+    return values[std::min<qsizetype>(std::ceil(values.size() * p), values.size()) - 1];
+}
+
+/**
+ * This benchmark replays synthetic workloads on the virtual backend and reports how long
+ * the compositor takes to handle a frame request (wall time, so work offloaded to other
+ * threads is included) and how long the frame takes on the GPU, how many heap allocations
+ * it does, and how many frames miss their target presentation time.
+ *
+ * The results are reported as QTest benchmark results (use e.g. "-o results.csv,csv") and,
+ * if KWIN_COMPOSITING_BENCHMARK_OUTPUT is set, written as JSON to the specified file.
+ */
+class CompositingBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+    void cleanupTestCase();
+
+    void benchmark_data();
+    void benchmark();
+
+private:
+    void hookOutput(Output *output);
+    void handleFrameRequestStarted(RenderLoop *renderLoop);
+    void handleFrameRequestFinished(RenderLoop *renderLoop);
+    void handleFramePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp);
+    void damage();
+
+    QSet<RenderLoop *> m_hookedRenderLoops;
+    bool m_measuring = false;
+    std::optional<RunningFrame> m_currentFrame;
+    std::deque<PendingFrame> m_pendingFrames;
+    QList<FrameStatistics> m_frames;
+    DamagePattern m_damagePattern = DamagePattern::Full;
+    std::vector<std::unique_ptr<Test::XdgToplevelWindow>> m_windows;
+    std::vector<std::unique_ptr<KWayland::Client::Blur>> m_blurs;
+    QJsonArray m_results;
+};
+
+void CompositingBenchmark::initTestCase()
+{
+    if (!Test::renderNodeAvailable()) {
+        QSKIP("no render node available");
+    }
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    qRegisterMetaType<Window *>();
+
+    QVERIFY(waylandServer()->init(s_socketName));
+    kwinApp()->start();
+
+    effects->unloadAllEffects();
+
+    connect(Compositor::self(), &Compositor::frameRequestStarted, this, &CompositingBenchmark::handleFrameRequestStarted);
+    connect(Compositor::self(), &Compositor::frameRequestFinished, this, &CompositingBenchmark::handleFrameRequestFinished);
+}
+
+void CompositingBenchmark::cleanup()
+{
+    m_measuring = false;
+    m_currentFrame.reset();
+    m_pendingFrames.clear();
+    m_frames.clear();
+    m_blurs.clear();
+    m_windows.clear();
+    effects->unloadAllEffects();
+    Test::destroyWaylandConnection();
+}
+
+void CompositingBenchmark::cleanupTestCase()
+{
+    const QByteArray path = qgetenv("KWIN_COMPOSITING_BENCHMARK_OUTPUT");
+    if (path.isEmpty()) {
+        return;
+    }
+    QFile file(QString::fromLocal8Bit(path));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QJsonDocument(m_results).toJson());
+}
+
+void CompositingBenchmark::hookOutput(Output *output)
+{
+    RenderLoop *renderLoop = output->renderLoop();
+    if (m_hookedRenderLoops.contains(renderLoop)) {
+        return;
+    }
+    m_hookedRenderLoops.insert(renderLoop);
+
+    connect(renderLoop, &RenderLoop::framePresented, this, [this](RenderLoop *loop, std::chrono::nanoseconds timestamp) {
+        handleFramePresented(loop, timestamp);
+    });
+    connect(renderLoop, &QObject::destroyed, this, [this, renderLoop]() {
+        m_hookedRenderLoops.remove(renderLoop);
+    });
+}
+
+// the whole frame request is measured so that deferred surface commits and coalesced
+// pointer motion are flushed like in production
+void CompositingBenchmark::handleFrameRequestStarted(RenderLoop *renderLoop)
+{
+    if (!m_measuring || !m_hookedRenderLoops.contains(renderLoop)) {
+        return;
+    }
+
+    auto backend = static_cast<EglBackend *>(Compositor::self()->backend());
+    backend->openglContext()->makeCurrent();
+
+    auto query = std::make_unique<GLRenderTimeQuery>(backend->openglContextRef());
+    const std::chrono::nanoseconds targetTimestamp = renderLoop->nextPresentationTimestamp();
+    query->begin();
+
+    m_currentFrame = RunningFrame{
+        .start = std::chrono::steady_clock::now(),
+        .allocations = s_allocationCount.load(std::memory_order_relaxed),
+        .targetTimestamp = targetTimestamp,
+        .query = std::move(query),
+    };
+}
+
+void CompositingBenchmark::handleFrameRequestFinished(RenderLoop *renderLoop)
+{
+    if (!m_currentFrame || !m_hookedRenderLoops.contains(renderLoop)) {
+        return;
+    }
+
+    const std::chrono::nanoseconds frameTime = std::chrono::steady_clock::now() - m_currentFrame->start;
+    const uint64_t allocations = s_allocationCount.load(std::memory_order_relaxed) - m_currentFrame->allocations;
+
+    auto backend = static_cast<EglBackend *>(Compositor::self()->backend());
+    backend->openglContext()->makeCurrent();
+    m_currentFrame->query->end();
+
+    m_pendingFrames.push_back(PendingFrame{
+        .frameTime = frameTime,
+        .allocations = allocations,
+        .targetTimestamp = m_currentFrame->targetTimestamp,
+        .query = std::move(m_currentFrame->query),
+    });
+    m_currentFrame.reset();
+}
+
+void CompositingBenchmark::handleFramePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp)
+{
+    if (!m_measuring || m_pendingFrames.empty()) {
+        return;
+    }
+
+    PendingFrame frame = std::move(m_pendingFrames.front());
+    m_pendingFrames.pop_front();
+
+    frame.query->query();
+    const std::chrono::nanoseconds refreshDuration(1'000'000'000'000ull / renderLoop->refreshRate());
+    m_frames.append(FrameStatistics{
+        .frameTime = frame.frameTime,
+        .gpuTime = frame.query->gpuTime(),
+        .allocations = frame.allocations,
+        .missedDeadline = timestamp > frame.targetTimestamp + refreshDuration / 2,
+    });
+
+    damage();
+}
+
+void CompositingBenchmark::damage()
+{
+    switch (m_damagePattern) {
+    case DamagePattern::Cursor:
+        m_windows.back()->m_window->windowItem()->scheduleRepaint(QRegion(40, 40, 2, 18));
+        break;
+    case DamagePattern::Video:
+        m_windows.back()->m_window->windowItem()->scheduleRepaint(QRegion(10, 10, 160, 90));
+        break;
+    case DamagePattern::Full:
+        for (const auto &window : m_windows) {
+            WindowItem *item = window->m_window->windowItem();
+            item->scheduleRepaint(item->boundingRect());
+        }
+        break;
+    }
+}
+
+void CompositingBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("windowCount");
+    QTest::addColumn<DamagePattern>("damagePattern");
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<QString>("effect");
+
+    QTest::addRow("cursor, 8 windows") << 8 << DamagePattern::Cursor << 1.0 << QString();
+    QTest::addRow("video, 8 windows") << 8 << DamagePattern::Video << 1.0 << QString();
+    QTest::addRow("full, 8 windows") << 8 << DamagePattern::Full << 1.0 << QString();
+    QTest::addRow("full, 32 windows") << 32 << DamagePattern::Full << 1.0 << QString();
+    QTest::addRow("full, 32 windows, scale 1.5") << 32 << DamagePattern::Full << 1.5 << QString();
+    QTest::addRow("video, 8 windows, scale 1.25") << 8 << DamagePattern::Video << 1.25 << QString();
+    QTest::addRow("video, 8 windows, blur") << 8 << DamagePattern::Video << 1.0 << QStringLiteral("blur");
+    QTest::addRow("full, 32 windows, blur") << 32 << DamagePattern::Full << 1.0 << QStringLiteral("blur");
+    QTest::addRow("cursor, 8 windows, overview") << 8 << DamagePattern::Cursor << 1.0 << QStringLiteral("overview");
+}
+
+void CompositingBenchmark::benchmark()
+{
+    QFETCH(int, windowCount);
+    QFETCH(DamagePattern, damagePattern);
+    QFETCH(qreal, scale);
+    QFETCH(QString, effect);
+
+    static constexpr int frameCount = 300;
+
+    Test::setOutputConfig({Test::OutputInfo{
+        .geometry = QRect(0, 0, 1920, 1080),
+        .scale = scale,
+    }});
+    Output *output = workspace()->outputs().front();
+    hookOutput(output);
+    Cursors::self()->hideCursor();
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::Seat | Test::AdditionalWaylandInterface::PresentationTime));
+
+    std::unique_ptr<KWayland::Client::BlurManager> blurManager;
+    if (!effect.isEmpty()) {
+        if (!effects->loadEffect(effect)) {
+            QSKIP(qPrintable(QStringLiteral("%1 effect is not available").arg(effect)));
+        }
+        if (effect == QLatin1String("blur")) {
+            KWayland::Client::Registry registry;
+            QSignalSpy blurAnnounced(&registry, &KWayland::Client::Registry::blurAnnounced);
+            registry.create(Test::waylandConnection());
+            registry.setup();
+            QVERIFY(blurAnnounced.wait());
+            blurManager.reset(registry.createBlurManager(blurAnnounced.first().first().value<quint32>(), blurAnnounced.first().last().value<quint32>()));
+        }
+    }
+
+    for (int i = 0; i < windowCount; ++i) {
+        // blurred windows need to be translucent for the blur to be visible
+        QImage image(QSize(400, 300), blurManager ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        image.fill(QColor::fromHsv(i * 360 / windowCount, 255, 255, blurManager ? 180 : 255));
+
+        auto window = std::make_unique<Test::XdgToplevelWindow>();
+        QVERIFY(window->show(image));
+        window->m_window->move(QPoint(i * 97 % 1500, i * 61 % 760));
+
+        if (blurManager) {
+            auto blur = std::unique_ptr<KWayland::Client::Blur>(blurManager->createBlur(window->m_surface.get()));
+            blur->commit();
+            QVERIFY(window->presentWait());
+            m_blurs.push_back(std::move(blur));
+        }
+        m_windows.push_back(std::move(window));
+    }
+
+    if (effect == QLatin1String("overview")) {
+        QVERIFY(QMetaObject::invokeMethod(effects->findEffect(effect), "activate"));
+    }
+
+    m_damagePattern = damagePattern;
+    m_measuring = true;
+    damage();
+    QTRY_VERIFY_WITH_TIMEOUT(m_frames.size() >= frameCount, 60'000);
+    m_measuring = false;
+
+    QList<double> frameTimes;
+    QList<double> gpuTimes;
+    QList<double> allocations;
+    int missedDeadlines = 0;
+    for (const FrameStatistics &frame : std::as_const(m_frames)) {
+        frameTimes.append(toMilliseconds(frame.frameTime));
+        if (frame.gpuTime) {
+            gpuTimes.append(toMilliseconds(*frame.gpuTime));
+        }
+        allocations.append(frame.allocations);
+        if (frame.missedDeadline) {
+            missedDeadlines++;
+        }
+    }
+
+    const auto mean = [](const QList<double> &values) {
+        return values.isEmpty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    };
+
+    const QJsonObject result{
+        {QStringLiteral("workload"), QString::fromUtf8(QTest::currentDataTag())},
+        {QStringLiteral("frames"), m_frames.size()},
+        {QStringLiteral("frameTimeMeanMs"), mean(frameTimes)},
+        {QStringLiteral("frameTimeP50Ms"), percentile(frameTimes, 0.5)},
+        {QStringLiteral("frameTimeP95Ms"), percentile(frameTimes, 0.95)},
+        {QStringLiteral("gpuTimeMeanMs"), mean(gpuTimes)},
+        {QStringLiteral("gpuTimeP95Ms"), percentile(gpuTimes, 0.95)},
+        {QStringLiteral("allocationsPerFrame"), mean(allocations)},
+        {QStringLiteral("missedDeadlines"), missedDeadlines},
+    };
+    m_results.append(result);
+    qInfo().noquote() << QJsonDocument(result).toJson(QJsonDocument::Compact);
+
+    QTest::setBenchmarkResult(mean(frameTimes), QTest::WalltimeMilliseconds);
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::CompositingBenchmark)
+#include "compositing_benchmark.moc"
@@ -0,0 +1,173 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "backends/virtual/virtual_egl_backend.h"
+#include "compositor.h"
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "cursor.h"
+#include "effect/effecthandler.h"
+#include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <KConfigGroup>
+#include <KWayland/Client/blur.h>
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/surface.h>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_effects_blur-0");
+
+class BlurTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void testComputeMatchesFragment();
+
+private:
+    QImage renderFrame();
+};
+
+void BlurTest::initTestCase()
+{
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    qRegisterMetaType<Window *>();
+
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    // the noise texture is random, so it would differ between two instances of the effect
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group(QStringLiteral("Effect-blur")).writeEntry(QStringLiteral("NoiseStrength"), 0);
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    kwinApp()->start();
+
+    Test::setOutputConfig({
+        QRect(0, 0, 1280, 1024),
+    });
+
+    effects->unloadAllEffects();
+}
+
+void BlurTest::cleanup()
+{
+    effects->unloadAllEffects();
+    qunsetenv("KWIN_BLUR_COMPUTE");
+    Test::destroyWaylandConnection();
+}
+
+QImage BlurTest::renderFrame()
+{
+    Output *output = workspace()->outputs().front();
+    const auto layer = static_cast<VirtualEglLayer *>(Compositor::self()->backend()->compatibleOutputLayers(output).front());
+
+    // repaint everything a few times, to make sure the swapchain is up to date
+    for (int i = 0; i < 3; i++) {
+        effects->addRepaintFull();
+        QSignalSpy framePresented(output->renderLoop(), &RenderLoop::framePresented);
+        if (!framePresented.wait()) {
+            return QImage();
+        }
+    }
+    return layer->texture()->toImage();
+}
+
+void BlurTest::testComputeMatchesFragment()
+{
+    // this test verifies that the compute shader path of the blur effect
+    // produces the same result as the fragment shader path
+    const auto backend = static_cast<EglBackend *>(Compositor::self()->backend());
+    if (!backend->openglContext()->supportsComputeShaders()) {
+        QSKIP("compute shaders are not supported");
+    }
+
+    qputenv("KWIN_BLUR_COMPUTE", QByteArrayLiteral("0"));
+    QVERIFY(effects->loadEffect(QStringLiteral("blur")));
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::Seat | Test::AdditionalWaylandInterface::PresentationTime));
+    KWayland::Client::Registry registry;
+    QSignalSpy blurAnnounced(&registry, &KWayland::Client::Registry::blurAnnounced);
+    registry.create(Test::waylandConnection());
+    registry.setup();
+    QVERIFY(blurAnnounced.wait());
+    std::unique_ptr<KWayland::Client::BlurManager> blurManager(registry.createBlurManager(blurAnnounced.first().first().value<quint32>(), blurAnnounced.first().last().value<quint32>()));
+
+    // a background with sharp edges, so that the blur is clearly visible
+    QImage pattern(QSize(1280, 1024), QImage::Format_RGB32);
+    for (int y = 0; y < pattern.height(); y++) {
+        for (int x = 0; x < pattern.width(); x++) {
+            pattern.setPixel(x, y, ((x / 8 + y / 8) % 2) ? qRgb(255, 255, 255) : qRgb(x % 256, 0, y % 256));
+        }
+    }
+    Test::XdgToplevelWindow background;
+    QVERIFY(background.show(pattern));
+    background.m_window->move(QPoint(0, 0));
+
+    QImage translucent(QSize(400, 300), QImage::Format_ARGB32_Premultiplied);
+    translucent.fill(QColor(0, 0, 0, 60));
+    Test::XdgToplevelWindow window;
+    QVERIFY(window.show(translucent));
+    window.m_window->move(QPoint(100, 100));
+    std::unique_ptr<KWayland::Client::Blur> blur(blurManager->createBlur(window.m_surface.get()));
+    blur->commit();
+    QVERIFY(window.presentWait());
+
+    Cursors::self()->hideCursor();
+
+    const QImage fragmentResult = renderFrame();
+    QVERIFY(!fragmentResult.isNull());
+    QCOMPARE(effects->findEffect(QStringLiteral("blur"))->property("computeDispatchCount").toULongLong(), qulonglong(0));
+
+    effects->unloadEffect(QStringLiteral("blur"));
+    qputenv("KWIN_BLUR_COMPUTE", QByteArrayLiteral("1"));
+    QVERIFY(effects->loadEffect(QStringLiteral("blur")));
+
+    const QImage computeResult = renderFrame();
+    QVERIFY(!computeResult.isNull());
+    QCOMPARE(computeResult.size(), fragmentResult.size());
+    // the compute passes silently fall back to the fragment passes, e.g. if the shaders don't compile
+    QVERIFY(effects->findEffect(QStringLiteral("blur"))->property("computeDispatchCount").toULongLong() > 0);
+
+    // both paths sample the same texels, allow for small rounding differences
+    int maxDifference = 0;
+    for (int y = 0; y < fragmentResult.height(); y++) {
+        for (int x = 0; x < fragmentResult.width(); x++) {
+            const QRgb a = fragmentResult.pixel(x, y);
+            const QRgb b = computeResult.pixel(x, y);
+            maxDifference = std::max({maxDifference,
+                                      std::abs(qRed(a) - qRed(b)),
+                                      std::abs(qGreen(a) - qGreen(b)),
+                                      std::abs(qBlue(a) - qBlue(b))});
+        }
+    }
+    QCOMPARE_LE(maxDifference, 2);
+
+    // and the blur must actually be visible
+    effects->unloadEffect(QStringLiteral("blur"));
+    const QImage unblurredResult = renderFrame();
+    QVERIFY(!unblurredResult.isNull());
+    QVERIFY(unblurredResult != fragmentResult);
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::BlurTest)
+#include "blur_test.moc"
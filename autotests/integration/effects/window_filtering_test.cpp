@@ -0,0 +1,259 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "effect/effecthandler.h"
+#include "effect/effectloader.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+using namespace std::chrono_literals;
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_effects_window_filtering-0");
+
+class CountingEffect : public Effect
+{
+    Q_OBJECT
+
+public:
+    bool isActive() const override
+    {
+        return true;
+    }
+
+    void prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime) override
+    {
+        prePaintWindowCalls[w]++;
+        effects->prePaintWindow(view, w, data, presentTime);
+    }
+
+    void paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data) override
+    {
+        paintWindowCalls[w]++;
+        effects->paintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
+    }
+
+    void postPaintWindow(EffectWindow *w) override
+    {
+        postPaintWindowCalls[w]++;
+        effects->postPaintWindow(w);
+    }
+
+    int callCount() const
+    {
+        int count = 0;
+        for (const auto &calls : {prePaintWindowCalls, paintWindowCalls, postPaintWindowCalls}) {
+            for (int value : calls) {
+                count += value;
+            }
+        }
+        return count;
+    }
+
+    void reset()
+    {
+        prePaintWindowCalls.clear();
+        paintWindowCalls.clear();
+        postPaintWindowCalls.clear();
+    }
+
+    QHash<EffectWindow *, int> prePaintWindowCalls;
+    QHash<EffectWindow *, int> paintWindowCalls;
+    QHash<EffectWindow *, int> postPaintWindowCalls;
+};
+
+class WindowFilteringTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testFilteredEffectSkipsWindows();
+    void benchmarkWindowChain_data();
+    void benchmarkWindowChain();
+
+private:
+    CountingEffect *loadCountingEffect(const QString &name, bool filtered);
+    bool renderFrame();
+};
+
+void WindowFilteringTest::initTestCase()
+{
+    qRegisterMetaType<KWin::Effect *>();
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    const auto builtinNames = EffectLoader().listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    kwinApp()->start();
+    Test::setOutputConfig({
+        QRect(0, 0, 1280, 1024),
+    });
+}
+
+void WindowFilteringTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void WindowFilteringTest::cleanup()
+{
+    effects->unloadAllEffects();
+    Test::destroyWaylandConnection();
+}
+
+CountingEffect *WindowFilteringTest::loadCountingEffect(const QString &name, bool filtered)
+{
+    // the effects are not plugins, so they have to be injected like the effect loader would do it
+    auto effect = new CountingEffect();
+    effects->setWindowFilteringEnabled(effect, filtered);
+    Q_EMIT effects->findChild<EffectLoader *>()->effectLoaded(effect, name);
+    return effect;
+}
+
+bool WindowFilteringTest::renderFrame()
+{
+    Output *output = workspace()->outputs().front();
+    effects->addRepaintFull();
+    QSignalSpy framePresented(output->renderLoop(), &RenderLoop::framePresented);
+    return framePresented.wait();
+}
+
+void WindowFilteringTest::testFilteredEffectSkipsWindows()
+{
+    // this test verifies that an effect with window filtering enabled is called
+    // only for the windows that it has registered
+
+    Test::XdgToplevelWindow first;
+    QVERIFY(first.show(QSize(100, 100), Qt::red));
+    first.m_window->move(QPoint(0, 0));
+    Test::XdgToplevelWindow second;
+    QVERIFY(second.show(QSize(100, 100), Qt::green));
+    second.m_window->move(QPoint(200, 0));
+    EffectWindow *firstWindow = first.m_window->effectWindow();
+    EffectWindow *secondWindow = second.m_window->effectWindow();
+
+    CountingEffect *unfiltered = loadCountingEffect(QStringLiteral("unfiltered"), false);
+    CountingEffect *filtered = loadCountingEffect(QStringLiteral("filtered"), true);
+    QVERIFY(effects->isEffectLoaded(QStringLiteral("unfiltered")));
+    QVERIFY(effects->isEffectLoaded(QStringLiteral("filtered")));
+
+    // without any registered windows, the filtered effect is skipped entirely
+    QVERIFY(renderFrame());
+    QVERIFY(unfiltered->prePaintWindowCalls.value(firstWindow) > 0);
+    QVERIFY(unfiltered->paintWindowCalls.value(firstWindow) > 0);
+    QVERIFY(unfiltered->postPaintWindowCalls.value(secondWindow) > 0);
+    QCOMPARE(filtered->callCount(), 0);
+
+    // a registered window goes through the filtered effect, the other ones still don't
+    effects->addAffectedWindow(filtered, secondWindow);
+    unfiltered->reset();
+    QVERIFY(renderFrame());
+    QVERIFY(filtered->prePaintWindowCalls.value(secondWindow) > 0);
+    QVERIFY(filtered->paintWindowCalls.value(secondWindow) > 0);
+    QVERIFY(filtered->postPaintWindowCalls.value(secondWindow) > 0);
+    QCOMPARE(filtered->prePaintWindowCalls.value(firstWindow), 0);
+    QCOMPARE(filtered->paintWindowCalls.value(firstWindow), 0);
+    QCOMPARE(filtered->postPaintWindowCalls.value(firstWindow), 0);
+
+    // skipping an effect must not affect the effects that come after it in the chain
+    QVERIFY(unfiltered->prePaintWindowCalls.value(firstWindow) > 0);
+    QVERIFY(unfiltered->paintWindowCalls.value(firstWindow) > 0);
+    QVERIFY(unfiltered->prePaintWindowCalls.value(secondWindow) > 0);
+    QVERIFY(unfiltered->paintWindowCalls.value(secondWindow) > 0);
+
+    effects->removeAffectedWindow(filtered, secondWindow);
+    filtered->reset();
+    QVERIFY(renderFrame());
+    QCOMPARE(filtered->callCount(), 0);
+
+    // disabling the filtering restores the default behavior
+    effects->setWindowFilteringEnabled(filtered, false);
+    QVERIFY(renderFrame());
+    QVERIFY(filtered->prePaintWindowCalls.value(firstWindow) > 0);
+    QVERIFY(filtered->prePaintWindowCalls.value(secondWindow) > 0);
+}
+
+void WindowFilteringTest::benchmarkWindowChain_data()
+{
+    QTest::addColumn<bool>("filtered");
+
+    QTest::addRow("unfiltered") << false;
+    QTest::addRow("filtered") << true;
+}
+
+void WindowFilteringTest::benchmarkWindowChain()
+{
+    // this benchmark walks the window paint chain of many windows through a dozen active
+    // effects, each of which animates a single window if filtering is enabled
+    QFETCH(bool, filtered);
+
+    const int windowCount = 60;
+    const int effectCount = 12;
+
+    std::vector<std::unique_ptr<Test::XdgToplevelWindow>> toplevels;
+    QList<EffectWindow *> windows;
+    for (int i = 0; i < windowCount; ++i) {
+        auto toplevel = std::make_unique<Test::XdgToplevelWindow>();
+        QVERIFY(toplevel->show(QSize(64, 64)));
+        windows.append(toplevel->m_window->effectWindow());
+        toplevels.push_back(std::move(toplevel));
+    }
+
+    QList<CountingEffect *> countingEffects;
+    for (int i = 0; i < effectCount; ++i) {
+        CountingEffect *effect = loadCountingEffect(QStringLiteral("counting%1").arg(i), filtered);
+        effects->addAffectedWindow(effect, windows[i]);
+        countingEffects.append(effect);
+    }
+
+    const auto paintWindows = [&windows]() {
+        for (EffectWindow *window : std::as_const(windows)) {
+            WindowPrePaintData data;
+            data.mask = 0;
+            effects->prePaintWindow(nullptr, window, data, 0ms);
+        }
+        for (EffectWindow *window : std::as_const(windows)) {
+            effects->postPaintWindow(window);
+        }
+    };
+
+    effects->startPaint();
+    paintWindows();
+
+    int callCount = 0;
+    for (CountingEffect *effect : std::as_const(countingEffects)) {
+        callCount += effect->callCount();
+    }
+    QCOMPARE(callCount, filtered ? effectCount * 2 : effectCount * windowCount * 2);
+
+    QBENCHMARK {
+        paintWindows();
+    }
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::WindowFilteringTest)
+#include "window_filtering_test.moc"
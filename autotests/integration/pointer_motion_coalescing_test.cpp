@@ -0,0 +1,132 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "input_event.h"
+#include "input_event_spy.h"
+#include "pointer_input.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <linux/input.h>
+
+using namespace std::chrono_literals;
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_pointer_motion_coalescing-0");
+
+class MotionEventSpy : public InputEventSpy
+{
+public:
+    void pointerMotion(PointerMotionEvent *event) override
+    {
+        motionEvents.append(*event);
+    }
+
+    void pointerButton(PointerButtonEvent *event) override
+    {
+        motionEventsBeforeButton = motionEvents.count();
+    }
+
+    QList<PointerMotionEvent> motionEvents;
+    int motionEventsBeforeButton = -1;
+};
+
+class PointerMotionCoalescingTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testCoalesceUntilFrame();
+    void testFlushBeforeButton();
+
+private:
+    std::unique_ptr<MotionEventSpy> m_spy;
+};
+
+void PointerMotionCoalescingTest::initTestCase()
+{
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    qputenv("KWIN_POINTER_COALESCE_MOTION", QByteArrayLiteral("1"));
+
+    kwinApp()->start();
+    Test::setOutputConfig({
+        QRect(0, 0, 1280, 1024),
+    });
+}
+
+void PointerMotionCoalescingTest::init()
+{
+    input()->pointer()->warp(QPointF(640, 512));
+    m_spy = std::make_unique<MotionEventSpy>();
+    input()->installInputEventSpy(m_spy.get());
+}
+
+void PointerMotionCoalescingTest::cleanup()
+{
+    input()->uninstallInputEventSpy(m_spy.get());
+    m_spy.reset();
+}
+
+void PointerMotionCoalescingTest::testCoalesceUntilFrame()
+{
+    // this test verifies that the relative motion events that arrive between two frames are
+    // processed as a single event, which still carries every sample
+
+    quint32 timestamp = 1;
+    for (int i = 0; i < 8; ++i) {
+        Test::pointerMotionRelative(QPointF(1, 2), timestamp++);
+    }
+    QCOMPARE(m_spy->motionEvents.count(), 0);
+    QCOMPARE(input()->pointer()->pos(), QPointF(640, 512));
+
+    QSignalSpy framePresented(workspace()->outputs().front()->renderLoop(), &RenderLoop::framePresented);
+    QVERIFY(framePresented.wait());
+
+    QCOMPARE(m_spy->motionEvents.count(), 1);
+    const PointerMotionEvent &event = m_spy->motionEvents.first();
+    QCOMPARE(event.position, QPointF(648, 528));
+    QCOMPARE(event.delta, QPointF(8, 16));
+    QCOMPARE(event.deltaUnaccelerated, QPointF(8, 16));
+    QCOMPARE(event.timestamp, 8ms);
+    QCOMPARE(event.history.count(), 8);
+    for (int i = 0; i < event.history.count(); ++i) {
+        QCOMPARE(event.history[i].delta, QPointF(1, 2));
+        QCOMPARE(event.history[i].timestamp, std::chrono::milliseconds(i + 1));
+    }
+    QCOMPARE(input()->pointer()->pos(), QPointF(648, 528));
+}
+
+void PointerMotionCoalescingTest::testFlushBeforeButton()
+{
+    // this test verifies that pending motion is processed before a button event, so the
+    // button is pressed at the right position
+
+    quint32 timestamp = 1;
+    Test::pointerMotionRelative(QPointF(10, 0), timestamp++);
+    Test::pointerMotionRelative(QPointF(10, 0), timestamp++);
+    QCOMPARE(m_spy->motionEvents.count(), 0);
+
+    Test::pointerButtonPressed(BTN_LEFT, timestamp++);
+    QCOMPARE(m_spy->motionEventsBeforeButton, 1);
+    QCOMPARE(m_spy->motionEvents.first().position, QPointF(660, 512));
+    Test::pointerButtonReleased(BTN_LEFT, timestamp++);
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::PointerMotionCoalescingTest)
+#include "pointer_motion_coalescing_test.moc"
@@ -0,0 +1,101 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "backends/virtual/virtual_egl_backend.h"
+#include "compositor.h"
+#include "cursor.h"
+#include "effect/effecthandler.h"
+#include "scene/workspacescene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_scene_parallel_prepare-0");
+
+class SceneParallelPrepareTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void testMatchesSerial();
+};
+
+void SceneParallelPrepareTest::initTestCase()
+{
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    qRegisterMetaType<Window *>();
+
+    QVERIFY(waylandServer()->init(s_socketName));
+    kwinApp()->start();
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::Seat | Test::AdditionalWaylandInterface::PresentationTime));
+
+    Test::setOutputConfig({Test::OutputInfo{
+        .geometry = QRect(0, 0, 1280, 1024),
+    }});
+
+    // make sure open/close effects don't get in the way
+    // of image comparisons
+    effects->unloadAllEffects();
+}
+
+void SceneParallelPrepareTest::cleanup()
+{
+    Compositor::self()->scene()->setParallelPreparation(WorkspaceScene::ParallelPreparation::Automatic);
+    Test::destroyWaylandConnection();
+}
+
+void SceneParallelPrepareTest::testMatchesSerial()
+{
+    // this test verifies that preparing the scene on worker threads produces exactly the
+    // same frame as preparing it on the main thread
+    Cursors::self()->hideCursor();
+
+    Output *output = workspace()->outputs().front();
+    std::vector<std::unique_ptr<Test::XdgToplevelWindow>> windows;
+    for (int i = 0; i < 24; i++) {
+        // mix opaque and translucent windows so that occlusion culling has something to do
+        QImage image(QSize(200, 150), i % 3 == 0 ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        image.fill(QColor::fromHsv(i * 15, 255, 255, i % 3 == 0 ? 128 : 255));
+
+        auto window = std::make_unique<Test::XdgToplevelWindow>();
+        QVERIFY(window->show(image));
+        window->m_window->move(output->geometry().topLeft() + QPoint(i * 37 % 1000, i * 29 % 800));
+        windows.push_back(std::move(window));
+    }
+
+    const auto layer = static_cast<VirtualEglLayer *>(Compositor::self()->backend()->compatibleOutputLayers(output).front());
+    auto renderFrame = [&](WorkspaceScene::ParallelPreparation mode) {
+        Compositor::self()->scene()->setParallelPreparation(mode);
+        Compositor::self()->scene()->addRepaintFull();
+        // render a few frames, to make sure the whole swapchain has been repainted
+        for (int i = 0; i < 3; i++) {
+            if (!windows.back()->presentWait()) {
+                return QImage();
+            }
+        }
+        return layer->texture()->toImage();
+    };
+
+    const QImage serial = renderFrame(WorkspaceScene::ParallelPreparation::Never);
+    QVERIFY(!serial.isNull());
+    const QImage parallel = renderFrame(WorkspaceScene::ParallelPreparation::Always);
+    QVERIFY(!parallel.isNull());
+    QCOMPARE(parallel, serial);
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::SceneParallelPrepareTest)
+#include "scene_parallel_prepare_test.moc"
@@ -0,0 +1,120 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "backends/virtual/virtual_qpainter_backend.h"
+#include "compositor.h"
+#include "core/output.h"
+#include "cursor.h"
+#include "effect/effecthandler.h"
+#include "scene/itemrenderer_qpainter.h"
+#include "scene/workspacescene.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <QThreadPool>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_scene_qpainter_parallel-0");
+
+class SceneQPainterParallelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void testMatchesSerial_data();
+    void testMatchesSerial();
+};
+
+void SceneQPainterParallelTest::initTestCase()
+{
+    qRegisterMetaType<Window *>();
+
+    // the frame is split into as many bands as there are threads, so make sure that there
+    // are several of them even on a single core machine
+    QThreadPool::globalInstance()->setMaxThreadCount(4);
+
+    QVERIFY(waylandServer()->init(s_socketName));
+    kwinApp()->start();
+
+    // make sure open/close effects don't get in the way
+    // of image comparisons
+    effects->unloadAllEffects();
+}
+
+void SceneQPainterParallelTest::cleanup()
+{
+    static_cast<ItemRendererQPainter *>(Compositor::self()->scene()->renderer())->setParallelRendering(ItemRendererQPainter::ParallelRendering::Automatic);
+    Test::destroyWaylandConnection();
+}
+
+void SceneQPainterParallelTest::testMatchesSerial_data()
+{
+    QTest::addColumn<qreal>("scale");
+
+    QTest::addRow("scale 1") << 1.0;
+    QTest::addRow("scale 1.5") << 1.5;
+}
+
+void SceneQPainterParallelTest::testMatchesSerial()
+{
+    // this test verifies that painting the frame in bands on worker threads produces exactly
+    // the same frame as painting it on the main thread
+    QFETCH(qreal, scale);
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::Seat | Test::AdditionalWaylandInterface::PresentationTime));
+    Test::setOutputConfig({Test::OutputInfo{
+        .geometry = QRect(0, 0, 1280, 1024),
+        .scale = scale,
+    }});
+    Cursors::self()->hideCursor();
+
+    Output *output = workspace()->outputs().front();
+    std::vector<std::unique_ptr<Test::XdgToplevelWindow>> windows;
+    for (int i = 0; i < 24; i++) {
+        // overlapping opaque and translucent windows, some of them crossing band boundaries
+        QImage image(QSize(200, 150), i % 3 == 0 ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        image.fill(QColor::fromHsv(i * 15, 255, 255, i % 3 == 0 ? 128 : 255));
+
+        auto window = std::make_unique<Test::XdgToplevelWindow>();
+        QVERIFY(window->show(image));
+        window->m_window->move(output->geometry().topLeft() + QPoint(i * 37 % 1000, i * 29 % 800));
+        windows.push_back(std::move(window));
+    }
+    windows[5]->m_window->setOpacity(0.5);
+
+    auto renderer = static_cast<ItemRendererQPainter *>(Compositor::self()->scene()->renderer());
+    const auto layer = static_cast<VirtualQPainterLayer *>(Compositor::self()->backend()->compatibleOutputLayers(output).front());
+    auto renderFrame = [&](ItemRendererQPainter::ParallelRendering mode) {
+        renderer->setParallelRendering(mode);
+        Compositor::self()->scene()->addRepaintFull();
+        // render a few frames, to make sure the whole swapchain has been repainted
+        for (int i = 0; i < 3; i++) {
+            if (!windows.back()->presentWait()) {
+                return QImage();
+            }
+        }
+        return layer->image()->copy();
+    };
+
+    const QImage serial = renderFrame(ItemRendererQPainter::ParallelRendering::Never);
+    QVERIFY(!serial.isNull());
+    const QImage parallel = renderFrame(ItemRendererQPainter::ParallelRendering::Always);
+    QVERIFY(!parallel.isNull());
+    QCOMPARE(parallel, serial);
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::SceneQPainterParallelTest)
+#include "scene_qpainter_parallel_test.moc"
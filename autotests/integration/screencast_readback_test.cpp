@@ -0,0 +1,196 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "compositor.h"
+#include "generic_scene_opengl_test.h"
+#include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "opengl/glframebuffer.h"
+#include "opengl/glshader.h"
+#include "opengl/glshadermanager.h"
+#include "opengl/gltexture.h"
+#include "screencastreadback.h"
+
+#include <QMatrix4x4>
+#include <QPainter>
+#include <QSignalSpy>
+
+#include <cmath>
+#include <drm_fourcc.h>
+
+namespace KWin
+{
+
+class ScreenCastReadbackTest : public GenericSceneOpenGLTest
+{
+    Q_OBJECT
+public:
+    ScreenCastReadbackTest()
+        : GenericSceneOpenGLTest(QByteArrayLiteral("O2"))
+    {
+    }
+
+private Q_SLOTS:
+    void testReadbackRects_data();
+    void testReadbackRects();
+    void testNV12();
+
+private:
+    EglContext *makeCurrent() const;
+    void render(ScreenCastReadback *readback, const QImage &image) const;
+};
+
+EglContext *ScreenCastReadbackTest::makeCurrent() const
+{
+    const auto backend = static_cast<EglBackend *>(Compositor::self()->backend());
+    backend->openglContext()->makeCurrent();
+    return backend->openglContext();
+}
+
+void ScreenCastReadbackTest::render(ScreenCastReadback *readback, const QImage &image) const
+{
+    // same as grabTexture(), the readback takes care of the orientation of the framebuffer
+    const auto texture = GLTexture::upload(image);
+    QVERIFY(texture);
+
+    ShaderBinder binder(ShaderTrait::MapTexture);
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.scale(1, -1);
+    projectionMatrix.ortho(QRect(QPoint(), image.size()));
+    binder.shader()->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, projectionMatrix);
+
+    GLFramebuffer::pushFramebuffer(readback->framebuffer());
+    texture->render(image.size());
+    GLFramebuffer::popFramebuffer();
+}
+
+void ScreenCastReadbackTest::testReadbackRects_data()
+{
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<uint>("format");
+    QTest::addColumn<QRegion>("expected");
+
+    QRegion sixteenRects;
+    for (int i = 0; i < 16; ++i) {
+        sixteenRects += QRect(i * 2, 0, 1, 1);
+    }
+    const QRegion seventeenRects = sixteenRects | QRect(32, 0, 1, 1);
+
+    QTest::addRow("rgb full") << QRegion(infiniteRegion()) << QSize(100, 50) << uint(DRM_FORMAT_XRGB8888) << QRegion(0, 0, 100, 50);
+    QTest::addRow("rgb clipped") << QRegion(-5, 45, 10, 10) << QSize(100, 50) << uint(DRM_FORMAT_XRGB8888) << QRegion(0, 45, 5, 5);
+    QTest::addRow("rgb 16 rects") << sixteenRects << QSize(100, 50) << uint(DRM_FORMAT_XRGB8888) << sixteenRects;
+    QTest::addRow("rgb 17 rects") << seventeenRects << QSize(100, 50) << uint(DRM_FORMAT_XRGB8888) << QRegion(0, 0, 33, 1);
+
+    // luma texels cover four pixels of a row, chroma texels a 4x2 block below the luma plane
+    QTest::addRow("nv12 full") << QRegion(infiniteRegion()) << QSize(16, 8) << uint(DRM_FORMAT_NV12) << QRegion(0, 0, 4, 12);
+    QTest::addRow("nv12 odd aligned") << QRegion(3, 1, 6, 3) << QSize(16, 8) << uint(DRM_FORMAT_NV12) << (QRegion(0, 1, 3, 3) | QRegion(0, 8, 3, 2));
+    QTest::addRow("nv12 single pixel") << QRegion(4, 1, 1, 1) << QSize(16, 8) << uint(DRM_FORMAT_NV12) << (QRegion(1, 1, 1, 1) | QRegion(1, 8, 1, 1));
+    QTest::addRow("nv12 odd height") << QRegion(0, 6, 4, 1) << QSize(16, 7) << uint(DRM_FORMAT_NV12) << (QRegion(0, 6, 1, 1) | QRegion(0, 11, 1, 1));
+    QTest::addRow("nv12 full odd height") << QRegion(infiniteRegion()) << QSize(16, 7) << uint(DRM_FORMAT_NV12) << (QRegion(0, 0, 4, 7) | QRegion(0, 8, 4, 4));
+    QTest::addRow("nv12 17 rects") << seventeenRects << QSize(40, 8) << uint(DRM_FORMAT_NV12) << (QRegion(0, 0, 9, 1) | QRegion(0, 8, 9, 1));
+}
+
+void ScreenCastReadbackTest::testReadbackRects()
+{
+    // this test verifies which parts of the pixel buffer are downloaded for a damaged region
+    QFETCH(QRegion, region);
+    QFETCH(QSize, size);
+    QFETCH(uint, format);
+    QFETCH(QRegion, expected);
+
+    const QList<QRect> rects = ScreenCastReadback::readbackRects(region, size, format);
+    QRegion actual;
+    for (const QRect &rect : rects) {
+        // the rects are copied one by one, so they must not overlap
+        QVERIFY(!actual.intersects(rect));
+        actual += rect;
+    }
+    QCOMPARE(actual, expected);
+}
+
+// BT.709, limited range, as in rgbtonv12.frag
+static int luma(const QColor &color)
+{
+    return std::round(16 + (0.2126 * color.redF() + 0.7152 * color.greenF() + 0.0722 * color.blueF()) * 219);
+}
+
+static int chromaU(const QColor &color)
+{
+    return std::round(128 + (-0.1146 * color.redF() - 0.3854 * color.greenF() + 0.5 * color.blueF()) * 224);
+}
+
+static int chromaV(const QColor &color)
+{
+    return std::round(128 + (0.5 * color.redF() - 0.4542 * color.greenF() - 0.0458 * color.blueF()) * 224);
+}
+
+void ScreenCastReadbackTest::testNV12()
+{
+    // this test verifies that a frame is converted to NV12 with the luma plane on top and the
+    // interleaved chroma plane below it, every 2x2 block has a single color so that the
+    // subsampled chroma is exact
+    const QSize size(8, 4);
+    const int stride = 8;
+    const QColor colors[2][4] = {
+        {Qt::red, Qt::green, Qt::blue, Qt::white},
+        {Qt::black, QColor(128, 128, 128), Qt::yellow, Qt::magenta},
+    };
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    {
+        QPainter painter(&image);
+        for (int row = 0; row < 2; ++row) {
+            for (int column = 0; column < 4; ++column) {
+                painter.fillRect(QRect(column * 2, row * 2, 2, 2), colors[row][column]);
+            }
+        }
+    }
+
+    EglContext *context = makeCurrent();
+    if (!ScreenCastReadback::isSupported(context, DRM_FORMAT_NV12)) {
+        QSKIP("NV12 readback is not supported");
+    }
+
+    std::vector<uchar> data(stride * (size.height() + size.height() / 2), 0);
+    const auto readback = ScreenCastReadback::create(context, size, DRM_FORMAT_NV12, data.data(), stride);
+    QVERIFY(readback);
+
+    render(readback.get(), image);
+    QSignalSpy finishedSpy(readback.get(), &ScreenCastReadback::finished);
+    QVERIFY(readback->start(infiniteRegion()));
+    if (readback->isPending()) {
+        QVERIFY(finishedSpy.wait());
+    }
+    QCOMPARE(finishedSpy.last().first().toBool(), true);
+
+    // the GPU may round differently
+    auto compare = [](int actual, int expected) {
+        return std::abs(actual - expected) <= 1;
+    };
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            const QColor color = colors[y / 2][x / 2];
+            QVERIFY2(compare(data[y * stride + x], luma(color)), qPrintable(QStringLiteral("luma at %1,%2: %3").arg(x).arg(y).arg(data[y * stride + x])));
+        }
+    }
+    const uchar *chroma = data.data() + stride * size.height();
+    for (int y = 0; y < size.height() / 2; ++y) {
+        for (int x = 0; x < size.width() / 2; ++x) {
+            const QColor color = colors[y][x];
+            const uchar u = chroma[y * stride + x * 2];
+            const uchar v = chroma[y * stride + x * 2 + 1];
+            QVERIFY2(compare(u, chromaU(color)), qPrintable(QStringLiteral("u at %1,%2: %3").arg(x).arg(y).arg(u)));
+            QVERIFY2(compare(v, chromaV(color)), qPrintable(QStringLiteral("v at %1,%2: %3").arg(x).arg(y).arg(v)));
+        }
+    }
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ScreenCastReadbackTest)
+#include "screencast_readback_test.moc"
@@ -8,6 +8,7 @@
 */
 #include "compositor.h"
 #include "core/output.h"
+#include "cursor.h"
 #include "generic_scene_opengl_test.h"
 #include "opengl/glplatform.h"
 #include "pointer_input.h"
@@ -16,11 +17,16 @@
 #include "window.h"
 #include "workspace.h"
 
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusReply>
+
 #include <KWayland/Client/output.h>
 #include <KWayland/Client/subsurface.h>
 #include <KWayland/Client/surface.h>
 #include <PipeWireSourceStream>
 #include <QPainter>
+#include <QScopeGuard>
 #include <QScreen>
 
 #define QCOMPAREIMG(actual, expected, id)                                                        \
@@ -78,15 +84,35 @@ public:
     }
 private Q_SLOTS:
     void init();
+    void cleanup();
     void testWindowCasting();
     void testWindowWithPopup();
     void testWindowWithPopupDynamic();
     void testOutputCasting();
+    void testOutputCastingUnchangedFrames();
 
 private:
     std::optional<QImage> oneFrameAndClose(Test::ScreencastingStreamV1 *stream);
 };
 
+static const QString s_dbusPath = QStringLiteral("/org/kde/KWin/ScreenCast");
+static const QString s_dbusInterface = QStringLiteral("org.kde.KWin.ScreenCast");
+
+static QList<uint> screencastStreams()
+{
+    const auto message = QDBusMessage::createMethodCall(QDBusConnection::sessionBus().baseService(), s_dbusPath, s_dbusInterface, QStringLiteral("streams"));
+    const QDBusReply<QList<uint>> reply = QDBusConnection::sessionBus().call(message);
+    return reply.value();
+}
+
+static QVariantMap screencastStatistics(uint nodeId)
+{
+    auto message = QDBusMessage::createMethodCall(QDBusConnection::sessionBus().baseService(), s_dbusPath, s_dbusInterface, QStringLiteral("streamStatistics"));
+    message.setArguments({nodeId});
+    const QDBusReply<QVariantMap> reply = QDBusConnection::sessionBus().call(message);
+    return reply.value();
+}
+
 void ScreencastingTest::init()
 {
     if (qgetenv("KDECI_BUILD") == "TRUE") {
@@ -98,6 +124,11 @@ void ScreencastingTest::init()
     Cursors::self()->hideCursor();
 }
 
+void ScreencastingTest::cleanup()
+{
+    Cursors::self()->showCursor();
+}
+
 std::optional<QImage> ScreencastingTest::oneFrameAndClose(Test::ScreencastingStreamV1 *stream)
 {
     Q_ASSERT(stream);
@@ -265,6 +296,66 @@ void ScreencastingTest::testOutputCasting()
     QCOMPAREIMG(*img, sourceImage, QLatin1String("output_cast"));
 }
 
+void ScreencastingTest::testOutputCastingUnchangedFrames()
+{
+    // this test verifies that a frame without any damage is not sent, unless the cursor has
+    // moved, in which case only the cursor metadata is sent
+    Test::XdgToplevelWindow window;
+    QVERIFY(window.show(QSize(100, 100), Qt::red));
+    QVERIFY(window.presentWait());
+
+    Cursors::self()->showCursor();
+    auto hideCursor = qScopeGuard([] {
+        Cursors::self()->hideCursor();
+    });
+
+    Output *output = workspace()->outputs().constFirst();
+    auto theOutput = KWin::Test::waylandOutputs().constFirst();
+    std::unique_ptr<Test::ScreencastingStreamV1> stream(KWin::Test::screencasting()->createOutputStream(theOutput->output(), Test::ScreencastingV1::pointer_metadata));
+
+    PipeWireSourceStream pwStream;
+    connect(stream.get(), &Test::ScreencastingStreamV1::failed, qGuiApp, [](const QString &error) {
+        QFAIL("Creating stream failed: " + error.toUtf8());
+    });
+    connect(stream.get(), &Test::ScreencastingStreamV1::closed, qGuiApp, [&pwStream] {
+        pwStream.setActive(false);
+    });
+    QSignalSpy createdSpy(stream.get(), &Test::ScreencastingStreamV1::created);
+    QVERIFY(createdSpy.wait());
+    const uint nodeId = createdSpy.first().first().toUInt();
+    pwStream.createStream(nodeId, 0);
+
+    QSignalSpy frameSpy(&pwStream, &PipeWireSourceStream::frameReceived);
+    QVERIFY(frameSpy.wait());
+    QVERIFY(frameSpy.last().first().value<PipeWireFrame>().dataFrame);
+    QVERIFY(screencastStreams().contains(nodeId));
+
+    QVariantMap statistics = screencastStatistics(nodeId);
+    const quint64 framesProduced = statistics.value(QStringLiteral("framesProduced")).toULongLong();
+    const quint64 framesSkipped = statistics.value(QStringLiteral("framesSkipped")).toULongLong();
+
+    // a commit without damage schedules a frame, which has to be skipped
+    frameSpy.clear();
+    QVERIFY(window.presentWait());
+    QTRY_VERIFY(screencastStatistics(nodeId).value(QStringLiteral("framesSkipped")).toULongLong() > framesSkipped);
+    QVERIFY(!frameSpy.wait(100));
+    statistics = screencastStatistics(nodeId);
+    QCOMPARE(statistics.value(QStringLiteral("framesProduced")).toULongLong(), framesProduced);
+
+    // moving the cursor sends a frame with the cursor metadata and corrupted contents
+    const QPointF cursorPos = output->geometry().topLeft() + QPointF(10, 10);
+    QVERIFY(!window.m_window->frameGeometry().contains(cursorPos));
+    input()->pointer()->warp(cursorPos);
+    QVERIFY(frameSpy.wait());
+    const auto frame = frameSpy.last().first().value<PipeWireFrame>();
+    QVERIFY(!frame.dataFrame);
+    QVERIFY(frame.cursor);
+    QCOMPARE(frame.cursor->position, (output->mapFromGlobal(cursorPos) * output->scale()).toPoint());
+
+    statistics = screencastStatistics(nodeId);
+    QCOMPARE(statistics.value(QStringLiteral("framesProduced")).toULongLong(), framesProduced + quint64(frameSpy.count()));
+}
+
 }
 
 WAYLANDTEST_MAIN(KWin::ScreencastingTest)
@@ -0,0 +1,179 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "pointer_input.h"
+#include "virtualdesktops.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_toplevel_index-0");
+
+// What InputRedirection::findToplevel() used to do
+static Window *findToplevelLinear(const QPointF &pos)
+{
+    const QList<Window *> &stacking = workspace()->stackingOrder();
+    for (auto it = stacking.crbegin(); it != stacking.crend(); ++it) {
+        Window *window = *it;
+        if (window->isDeleted()) {
+            continue;
+        }
+        if (!window->isOnCurrentActivity() || !window->isOnCurrentDesktop() || window->isMinimized() || window->isHidden() || window->isHiddenByShowDesktop()) {
+            continue;
+        }
+        if (!window->readyForPainting()) {
+            continue;
+        }
+        if (window->hitTest(pos)) {
+            return window;
+        }
+    }
+    return nullptr;
+}
+
+class ToplevelIndexTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testMatchesStackingOrder();
+    void benchmarkFindToplevel_data();
+    void benchmarkFindToplevel();
+
+private:
+    void createWindows(int count, int desktopCount);
+    bool compareWithStackingOrder();
+
+    std::vector<std::unique_ptr<Test::XdgToplevelWindow>> m_windows;
+};
+
+void ToplevelIndexTest::initTestCase()
+{
+    qRegisterMetaType<KWin::Window *>();
+    QVERIFY(waylandServer()->init(s_socketName));
+    kwinApp()->start();
+    Test::setOutputConfig({
+        QRect(0, 0, 1280, 1024),
+        QRect(1280, 0, 1280, 1024),
+    });
+}
+
+void ToplevelIndexTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void ToplevelIndexTest::cleanup()
+{
+    m_windows.clear();
+    VirtualDesktopManager::self()->setCount(1);
+    Test::destroyWaylandConnection();
+}
+
+void ToplevelIndexTest::createWindows(int count, int desktopCount)
+{
+    VirtualDesktopManager::self()->setCount(desktopCount);
+    const QList<VirtualDesktop *> desktops = VirtualDesktopManager::self()->desktops();
+    const QRect geometry = workspace()->geometry();
+    for (int i = 0; i < count; ++i) {
+        auto window = std::make_unique<Test::XdgToplevelWindow>();
+        QVERIFY(window->show(QSize(100 + (i * 37) % 400, 80 + (i * 53) % 300)));
+        window->m_window->move(QPointF((i * 211) % (geometry.width() - 200), (i * 97) % (geometry.height() - 150)));
+        window->m_window->setDesktops({desktops[i % desktopCount]});
+        m_windows.push_back(std::move(window));
+    }
+}
+
+bool ToplevelIndexTest::compareWithStackingOrder()
+{
+    const QRect geometry = workspace()->geometry().adjusted(-50, -50, 50, 50);
+    for (int y = geometry.top(); y < geometry.bottom(); y += 23) {
+        for (int x = geometry.left(); x < geometry.right(); x += 29) {
+            const QPointF pos(x + 0.5, y + 0.5);
+            if (input()->findToplevel(pos) != findToplevelLinear(pos)) {
+                qWarning() << "Mismatch at" << pos;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void ToplevelIndexTest::testMatchesStackingOrder()
+{
+    // this test verifies that the index finds the same window as walking the stacking order,
+    // also after the windows have been moved, restacked, minimized, or the desktop changed
+    createWindows(40, 2);
+    QVERIFY(compareWithStackingOrder());
+
+    m_windows[3]->m_window->move(QPointF(1200, 500));
+    m_windows[10]->m_window->move(QPointF(-40, 900));
+    QVERIFY(compareWithStackingOrder());
+
+    workspace()->raiseWindow(m_windows[0]->m_window);
+    workspace()->raiseWindow(m_windows[6]->m_window);
+    QVERIFY(compareWithStackingOrder());
+
+    m_windows[12]->m_window->setMinimized(true);
+    QVERIFY(compareWithStackingOrder());
+    m_windows[12]->m_window->setMinimized(false);
+    QVERIFY(compareWithStackingOrder());
+
+    VirtualDesktopManager::self()->setCurrent(2);
+    QVERIFY(compareWithStackingOrder());
+    m_windows[1]->m_window->move(QPointF(600, 600));
+    QVERIFY(compareWithStackingOrder());
+
+    QSignalSpy closedSpy(m_windows[5]->m_window, &Window::closed);
+    m_windows.erase(m_windows.begin() + 5);
+    QVERIFY(closedSpy.wait());
+    QVERIFY(compareWithStackingOrder());
+}
+
+void ToplevelIndexTest::benchmarkFindToplevel_data()
+{
+    QTest::addColumn<bool>("indexed");
+
+    QTest::addRow("stacking order") << false;
+    QTest::addRow("index") << true;
+}
+
+void ToplevelIndexTest::benchmarkFindToplevel()
+{
+    // this benchmark hit-tests a pointer path across the workspace with hundreds of windows
+    // spread across a few virtual desktops
+    QFETCH(bool, indexed);
+    createWindows(240, 4);
+
+    QList<QPointF> positions;
+    for (int i = 0; i < 1000; ++i) {
+        positions.append(QPointF((i * 7) % 2560 + 0.5, (i * 13) % 1024 + 0.5));
+    }
+
+    QBENCHMARK {
+        for (const QPointF &pos : std::as_const(positions)) {
+            if (indexed) {
+                input()->findToplevel(pos);
+            } else {
+                findToplevelLinear(pos);
+            }
+        }
+    }
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::ToplevelIndexTest)
+#include "toplevel_index_test.moc"
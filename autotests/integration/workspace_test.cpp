@@ -37,6 +37,7 @@ private Q_SLOTS:
     void activeOutputAfterActivateNextWindowOnOutputAdded();
     void activeOutputAfterActivateNextWindowOnOutputRemoved_data();
     void activeOutputAfterActivateNextWindowOnOutputRemoved();
+    void findWindow();
 };
 
 void WorkspaceTest::initTestCase()
@@ -394,5 +395,27 @@ void WorkspaceTest::activeOutputAfterActivateNextWindowOnOutputRemoved()
     QCOMPARE(workspace()->activeOutput(), thirdOutput);
 }
 
+void WorkspaceTest::findWindow()
+{
+    // This test verifies that a window can be looked up by its id and by its surface while it's
+    // managed, and not anymore after it has been closed.
+
+    std::unique_ptr<KWayland::Client::Surface> surface(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.get()));
+    auto window = Test::renderAndWaitForShown(surface.get(), QSize(100, 50), Qt::blue);
+    QVERIFY(window);
+
+    const QUuid internalId = window->internalId();
+    SurfaceInterface *serverSurface = window->surface();
+    QCOMPARE(workspace()->findWindow(internalId), window);
+    QCOMPARE(waylandServer()->findWindow(serverSurface), window);
+    QCOMPARE(workspace()->findWindow(QUuid::createUuid()), nullptr);
+
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowClosed(window));
+    QCOMPARE(workspace()->findWindow(internalId), nullptr);
+    QCOMPARE(waylandServer()->findWindow(serverSurface), nullptr);
+}
+
 WAYLANDTEST_MAIN(WorkspaceTest)
 #include "workspace_test.moc"
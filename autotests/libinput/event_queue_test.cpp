@@ -0,0 +1,300 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "mock_libinput.h"
+
+#include "backends/libinput/eventqueue.h"
+#include "backends/libinput/events.h"
+
+#include <QMutex>
+#include <QTest>
+#include <QThread>
+
+#include <deque>
+
+using namespace KWin::LibInput;
+using namespace std::literals;
+
+static int s_destroyedEvents = 0;
+
+struct CountingPointerEvent : libinput_event_pointer
+{
+    ~CountingPointerEvent() override
+    {
+        s_destroyedEvents++;
+    }
+};
+
+static libinput_event_pointer *createMotionEvent(libinput_device *device, int index)
+{
+    libinput_event_pointer *event = new libinput_event_pointer;
+    event->device = device;
+    event->type = LIBINPUT_EVENT_POINTER_MOTION;
+    event->delta = QPointF(1, index);
+    event->time = std::chrono::microseconds(index * 125);
+    return event;
+}
+
+class TestLibinputEventQueue : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testPushPop();
+    void testFull();
+    void testFullRing();
+    void testReclaim();
+    void testConcurrent();
+    void benchmarkPointerStream_data();
+    void benchmarkPointerStream();
+
+private:
+    libinput_device *m_nativeDevice = nullptr;
+};
+
+void TestLibinputEventQueue::init()
+{
+    m_nativeDevice = new libinput_device;
+    m_nativeDevice->pointer = true;
+    s_destroyedEvents = 0;
+}
+
+void TestLibinputEventQueue::cleanup()
+{
+    delete m_nativeDevice;
+    m_nativeDevice = nullptr;
+}
+
+void TestLibinputEventQueue::testPushPop()
+{
+    // this test verifies that events come out of the queue in order, also when the slots wrap around
+    EventQueue queue(8);
+    QCOMPARE(queue.capacity(), size_t(8));
+    QVERIFY(!queue.peek());
+
+    int pushed = 0;
+    int popped = 0;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            QVERIFY(!queue.isFull());
+            queue.push(createMotionEvent(m_nativeDevice, pushed++));
+        }
+
+        for (int i = 0; i < 5; ++i) {
+            Event *event = queue.peek(i);
+            QVERIFY(event);
+            QCOMPARE(event->type(), LIBINPUT_EVENT_POINTER_MOTION);
+            QCOMPARE(static_cast<PointerEvent *>(event)->delta(), QPointF(1, popped + i));
+        }
+        QVERIFY(!queue.peek(5));
+
+        queue.pop(2);
+        popped += 2;
+        QCOMPARE(static_cast<PointerEvent *>(queue.peek())->time(), std::chrono::microseconds(popped * 125));
+        queue.pop(3);
+        popped += 3;
+        QVERIFY(!queue.peek());
+    }
+}
+
+void TestLibinputEventQueue::testFull()
+{
+    // this test verifies that the queue reports when it runs out of slots
+    EventQueue queue(4);
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(!queue.isFull());
+        queue.push(createMotionEvent(m_nativeDevice, i));
+    }
+    QVERIFY(queue.isFull());
+
+    // a popped slot can be reused right away
+    queue.pop();
+    QVERIFY(!queue.isFull());
+    queue.push(createMotionEvent(m_nativeDevice, 4));
+    QVERIFY(queue.isFull());
+
+    QCOMPARE(static_cast<PointerEvent *>(queue.peek())->delta(), QPointF(1, 1));
+    QCOMPARE(static_cast<PointerEvent *>(queue.peek(3))->delta(), QPointF(1, 4));
+}
+
+void TestLibinputEventQueue::testFullRing()
+{
+    // this test verifies that a reader that stops on a full ring and only resumes once half of the
+    // slots are free, like the libinput connection does, neither loses nor reorders events
+    EventQueue queue(8);
+    int pushed = 0;
+    int received = 0;
+    int stalls = 0;
+    bool readerEnabled = true;
+    const int eventCount = 100;
+
+    auto read = [&]() {
+        while (pushed < eventCount) {
+            if (queue.isFull()) {
+                readerEnabled = false;
+                stalls++;
+                return;
+            }
+            queue.push(createMotionEvent(m_nativeDevice, pushed++));
+        }
+    };
+
+    read();
+    QVERIFY(!readerEnabled);
+    QCOMPARE(queue.size(), queue.capacity());
+
+    while (received < eventCount) {
+        Event *event = queue.peek();
+        QVERIFY(event);
+        QCOMPARE(static_cast<PointerEvent *>(event)->delta(), QPointF(1, received));
+        queue.pop();
+        received++;
+
+        // the reader stays disabled until the ring has drained below the threshold
+        if (!readerEnabled && queue.size() > queue.capacity() / 2) {
+            continue;
+        }
+        if (!readerEnabled) {
+            QCOMPARE(queue.size(), queue.capacity() / 2);
+            readerEnabled = true;
+            read();
+        }
+    }
+
+    QCOMPARE(pushed, eventCount);
+    QVERIFY(!queue.peek());
+    QCOMPARE(queue.size(), size_t(0));
+    // every refill after the first one only brings the ring from half to full
+    QCOMPARE(stalls, (eventCount - 8) / 4);
+}
+
+void TestLibinputEventQueue::testReclaim()
+{
+    // this test verifies that popped events are destroyed by the producer, not by the consumer
+    {
+        EventQueue queue(8);
+        for (int i = 0; i < 5; ++i) {
+            auto event = new CountingPointerEvent;
+            event->device = m_nativeDevice;
+            event->type = LIBINPUT_EVENT_POINTER_MOTION;
+            queue.push(event);
+        }
+
+        queue.pop(3);
+        QCOMPARE(s_destroyedEvents, 0);
+
+        queue.reclaim();
+        QCOMPARE(s_destroyedEvents, 3);
+    }
+
+    // events that are still in the queue are destroyed together with it
+    QCOMPARE(s_destroyedEvents, 5);
+}
+
+void TestLibinputEventQueue::testConcurrent()
+{
+    // this test verifies that no event is lost or reordered when the producer and the consumer run in parallel
+    const int eventCount = 100000;
+    EventQueue queue(64);
+
+    std::unique_ptr<QThread> producer(QThread::create([this, &queue]() {
+        for (int i = 0; i < eventCount; ++i) {
+            while (queue.isFull()) {
+                QThread::yieldCurrentThread();
+            }
+            queue.push(createMotionEvent(m_nativeDevice, i));
+        }
+    }));
+    producer->start();
+
+    int received = 0;
+    bool ordered = true;
+    while (received < eventCount) {
+        Event *event = queue.peek();
+        if (!event) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        ordered &= static_cast<PointerEvent *>(event)->delta().y() == received;
+        queue.pop();
+        received++;
+    }
+
+    QVERIFY(producer->wait());
+    QVERIFY(ordered);
+    QVERIFY(!queue.peek());
+}
+
+void TestLibinputEventQueue::benchmarkPointerStream_data()
+{
+    QTest::addColumn<bool>("lockFree");
+
+    QTest::addRow("locked deque") << false;
+    QTest::addRow("event queue") << true;
+}
+
+void TestLibinputEventQueue::benchmarkPointerStream()
+{
+    // this benchmark replays one second of motion events from an 8 kHz mouse, the events are
+    // read in a separate thread and processed in the current one, like in the libinput backend
+    QFETCH(bool, lockFree);
+    const int eventCount = 8000;
+
+    QBENCHMARK {
+        QPointF delta;
+        if (lockFree) {
+            EventQueue queue;
+            std::unique_ptr<QThread> producer(QThread::create([this, &queue]() {
+                for (int i = 0; i < eventCount; ++i) {
+                    while (queue.isFull()) {
+                        QThread::yieldCurrentThread();
+                    }
+                    queue.push(createMotionEvent(m_nativeDevice, i));
+                }
+            }));
+            producer->start();
+
+            for (int received = 0; received < eventCount;) {
+                Event *event = queue.peek();
+                if (!event) {
+                    QThread::yieldCurrentThread();
+                    continue;
+                }
+                delta += static_cast<PointerEvent *>(event)->delta();
+                queue.pop();
+                received++;
+            }
+            producer->wait();
+        } else {
+            // what the libinput backend used to do
+            QMutex mutex;
+            std::deque<std::unique_ptr<Event>> queue;
+            std::unique_ptr<QThread> producer(QThread::create([this, &mutex, &queue]() {
+                for (int i = 0; i < eventCount; ++i) {
+                    QMutexLocker locker(&mutex);
+                    queue.push_back(Event::create(createMotionEvent(m_nativeDevice, i)));
+                }
+            }));
+            producer->start();
+
+            for (int received = 0; received < eventCount;) {
+                QMutexLocker locker(&mutex);
+                while (!queue.empty()) {
+                    std::unique_ptr<Event> event = std::move(queue.front());
+                    queue.pop_front();
+                    delta += static_cast<PointerEvent *>(event.get())->delta();
+                    received++;
+                }
+            }
+            producer->wait();
+        }
+        QCOMPARE(delta.x(), qreal(eventCount));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestLibinputEventQueue)
+#include "event_queue_test.moc"
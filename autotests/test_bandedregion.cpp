@@ -0,0 +1,243 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "utils/bandedregion.h"
+
+using namespace KWin;
+
+class TestBandedRegion : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestBandedRegion() = default;
+
+private Q_SLOTS:
+    void testEmpty();
+    void testIntersections_data();
+    void testIntersections();
+    void testContainedInRect();
+    void testUniteRects();
+    void benchmarkClip_data();
+    void benchmarkClip();
+    void benchmarkUnite_data();
+    void benchmarkUnite();
+};
+
+/**
+ * Damage shaped like what a typical session produces: a few windows with partial updates,
+ * a blinking cursor, a clock in the panel, and a video.
+ */
+static QRegion desktopDamage()
+{
+    QRegion region;
+    region += QRect(812, 430, 2, 18);
+    region += QRect(1800, 1050, 120, 30);
+    region += QRect(320, 180, 1280, 720);
+    for (int i = 0; i < 24; ++i) {
+        region += QRect(40 + i * 13, 960 + (i % 5) * 7, 9, 16);
+    }
+    return region;
+}
+
+/**
+ * Damage of a web page with text being scrolled, which consists of many narrow bands.
+ */
+static QRegion scrollDamage()
+{
+    QRegion region;
+    for (int y = 80; y < 1080; y += 20) {
+        region += QRect(100 + (y % 60), y, 1400 - (y % 100), 14);
+        region += QRect(1600, y, 200, 20);
+    }
+    return region;
+}
+
+static QRegion randomRegion(int count, quint32 seed)
+{
+    QRandomGenerator generator(seed);
+    QRegion region;
+    for (int i = 0; i < count; ++i) {
+        region += QRect(generator.bounded(1920), generator.bounded(1080), 1 + generator.bounded(300), 1 + generator.bounded(200));
+    }
+    return region;
+}
+
+static QList<QRectF> referenceIntersections(const QRegion &region, const QPointF &offset, const QRectF &rect)
+{
+    QList<QRectF> intersections;
+    for (const QRect &regionRect : region) {
+        const QRectF intersected = QRectF(regionRect).translated(offset).intersected(rect);
+        if (intersected.isValid()) {
+            intersections.append(intersected);
+        }
+    }
+    return intersections;
+}
+
+void TestBandedRegion::testEmpty()
+{
+    const BandedRegion region(QRegion{});
+    QVERIFY(region.isEmpty());
+    QCOMPARE(region.rectCount(), size_t(0));
+    QVERIFY(!region.intersects(QRectF(0, 0, 100, 100)));
+    QVERIFY(!region.containedInRect(QRectF(0, 0, 100, 100)));
+    QCOMPARE(region.toRegion(), QRegion());
+}
+
+void TestBandedRegion::testIntersections_data()
+{
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<QPointF>("offset");
+
+    QTest::addRow("desktop") << desktopDamage() << QPointF();
+    QTest::addRow("scroll") << scrollDamage() << QPointF();
+    QTest::addRow("random") << randomRegion(200, 42) << QPointF();
+    QTest::addRow("random, fractional offset") << randomRegion(200, 7) << QPointF(-10.5, 3.25);
+}
+
+void TestBandedRegion::testIntersections()
+{
+    QFETCH(QRegion, region);
+    QFETCH(QPointF, offset);
+
+    const BandedRegion banded(region, offset);
+    QCOMPARE(banded.rectCount(), size_t(region.rectCount()));
+    QCOMPARE(banded.boundingRect(), QRectF(region.boundingRect()).translated(offset));
+
+    QRandomGenerator generator(1);
+    for (int i = 0; i < 1000; ++i) {
+        const QRectF rect(generator.bounded(2000.0) - 40, generator.bounded(1200.0) - 40, generator.bounded(400.0), generator.bounded(300.0));
+
+        QList<QRectF> intersections;
+        banded.forEachIntersection(rect, [&intersections](const QRectF &intersected) {
+            intersections.append(intersected);
+        });
+
+        const QList<QRectF> expected = referenceIntersections(region, offset, rect);
+        QCOMPARE(intersections, expected);
+        QCOMPARE(banded.intersects(rect), !expected.isEmpty());
+    }
+}
+
+void TestBandedRegion::testContainedInRect()
+{
+    QRegion region;
+    region += QRect(0, 0, 100, 50);
+    region += QRect(0, 50, 200, 50);
+
+    const BandedRegion banded(region);
+    QVERIFY(banded.containedInRect(QRectF(10, 10, 50, 20)));
+    QVERIFY(banded.containedInRect(QRectF(0, 0, 100, 50)));
+    QVERIFY(banded.containedInRect(QRectF(150, 60, 50, 40)));
+    // spans two rects of the region
+    QVERIFY(!banded.containedInRect(QRectF(10, 40, 50, 20)));
+    QVERIFY(!banded.containedInRect(QRectF(150, 10, 10, 10)));
+    QVERIFY(!banded.containedInRect(QRectF(-1, 0, 10, 10)));
+}
+
+void TestBandedRegion::testUniteRects()
+{
+    QRandomGenerator generator(3);
+    QList<QRect> rects;
+    QRegion expected;
+    for (int i = 0; i < 300; ++i) {
+        const QRect rect(generator.bounded(1920), generator.bounded(1080), 1 + generator.bounded(100), 1 + generator.bounded(100));
+        rects.append(rect);
+        expected += rect;
+    }
+    QCOMPARE(uniteRects(rects), expected);
+    QCOMPARE(uniteRects({}), QRegion());
+
+    const QRegion region = randomRegion(100, 9);
+    QCOMPARE(BandedRegion(region).toRegion(), region);
+}
+
+void TestBandedRegion::benchmarkClip_data()
+{
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<bool>("banded");
+
+    QTest::addRow("desktop, QRegion") << desktopDamage() << false;
+    QTest::addRow("desktop, BandedRegion") << desktopDamage() << true;
+    QTest::addRow("scroll, QRegion") << scrollDamage() << false;
+    QTest::addRow("scroll, BandedRegion") << scrollDamage() << true;
+}
+
+void TestBandedRegion::benchmarkClip()
+{
+    QFETCH(QRegion, region);
+    QFETCH(bool, banded);
+
+    // quads of a window with decoration and shadow, as produced by the scene
+    QList<QRectF> quads;
+    for (int y = 0; y < 1080; y += 64) {
+        for (int x = 0; x < 1920; x += 64) {
+            quads.append(QRectF(x, y, 64, 64));
+        }
+    }
+
+    int count = 0;
+    if (banded) {
+        QBENCHMARK {
+            const BandedRegion clip(region);
+            for (const QRectF &quad : std::as_const(quads)) {
+                clip.forEachIntersection(quad, [&count](const QRectF &) {
+                    count++;
+                });
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const QRectF &quad : std::as_const(quads)) {
+                for (const QRect &rect : region) {
+                    if (QRectF(rect).intersected(quad).isValid()) {
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void TestBandedRegion::benchmarkUnite_data()
+{
+    QTest::addColumn<bool>("pairwise");
+
+    QTest::addRow("QRegion") << false;
+    QTest::addRow("uniteRects") << true;
+}
+
+void TestBandedRegion::benchmarkUnite()
+{
+    QFETCH(bool, pairwise);
+
+    QList<QRect> rects;
+    for (const QRect &rect : scrollDamage()) {
+        rects.append(rect.translated(0, 1));
+    }
+
+    if (pairwise) {
+        QBENCHMARK {
+            uniteRects(rects);
+        }
+    } else {
+        QBENCHMARK {
+            QRegion region;
+            for (const QRect &rect : std::as_const(rects)) {
+                region += rect;
+            }
+        }
+    }
+}
+
+QTEST_MAIN(TestBandedRegion)
+
+#include "test_bandedregion.moc"
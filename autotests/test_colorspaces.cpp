@@ -10,6 +10,7 @@
 #include "core/colorpipeline.h"
 #include "core/colorspace.h"
 #include "core/iccprofile.h"
+#include "opengl/colorpipelinecache.h"
 #include "opengl/eglcontext.h"
 #include "opengl/egldisplay.h"
 #include "opengl/glframebuffer.h"
@@ -48,6 +49,7 @@ private Q_SLOTS:
     void testYCbCr();
     void testBlackPointCompensation();
     void testSCRGB();
+    void testColorPipelineCache();
 };
 
 static bool compareVectors(const QVector3D &one, const QVector3D &two, float maxDifference)
@@ -667,6 +669,44 @@ void TestColorspaces::testSCRGB()
     }
 }
 
+void TestColorspaces::testColorPipelineCache()
+{
+    ColorPipelineCache cache;
+    const auto hdr = std::make_shared<ColorDescription>(Colorimetry::BT2020, TransferFunction(TransferFunction::PerceptualQuantizer), 203, 0.005, 500, 1000);
+
+    const auto first = cache.lookup(ColorDescription::sRGB, hdr, RenderingIntent::Perceptual);
+    QCOMPARE(cache.misses(), 1);
+    QCOMPARE(cache.hits(), 0);
+    QCOMPARE(first->pipeline, ColorPipeline::create(ColorDescription::sRGB, hdr, RenderingIntent::Perceptual));
+    QVERIFY(!first->isIdentity);
+
+    // the same triple must be served from the cache
+    const auto second = cache.lookup(ColorDescription::sRGB, hdr, RenderingIntent::Perceptual);
+    QCOMPARE(second, first);
+    QCOMPARE(cache.hits(), 1);
+
+    // a different intent is a different entry
+    cache.lookup(ColorDescription::sRGB, hdr, RenderingIntent::RelativeColorimetric);
+    QCOMPARE(cache.misses(), 2);
+    QCOMPARE(cache.size(), 2);
+
+    const auto identity = cache.lookup(ColorDescription::sRGB, ColorDescription::sRGB, RenderingIntent::Perceptual);
+    QVERIFY(identity->isIdentity);
+
+    // entries referring to a destroyed color description must not be returned again
+    {
+        auto copy = std::make_shared<ColorDescription>(*hdr);
+        cache.lookup(ColorDescription::sRGB, copy, RenderingIntent::Perceptual);
+        QCOMPARE(cache.misses(), 4);
+    }
+    const auto other = std::make_shared<ColorDescription>(Colorimetry::BT709, TransferFunction(TransferFunction::linear), 100, 0, 100, 100);
+    const auto result = cache.lookup(ColorDescription::sRGB, other, RenderingIntent::Perceptual);
+    QCOMPARE(result->pipeline, ColorPipeline::create(ColorDescription::sRGB, other, RenderingIntent::Perceptual));
+
+    cache.clear();
+    QCOMPARE(cache.size(), 0);
+}
+
 QTEST_MAIN(TestColorspaces)
 
 #include "test_colorspaces.moc"
@@ -0,0 +1,149 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "effect/globals.h"
+#include "utils/damagejournal.h"
+
+using namespace KWin;
+
+class TestDamageJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestDamageJournal() = default;
+
+private Q_SLOTS:
+    void testAccumulate();
+    void testCapacity();
+    void testClear();
+    void benchmark_data();
+    void benchmark();
+};
+
+void TestDamageJournal::testAccumulate()
+{
+    DamageJournal journal;
+    const QRegion fallback(0, 0, 1000, 1000);
+
+    QCOMPARE(journal.accumulate(1, fallback), fallback);
+
+    for (int i = 0; i < 5; ++i) {
+        journal.add(QRegion(i * 10, 0, 10, 10));
+    }
+    QCOMPARE(journal.lastDamage(), QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(0, fallback), fallback);
+    QCOMPARE(journal.accumulate(1, fallback), QRegion());
+    QCOMPARE(journal.accumulate(2, fallback), QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(4, fallback), QRegion(20, 0, 30, 10));
+    // cached unions must be consistent with smaller buffer ages
+    QCOMPARE(journal.accumulate(3, fallback), QRegion(30, 0, 20, 10));
+    QCOMPARE(journal.accumulate(5, fallback), QRegion(10, 0, 40, 10));
+    QCOMPARE(journal.accumulate(6, fallback), fallback);
+
+    // adding damage invalidates the cached unions
+    journal.add(QRegion(0, 100, 10, 10));
+    QCOMPARE(journal.accumulate(3, fallback), QRegion(0, 100, 10, 10) | QRegion(40, 0, 10, 10));
+}
+
+void TestDamageJournal::testCapacity()
+{
+    DamageJournal journal;
+    journal.setCapacity(3);
+    const QRegion fallback(0, 0, 1, 1);
+
+    // a buffer age can go back as far as the number of stored regions
+    for (int i = 0; i < 3; ++i) {
+        journal.add(QRegion(i * 10, 0, 10, 10));
+    }
+    QCOMPARE(journal.accumulate(3, fallback), QRegion(10, 0, 20, 10));
+    QCOMPARE(journal.accumulate(4, fallback), fallback);
+
+    // the ring wraps around, the oldest regions are overwritten
+    journal.add(QRegion(30, 0, 10, 10));
+    journal.add(QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.lastDamage(), QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(2, fallback), QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, fallback), QRegion(30, 0, 20, 10));
+    QCOMPARE(journal.accumulate(4, fallback), fallback);
+
+    // shrinking the journal keeps the most recent damage
+    journal.setCapacity(2);
+    QCOMPARE(journal.lastDamage(), QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(2, fallback), QRegion(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, fallback), fallback);
+
+    // growing the journal keeps the stored damage and makes room for more
+    journal.setCapacity(4);
+    QCOMPARE(journal.accumulate(2, fallback), QRegion(40, 0, 10, 10));
+    journal.add(QRegion(50, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, fallback), QRegion(40, 0, 20, 10));
+    QCOMPARE(journal.accumulate(4, fallback), fallback);
+    journal.add(QRegion(60, 0, 10, 10));
+    QCOMPARE(journal.accumulate(4, fallback), QRegion(40, 0, 30, 10));
+    QCOMPARE(journal.accumulate(5, fallback), fallback);
+}
+
+void TestDamageJournal::testClear()
+{
+    DamageJournal journal;
+    journal.add(QRegion(0, 0, 10, 10));
+    journal.add(QRegion(10, 0, 10, 10));
+    QCOMPARE(journal.accumulate(2, QRegion()), QRegion(10, 0, 10, 10));
+
+    journal.clear();
+    QCOMPARE(journal.accumulate(2, QRegion(0, 0, 1, 1)), QRegion(0, 0, 1, 1));
+}
+
+void TestDamageJournal::benchmark_data()
+{
+    QTest::addColumn<QList<QRegion>>("damage");
+
+    // a blinking text cursor in an otherwise idle window
+    QTest::addRow("blinking cursor") << QList<QRegion>{QRegion(812, 430, 2, 18), QRegion(), QRegion(812, 430, 2, 18), QRegion()};
+
+    // a video playing in a window, with the progress bar and a clock updating occasionally
+    QTest::addRow("video") << QList<QRegion>{
+        QRegion(320, 180, 1280, 720),
+        QRegion(320, 180, 1280, 720) | QRegion(320, 880, 1280, 8),
+        QRegion(320, 180, 1280, 720),
+        QRegion(320, 180, 1280, 720) | QRegion(1800, 1050, 120, 30),
+    };
+
+    // scrolling a web page, the whole window is damaged, except for some static chrome
+    QRegion scroll;
+    for (int y = 80; y < 1080; y += 40) {
+        scroll += QRect(0, y, 1600 + (y % 120), 40);
+    }
+    QTest::addRow("scroll") << QList<QRegion>{scroll, scroll.translated(0, 1), scroll, scroll.translated(0, -1)};
+}
+
+void TestDamageJournal::benchmark()
+{
+    QFETCH(QList<QRegion>, damage);
+
+    DamageJournal journal;
+    for (int i = 0; i < journal.capacity(); ++i) {
+        journal.add(damage[i % damage.size()]);
+    }
+
+    // simulate a triple buffered swapchain with two layers and a screencast stream that
+    // query the same buffer ages every frame
+    int frame = 0;
+    QBENCHMARK {
+        journal.add(damage[frame++ % damage.size()]);
+        for (int query = 0; query < 3; ++query) {
+            journal.accumulate(2, infiniteRegion());
+            journal.accumulate(3, infiniteRegion());
+        }
+    }
+}
+
+QTEST_MAIN(TestDamageJournal)
+
+#include "test_damagejournal.moc"
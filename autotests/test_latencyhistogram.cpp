@@ -0,0 +1,80 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/latencyhistogram.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestLatencyHistogram : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestLatencyHistogram() = default;
+
+private Q_SLOTS:
+    void testEmpty();
+    void testPercentile();
+    void testOverflow();
+    void testDecay();
+};
+
+void TestLatencyHistogram::testEmpty()
+{
+    LatencyHistogram histogram;
+    QCOMPARE(histogram.count(), 0u);
+    QCOMPARE(histogram.percentile(0.99), 0ns);
+}
+
+void TestLatencyHistogram::testPercentile()
+{
+    LatencyHistogram histogram;
+    // 99 fast commits and a single slow one
+    for (int i = 0; i < 99; i++) {
+        histogram.add(120us);
+    }
+    histogram.add(1ms);
+    QCOMPARE(histogram.count(), 100u);
+    QCOMPARE(histogram.last(), 1ms);
+
+    // percentiles are rounded up to the upper edge of their bin
+    QCOMPARE(histogram.percentile(0.5), 150us);
+    QCOMPARE(histogram.percentile(0.99), 150us);
+    QCOMPARE(histogram.percentile(1.0), 1050us);
+}
+
+void TestLatencyHistogram::testOverflow()
+{
+    LatencyHistogram histogram;
+    histogram.add(1s);
+    histogram.add(-5us);
+    QCOMPARE(histogram.bins().back(), 1u);
+    QCOMPARE(histogram.bins().front(), 1u);
+    QCOMPARE(histogram.percentile(1.0), LatencyHistogram::s_binWidth * LatencyHistogram::s_binCount);
+}
+
+void TestLatencyHistogram::testDecay()
+{
+    LatencyHistogram histogram;
+    for (uint32_t i = 0; i < LatencyHistogram::s_decayInterval; i++) {
+        histogram.add(2ms);
+    }
+    QCOMPARE(histogram.count(), LatencyHistogram::s_decayInterval / 2);
+    QCOMPARE(histogram.percentile(0.99), 2050us);
+
+    // after enough fast commits, the old slow ones don't matter anymore
+    for (uint32_t i = 0; i < 8 * LatencyHistogram::s_decayInterval; i++) {
+        histogram.add(100us);
+    }
+    QCOMPARE(histogram.percentile(0.99), 150us);
+}
+
+QTEST_GUILESS_MAIN(TestLatencyHistogram)
+
+#include "test_latencyhistogram.moc"
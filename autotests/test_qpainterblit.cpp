@@ -0,0 +1,168 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "scene/qpainterblit.h"
+
+using namespace KWin;
+
+class TestQPainterBlit : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestQPainterBlit() = default;
+
+private Q_SLOTS:
+    void testMatchesQPainter_data();
+    void testMatchesQPainter();
+    void benchmarkBlit_data();
+    void benchmarkBlit();
+};
+
+/**
+ * Returns an image with random, but valid pixels, i.e. the color channels of a premultiplied
+ * pixel don't exceed its alpha channel.
+ */
+static QImage randomImage(const QSize &size, QImage::Format format)
+{
+    QRandomGenerator generator(42);
+    QImage image(size, format);
+    for (int y = 0; y < size.height(); ++y) {
+        auto line = reinterpret_cast<uint32_t *>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            uint32_t alpha = 255;
+            if (format == QImage::Format_ARGB32_Premultiplied) {
+                // make sure that the fully opaque and fully transparent cases are covered too
+                switch (generator.bounded(4)) {
+                case 0:
+                    alpha = 0;
+                    break;
+                case 1:
+                    alpha = 255;
+                    break;
+                default:
+                    alpha = generator.bounded(256);
+                    break;
+                }
+            }
+            const uint32_t red = generator.bounded(alpha + 1);
+            const uint32_t green = generator.bounded(alpha + 1);
+            const uint32_t blue = generator.bounded(alpha + 1);
+            line[x] = (alpha << 24) | (red << 16) | (green << 8) | blue;
+        }
+    }
+    return image;
+}
+
+void TestQPainterBlit::testMatchesQPainter_data()
+{
+    QTest::addColumn<int>("sourceFormat");
+    QTest::addColumn<int>("targetFormat");
+    QTest::addColumn<qreal>("opacity");
+    QTest::addColumn<QRegion>("clip");
+
+    const QRegion clip = QRegion(0, 0, 300, 200) - QRegion(40, 30, 17, 50) - QRegion(100, 0, 3, 200);
+
+    QTest::addRow("xrgb copy") << int(QImage::Format_RGB32) << int(QImage::Format_RGB32) << 1.0 << QRegion(0, 0, 300, 200);
+    QTest::addRow("xrgb copy, clipped") << int(QImage::Format_RGB32) << int(QImage::Format_RGB32) << 1.0 << clip;
+    QTest::addRow("xrgb opacity") << int(QImage::Format_RGB32) << int(QImage::Format_RGB32) << 0.6 << clip;
+    QTest::addRow("argb over") << int(QImage::Format_ARGB32_Premultiplied) << int(QImage::Format_RGB32) << 1.0 << clip;
+    QTest::addRow("argb over argb") << int(QImage::Format_ARGB32_Premultiplied) << int(QImage::Format_ARGB32_Premultiplied) << 1.0 << clip;
+    QTest::addRow("argb opacity") << int(QImage::Format_ARGB32_Premultiplied) << int(QImage::Format_RGB32) << 0.3 << clip;
+    QTest::addRow("argb opacity over argb") << int(QImage::Format_ARGB32_Premultiplied) << int(QImage::Format_ARGB32_Premultiplied) << 0.75 << clip;
+}
+
+void TestQPainterBlit::testMatchesQPainter()
+{
+    QFETCH(int, sourceFormat);
+    QFETCH(int, targetFormat);
+    QFETCH(qreal, opacity);
+    QFETCH(QRegion, clip);
+
+    // odd sizes and positions, so the vector loops have remainders to take care of
+    const QImage source = randomImage(QSize(211, 157), QImage::Format(sourceFormat));
+    const QRect sourceRect(3, 5, 197, 131);
+    const QPoint position(31, 17);
+
+    QImage expected = randomImage(QSize(300, 200), QImage::Format(targetFormat));
+    QImage actual = expected;
+    actual.detach();
+
+    QPainter painter(&expected);
+    painter.setClipRegion(clip);
+    painter.setOpacity(opacity);
+    painter.drawImage(QRectF(position, sourceRect.size()), source, sourceRect);
+    painter.end();
+
+    QPainterBlit::blit(&actual, position, source, sourceRect, clip, opacity);
+
+    if (opacity == 1.0) {
+        QCOMPARE(actual, expected);
+        return;
+    }
+
+    // depending on the clip, QPainter either interpolates or multiplies and blends translucent
+    // pixels, which can round differently
+    int maxDifference = 0;
+    for (int y = 0; y < expected.height(); ++y) {
+        const auto expectedLine = reinterpret_cast<const uint32_t *>(expected.constScanLine(y));
+        const auto actualLine = reinterpret_cast<const uint32_t *>(actual.constScanLine(y));
+        for (int x = 0; x < expected.width(); ++x) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int a = (expectedLine[x] >> shift) & 0xff;
+                const int b = (actualLine[x] >> shift) & 0xff;
+                maxDifference = std::max(maxDifference, std::abs(a - b));
+            }
+        }
+    }
+    QCOMPARE_LE(maxDifference, 1);
+}
+
+void TestQPainterBlit::benchmarkBlit_data()
+{
+    QTest::addColumn<int>("sourceFormat");
+    QTest::addColumn<qreal>("opacity");
+    QTest::addColumn<bool>("qpainter");
+
+    QTest::addRow("xrgb copy, QPainter") << int(QImage::Format_RGB32) << 1.0 << true;
+    QTest::addRow("xrgb copy, QPainterBlit") << int(QImage::Format_RGB32) << 1.0 << false;
+    QTest::addRow("argb over, QPainter") << int(QImage::Format_ARGB32_Premultiplied) << 1.0 << true;
+    QTest::addRow("argb over, QPainterBlit") << int(QImage::Format_ARGB32_Premultiplied) << 1.0 << false;
+    QTest::addRow("argb opacity, QPainter") << int(QImage::Format_ARGB32_Premultiplied) << 0.8 << true;
+    QTest::addRow("argb opacity, QPainterBlit") << int(QImage::Format_ARGB32_Premultiplied) << 0.8 << false;
+}
+
+void TestQPainterBlit::benchmarkBlit()
+{
+    QFETCH(int, sourceFormat);
+    QFETCH(qreal, opacity);
+    QFETCH(bool, qpainter);
+
+    // a maximized window on a 1080p output, clipped by a panel
+    const QImage source = randomImage(QSize(1920, 1040), QImage::Format(sourceFormat));
+    QImage target = randomImage(QSize(1920, 1080), QImage::Format_RGB32);
+    const QRegion clip = QRegion(0, 0, 1920, 1040);
+
+    if (qpainter) {
+        QBENCHMARK {
+            QPainter painter(&target);
+            painter.setClipRegion(clip);
+            painter.setOpacity(opacity);
+            painter.drawImage(QRectF(QPointF(0, 0), source.size()), source, source.rect());
+        }
+    } else {
+        QBENCHMARK {
+            QPainterBlit::blit(&target, QPoint(0, 0), source, source.rect(), clip, opacity);
+        }
+    }
+}
+
+QTEST_MAIN(TestQPainterBlit)
+#include "test_qpainterblit.moc"
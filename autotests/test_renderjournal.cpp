@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/renderjournal.h"
+
+#include <algorithm>
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestRenderJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRenderJournal() = default;
+
+private Q_SLOTS:
+    void testPercentile();
+    void testBurst();
+    void testWorkloads();
+};
+
+static constexpr std::chrono::nanoseconds s_refreshDuration = 16'666'667ns;
+
+void TestRenderJournal::testPercentile()
+{
+    RenderJournal journal;
+    journal.setPredictor(RenderJournal::Predictor::Percentile);
+
+    // 1ms..100ms in random order, the 95th percentile must be 95ms
+    std::vector<std::chrono::nanoseconds> samples;
+    for (int i = 1; i <= 100; i++) {
+        samples.push_back(std::chrono::milliseconds(i));
+    }
+    std::ranges::reverse(samples);
+    std::ranges::rotate(samples, samples.begin() + 37);
+
+    std::chrono::nanoseconds timestamp = 0ns;
+    for (const auto sample : samples) {
+        timestamp += s_refreshDuration;
+        journal.add(sample, timestamp);
+    }
+    QCOMPARE(journal.result(), 95ms);
+}
+
+void TestRenderJournal::testBurst()
+{
+    // the percentile predictor should pick up a sudden increase in render times after a
+    // few frames, and forget about it once the burst has left the window
+    RenderJournal journal;
+    journal.setPredictor(RenderJournal::Predictor::Percentile);
+    std::chrono::nanoseconds timestamp = 0ns;
+    for (int i = 0; i < 600; i++) {
+        timestamp += s_refreshDuration;
+        journal.add(2ms, timestamp);
+    }
+    QCOMPARE(journal.result(), 2ms);
+
+    for (int i = 0; i < 10; i++) {
+        timestamp += s_refreshDuration;
+        journal.add(8ms, timestamp);
+    }
+    QCOMPARE(journal.result(), 8ms);
+
+    for (size_t i = 0; i < RenderJournal::s_windowSize; i++) {
+        timestamp += s_refreshDuration;
+        journal.add(2ms, timestamp);
+    }
+    QCOMPARE(journal.result(), 2ms);
+}
+
+void TestRenderJournal::testWorkloads()
+{
+    RenderJournal journal;
+    journal.setPredictor(RenderJournal::Predictor::Percentile);
+
+    std::chrono::nanoseconds timestamp = 0ns;
+    for (int i = 0; i < 60; i++) {
+        timestamp += s_refreshDuration;
+        journal.add(1ms, timestamp, RenderJournal::Workload::Plain);
+        timestamp += s_refreshDuration;
+        journal.add(6ms, timestamp, RenderJournal::Workload::Effects);
+    }
+
+    journal.setWorkload(RenderJournal::Workload::Plain);
+    QCOMPARE(journal.result(), 1ms);
+    journal.setWorkload(RenderJournal::Workload::Effects);
+    QCOMPARE(journal.result(), 6ms);
+
+    // without enough samples, the prediction falls back to the average
+    journal.setWorkload(RenderJournal::Workload::Overlays);
+    QCOMPARE(journal.result(), journal.result(RenderJournal::Predictor::Average));
+}
+
+QTEST_MAIN(TestRenderJournal)
+
+#include "test_renderjournal.moc"
@@ -0,0 +1,130 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "core/renderloop.h"
+#include "core/renderloop_p.h"
+#include "core/renderloopscheduler.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestRenderLoopScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRenderLoopScheduler() = default;
+
+private Q_SLOTS:
+    void testEarlierDeadlineFirst();
+    void testLaterDeadlineNotDispatched();
+    void testRemovedRenderLoop();
+};
+
+static std::chrono::nanoseconds currentTime()
+{
+    return std::chrono::steady_clock::now().time_since_epoch();
+}
+
+static void schedule(RenderLoop *loop, std::chrono::nanoseconds renderTimestamp, std::chrono::nanoseconds presentationTimestamp, std::chrono::milliseconds timeout)
+{
+    RenderLoopPrivate *d = RenderLoopPrivate::get(loop);
+    d->nextRenderTimestamp = renderTimestamp;
+    d->nextPresentationTimestamp = presentationTimestamp;
+    d->compositeTimer.start(timeout, Qt::PreciseTimer, loop);
+}
+
+void TestRenderLoopScheduler::testEarlierDeadlineFirst()
+{
+    // a 60Hz output that takes 8ms to render and a 144Hz output that is due to start
+    // compositing while the 60Hz frame is rendered, but has to present its frame sooner
+    RenderLoop slow(nullptr);
+    RenderLoop fast(nullptr);
+    RenderLoopPrivate::get(&slow)->renderJournal.add(8ms, 0ns);
+
+    RenderLoopScheduler scheduler;
+    scheduler.addRenderLoop(&slow);
+    scheduler.addRenderLoop(&fast);
+
+    QList<RenderLoop *> dispatched;
+    connect(&slow, &RenderLoop::frameRequested, this, [&dispatched](RenderLoop *loop) {
+        dispatched.append(loop);
+    });
+    connect(&fast, &RenderLoop::frameRequested, this, [&dispatched](RenderLoop *loop) {
+        dispatched.append(loop);
+    });
+
+    const std::chrono::nanoseconds now = currentTime();
+    schedule(&slow, now, now + 16'666'667ns, 0ms);
+    schedule(&fast, now + 2ms, now + 6'944'444ns, 1000ms);
+
+    QSignalSpy slowSpy(&slow, &RenderLoop::frameRequested);
+    QVERIFY(slowSpy.wait());
+    QCOMPARE(dispatched, (QList<RenderLoop *>{&fast, &slow}));
+    QVERIFY(!RenderLoopPrivate::get(&fast)->compositeTimer.isActive());
+}
+
+void TestRenderLoopScheduler::testLaterDeadlineNotDispatched()
+{
+    // the other output is due to start compositing, but its frame can wait
+    RenderLoop fast(nullptr);
+    RenderLoop slow(nullptr);
+    RenderLoopPrivate::get(&fast)->renderJournal.add(8ms, 0ns);
+
+    RenderLoopScheduler scheduler;
+    scheduler.addRenderLoop(&fast);
+    scheduler.addRenderLoop(&slow);
+
+    QSignalSpy fastSpy(&fast, &RenderLoop::frameRequested);
+    QSignalSpy slowSpy(&slow, &RenderLoop::frameRequested);
+
+    const std::chrono::nanoseconds now = currentTime();
+    schedule(&fast, now, now + 6'944'444ns, 0ms);
+    schedule(&slow, now + 2ms, now + 16'666'667ns, 1000ms);
+
+    QVERIFY(fastSpy.wait());
+    QCOMPARE(slowSpy.count(), 0);
+    QVERIFY(RenderLoopPrivate::get(&slow)->compositeTimer.isActive());
+}
+
+void TestRenderLoopScheduler::testRemovedRenderLoop()
+{
+    // render loops that are not managed by the scheduler are left alone
+    RenderLoop slow(nullptr);
+    RenderLoopPrivate::get(&slow)->renderJournal.add(8ms, 0ns);
+
+    RenderLoopScheduler scheduler;
+    scheduler.addRenderLoop(&slow);
+    {
+        RenderLoop fast(nullptr);
+        scheduler.addRenderLoop(&fast);
+        QCOMPARE(scheduler.renderLoops(), (QList<RenderLoop *>{&slow, &fast}));
+    }
+    QCOMPARE(scheduler.renderLoops(), QList<RenderLoop *>{&slow});
+
+    RenderLoop fast(nullptr);
+    scheduler.addRenderLoop(&fast);
+    scheduler.removeRenderLoop(&fast);
+    QCOMPARE(scheduler.renderLoops(), QList<RenderLoop *>{&slow});
+
+    QSignalSpy slowSpy(&slow, &RenderLoop::frameRequested);
+    QSignalSpy fastSpy(&fast, &RenderLoop::frameRequested);
+
+    const std::chrono::nanoseconds now = currentTime();
+    schedule(&slow, now, now + 16'666'667ns, 0ms);
+    schedule(&fast, now + 2ms, now + 6'944'444ns, 1000ms);
+
+    QVERIFY(slowSpy.wait());
+    QCOMPARE(fastSpy.count(), 0);
+    QVERIFY(RenderLoopPrivate::get(&fast)->compositeTimer.isActive());
+}
+
+QTEST_MAIN(TestRenderLoopScheduler)
+
+#include "test_renderloopscheduler.moc"
@@ -5,12 +5,14 @@
 */
 // Qt
 #include <QSignalSpy>
+#include <QSocketNotifier>
 #include <QTest>
 // KWin
 #include "wayland/compositor.h"
 #include "wayland/display.h"
 #include "wayland/subcompositor.h"
 #include "wayland/surface.h"
+#include "wayland/transaction.h"
 
 #include "KWayland/Client/compositor.h"
 #include "KWayland/Client/connection_thread.h"
@@ -33,6 +35,7 @@ class TestSubSurface : public QObject
 public:
     explicit TestSubSurface(QObject *parent = nullptr);
 private Q_SLOTS:
+    void initTestCase_data();
     void init();
     void cleanup();
 
@@ -56,6 +59,7 @@ private:
     KWin::Display *m_display;
     KWin::CompositorInterface *m_compositorInterface;
     KWin::SubCompositorInterface *m_subcompositorInterface;
+    KWin::TransactionQueue *m_transactionQueue = nullptr;
     KWayland::Client::ConnectionThread *m_connection;
     KWayland::Client::Compositor *m_compositor;
     KWayland::Client::ShmPool *m_shm;
@@ -80,6 +84,14 @@ TestSubSurface::TestSubSurface(QObject *parent)
 {
 }
 
+void TestSubSurface::initTestCase_data()
+{
+    QTest::addColumn<bool>("deferCommits");
+
+    QTest::addRow("immediate") << false;
+    QTest::addRow("deferred") << true;
+}
+
 void TestSubSurface::init()
 {
     using namespace KWin;
@@ -90,6 +102,16 @@ void TestSubSurface::init()
     QVERIFY(m_display->isRunning());
     m_display->createShm();
 
+    QFETCH_GLOBAL(bool, deferCommits);
+    if (deferCommits) {
+        // ready transactions are held back and applied once the display has dispatched all pending
+        // client requests, so commits made in one go are coalesced like between two frames
+        m_transactionQueue = new TransactionQueue(m_display);
+        QSocketNotifier *notifier = m_display->findChild<QSocketNotifier *>();
+        QVERIFY(notifier);
+        connect(notifier, &QSocketNotifier::activated, m_transactionQueue, &TransactionQueue::apply);
+    }
+
     // setup connection
     m_connection = new KWayland::Client::ConnectionThread;
     QSignalSpy connectedSpy(m_connection, &KWayland::Client::ConnectionThread::connected);
@@ -164,6 +186,9 @@ void TestSubSurface::cleanup()
 
     delete m_display;
     m_display = nullptr;
+
+    // the transaction queue is a child of the display
+    m_transactionQueue = nullptr;
 }
 
 void TestSubSurface::testCreate()
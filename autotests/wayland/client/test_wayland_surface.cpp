@@ -7,6 +7,7 @@
 #include <QImage>
 #include <QPainter>
 #include <QSignalSpy>
+#include <QSocketNotifier>
 #include <QTest>
 // KWin
 #include "core/graphicsbuffer.h"
@@ -17,6 +18,7 @@
 #include "wayland/idleinhibit_v1.h"
 #include "wayland/output.h"
 #include "wayland/surface.h"
+#include "wayland/transaction.h"
 
 #include "KWayland/Client/compositor.h"
 #include "KWayland/Client/connection_thread.h"
@@ -39,6 +41,7 @@ class TestWaylandSurface : public QObject
 public:
     explicit TestWaylandSurface(QObject *parent = nullptr);
 private Q_SLOTS:
+    void initTestCase_data();
     void init();
     void cleanup();
 
@@ -56,11 +59,16 @@ private Q_SLOTS:
     void testOutput();
     void testDisconnect();
     void testInhibit();
+    void testCoalesceCommits();
+    void testScaleChangeNotCoalesced();
+    void testOffsetNotCoalesced();
 
 private:
     KWin::Display *m_display;
     KWin::CompositorInterface *m_compositorInterface;
     KWin::IdleInhibitManagerV1Interface *m_idleInhibitInterface;
+    KWin::TransactionQueue *m_transactionQueue = nullptr;
+    QMetaObject::Connection m_applyTransactionsConnection;
     KWayland::Client::ConnectionThread *m_connection;
     KWayland::Client::Compositor *m_compositor;
     KWayland::Client::ShmPool *m_shm;
@@ -81,6 +89,14 @@ TestWaylandSurface::TestWaylandSurface(QObject *parent)
 {
 }
 
+void TestWaylandSurface::initTestCase_data()
+{
+    QTest::addColumn<bool>("deferCommits");
+
+    QTest::addRow("immediate") << false;
+    QTest::addRow("deferred") << true;
+}
+
 void TestWaylandSurface::init()
 {
     using namespace KWin;
@@ -97,6 +113,16 @@ void TestWaylandSurface::init()
     m_idleInhibitInterface = new IdleInhibitManagerV1Interface(m_display, m_display);
     QVERIFY(m_idleInhibitInterface);
 
+    QFETCH_GLOBAL(bool, deferCommits);
+    if (deferCommits) {
+        // ready transactions are held back and applied once the display has dispatched all pending
+        // client requests, so commits made in one go are coalesced like between two frames
+        m_transactionQueue = new TransactionQueue(m_display);
+        QSocketNotifier *notifier = m_display->findChild<QSocketNotifier *>();
+        QVERIFY(notifier);
+        m_applyTransactionsConnection = connect(notifier, &QSocketNotifier::activated, m_transactionQueue, &TransactionQueue::apply);
+    }
+
     // setup connection
     m_connection = new KWayland::Client::ConnectionThread;
     QSignalSpy connectedSpy(m_connection, &KWayland::Client::ConnectionThread::connected);
@@ -178,6 +204,7 @@ void TestWaylandSurface::cleanup()
     // these are the children of the display
     m_compositorInterface = nullptr;
     m_idleInhibitInterface = nullptr;
+    m_transactionQueue = nullptr;
 }
 
 void TestWaylandSurface::testStaticAccessor()
@@ -939,5 +966,142 @@ void TestWaylandSurface::testInhibit()
     QCOMPARE(inhibitsChangedSpy.count(), 4);
 }
 
+void TestWaylandSurface::testCoalesceCommits()
+{
+    // this test verifies that several commits of a surface between two frames are applied as one
+    QFETCH_GLOBAL(bool, deferCommits);
+    if (!deferCommits) {
+        QSKIP("commits are only coalesced while they are deferred");
+    }
+    // apply the queue manually, as the compositor does when it starts a frame
+    disconnect(m_applyTransactionsConnection);
+
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWin::CompositorInterface::surfaceCreated);
+    std::unique_ptr<KWayland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    KWin::SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<KWin::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+
+    QSignalSpy committedSpy(serverSurface, &KWin::SurfaceInterface::committed);
+    QSignalSpy damagedSpy(serverSurface, &KWin::SurfaceInterface::damaged);
+    QSignalSpy sizeChangedSpy(serverSurface, &KWin::SurfaceInterface::sizeChanged);
+    QSignalSpy transactionQueuedSpy(m_transactionQueue, &KWin::TransactionQueue::transactionQueued);
+    QSignalSpy frameRenderedSpy(s.get(), &KWayland::Client::Surface::frameRendered);
+
+    QImage black(100, 100, QImage::Format_ARGB32_Premultiplied);
+    black.fill(Qt::black);
+    QImage wide(200, 100, QImage::Format_ARGB32_Premultiplied);
+    wide.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(black));
+    s->damageBuffer(QRect(0, 0, 10, 10));
+    s->commit(KWayland::Client::Surface::CommitFlag::FrameCallback);
+    s->attachBuffer(m_shm->createBuffer(black));
+    s->damageBuffer(QRect(50, 50, 10, 10));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    s->attachBuffer(m_shm->createBuffer(wide));
+    s->damageBuffer(QRect(150, 0, 10, 10));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+
+    // requests are processed in order, so the commits have been handled once the next surface shows up
+    std::unique_ptr<KWayland::Client::Surface> fence(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+
+    QCOMPARE(transactionQueuedSpy.count(), 1);
+    QCOMPARE(committedSpy.count(), 0);
+    QVERIFY(!serverSurface->isMapped());
+
+    m_transactionQueue->apply();
+    QVERIFY(m_transactionQueue->isEmpty());
+    QCOMPARE(committedSpy.count(), 1);
+    QCOMPARE(damagedSpy.count(), 1);
+    QCOMPARE(sizeChangedSpy.count(), 1);
+    QCOMPARE(serverSurface->size(), QSizeF(200, 100));
+    QCOMPARE(serverSurface->buffer()->size(), QSize(200, 100));
+    QCOMPARE(serverSurface->bufferDamage(), QRegion(0, 0, 10, 10) | QRegion(50, 50, 10, 10) | QRegion(150, 0, 10, 10));
+
+    // the frame callback of the first commit is kept
+    serverSurface->frameRendered(1);
+    QVERIFY(frameRenderedSpy.wait());
+}
+
+void TestWaylandSurface::testScaleChangeNotCoalesced()
+{
+    // this test verifies that a commit that changes the buffer scale is applied after the queued one
+    QFETCH_GLOBAL(bool, deferCommits);
+    if (!deferCommits) {
+        QSKIP("commits are only coalesced while they are deferred");
+    }
+    disconnect(m_applyTransactionsConnection);
+
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWin::CompositorInterface::surfaceCreated);
+    std::unique_ptr<KWayland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    KWin::SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<KWin::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+
+    QSignalSpy committedSpy(serverSurface, &KWin::SurfaceInterface::committed);
+    QSignalSpy damagedSpy(serverSurface, &KWin::SurfaceInterface::damaged);
+
+    QImage black(100, 100, QImage::Format_ARGB32_Premultiplied);
+    black.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(black));
+    s->damageBuffer(QRect(0, 0, 100, 100));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    s->setScale(2);
+    s->attachBuffer(m_shm->createBuffer(black));
+    s->damageBuffer(QRect(0, 0, 20, 20));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+
+    std::unique_ptr<KWayland::Client::Surface> fence(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    QCOMPARE(committedSpy.count(), 0);
+
+    m_transactionQueue->apply();
+    QCOMPARE(committedSpy.count(), 2);
+    QCOMPARE(damagedSpy.count(), 2);
+    QCOMPARE(serverSurface->size(), QSizeF(50, 50));
+    QCOMPARE(serverSurface->bufferDamage(), QRegion(0, 0, 20, 20));
+}
+
+void TestWaylandSurface::testOffsetNotCoalesced()
+{
+    // this test verifies that commits with an offset are applied one by one, as the offsets add up
+    QFETCH_GLOBAL(bool, deferCommits);
+    if (!deferCommits) {
+        QSKIP("commits are only coalesced while they are deferred");
+    }
+    disconnect(m_applyTransactionsConnection);
+
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWin::CompositorInterface::surfaceCreated);
+    std::unique_ptr<KWayland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    KWin::SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<KWin::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+
+    QList<QPoint> offsets;
+    connect(serverSurface, &KWin::SurfaceInterface::committed, this, [&offsets, serverSurface]() {
+        offsets.append(serverSurface->offset());
+    });
+
+    QImage black(100, 100, QImage::Format_ARGB32_Premultiplied);
+    black.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(black), QPoint(5, 5));
+    s->damageBuffer(QRect(0, 0, 100, 100));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    s->attachBuffer(m_shm->createBuffer(black), QPoint(10, 0));
+    s->damageBuffer(QRect(0, 0, 10, 10));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    s->attachBuffer(m_shm->createBuffer(black));
+    s->damageBuffer(QRect(0, 0, 20, 20));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+
+    std::unique_ptr<KWayland::Client::Surface> fence(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    QVERIFY(offsets.isEmpty());
+
+    m_transactionQueue->apply();
+    QCOMPARE(offsets, (QList<QPoint>{QPoint(5, 5), QPoint(10, 0), QPoint(0, 0)}));
+}
+
 QTEST_GUILESS_MAIN(TestWaylandSurface)
 #include "test_wayland_surface.moc"
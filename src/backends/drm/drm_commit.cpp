@@ -7,6 +7,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "drm_commit.h"
+#include "core/graphicsbuffer.h"
 #include "core/renderbackend.h"
 #include "drm_blob.h"
 #include "drm_buffer.h"
@@ -15,6 +16,7 @@
 #include "drm_gpu.h"
 #include "drm_object.h"
 #include "drm_property.h"
+#include "utils/envvar.h"
 
 #include <QCoreApplication>
 #include <QThread>
@@ -25,6 +27,8 @@ using namespace std::chrono_literals;
 namespace KWin
 {
 
+static const bool s_disableTestCache = environmentVariableBoolValue("KWIN_DRM_DISABLE_TEST_CACHE").value_or(false);
+
 DrmCommit::DrmCommit(DrmGpu *gpu)
     : m_gpu(gpu)
 {
@@ -102,13 +106,107 @@ void DrmAtomicCommit::setPresentationMode(PresentationMode mode)
     m_mode = mode;
 }
 
-bool DrmAtomicCommit::test()
+size_t qHash(const DrmCommitSignature &signature, size_t seed)
+{
+    return qHashRange(signature.values.begin(), signature.values.end(), qHash(signature.flags, seed));
+}
+
+uint32_t DrmAtomicCommit::testFlags() const
 {
     uint32_t flags = DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_NONBLOCK;
     if (isTearing()) {
         flags |= DRM_MODE_PAGE_FLIP_ASYNC;
     }
-    return doCommit(flags);
+    return flags;
+}
+
+bool DrmAtomicCommit::test()
+{
+    return doCommit(testFlags());
+}
+
+bool DrmAtomicCommit::testCached(DrmTestCache *cache)
+{
+    Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+    const uint32_t flags = testFlags();
+    // whether an async flip is accepted depends on which properties differ from the
+    // current state of the crtc, which the signature doesn't capture
+    if (s_disableTestCache || (flags & DRM_MODE_PAGE_FLIP_ASYNC)) {
+        return doCommit(flags);
+    }
+    const auto sig = signature(flags);
+    if (!sig) {
+        return doCommit(flags);
+    }
+    if (const auto error = cache->result(*sig)) {
+        errno = *error;
+        return *error == 0;
+    }
+    const bool ret = doCommit(flags);
+    const int error = ret ? 0 : errno;
+    std::vector<std::shared_ptr<DrmBlob>> blobs;
+    blobs.reserve(m_blobs.size());
+    for (const auto &[prop, blob] : m_blobs) {
+        if (blob) {
+            blobs.push_back(blob);
+        }
+    }
+    cache->insert(*sig, error, std::move(blobs));
+    errno = error;
+    return ret;
+}
+
+std::optional<DrmCommitSignature> DrmAtomicCommit::signature(uint32_t flags) const
+{
+    // framebuffer ids are replaced by the layout of the buffer, and fences don't
+    // influence the result of a test at all
+    std::unordered_map<uint64_t, const DrmFramebuffer *> framebuffers;
+    std::unordered_set<uint64_t> fences;
+    const auto key = [](uint32_t object, uint32_t property) {
+        return (uint64_t(object) << 32) | property;
+    };
+    for (const auto &[plane, buffer] : m_buffers) {
+        framebuffers[key(plane->id(), plane->fbId.propId())] = buffer.get();
+        if (plane->inFenceFd.isValid()) {
+            fences.insert(key(plane->id(), plane->inFenceFd.propId()));
+        }
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> properties;
+    for (const auto &[object, objectProperties] : m_properties) {
+        for (const auto &[property, value] : objectProperties) {
+            const uint64_t propertyKey = key(object, property);
+            if (!fences.contains(propertyKey)) {
+                properties.emplace_back(propertyKey, value);
+            }
+        }
+    }
+    std::ranges::sort(properties);
+
+    DrmCommitSignature ret{
+        .flags = flags,
+    };
+    ret.values.reserve(properties.size() * 2);
+    for (const auto &[propertyKey, value] : properties) {
+        ret.values.push_back(propertyKey);
+        const auto it = framebuffers.find(propertyKey);
+        if (it == framebuffers.end() || !it->second) {
+            ret.values.push_back(value);
+            continue;
+        }
+        const GraphicsBuffer *buffer = it->second->buffer();
+        const DmaBufAttributes *attributes = buffer ? buffer->dmabufAttributes() : nullptr;
+        if (!attributes) {
+            return std::nullopt;
+        }
+        ret.values.push_back((uint64_t(attributes->width) << 32) | uint32_t(attributes->height));
+        ret.values.push_back((uint64_t(attributes->format) << 32) | uint32_t(attributes->planeCount));
+        ret.values.push_back(attributes->modifier);
+        for (int i = 0; i < attributes->planeCount; i++) {
+            ret.values.push_back((uint64_t(attributes->offset[i]) << 32) | attributes->pitch[i]);
+        }
+    }
+    return ret;
 }
 
 bool DrmAtomicCommit::testAllowModeset()
@@ -319,4 +417,49 @@ void DrmLegacyCommit::pageFlipped(std::chrono::nanoseconds timestamp)
     }
     m_pipeline->pageFlipped(timestamp);
 }
+std::optional<int> DrmTestCache::result(const DrmCommitSignature &signature)
+{
+    const auto it = m_entries.find(signature);
+    if (it == m_entries.end()) {
+        m_misses++;
+        return std::nullopt;
+    }
+    m_hits++;
+    it->lastUse = ++m_useCounter;
+    return it->error;
+}
+
+void DrmTestCache::insert(const DrmCommitSignature &signature, int error, std::vector<std::shared_ptr<DrmBlob>> &&blobs)
+{
+    if (m_entries.size() >= qsizetype(s_capacity) && !m_entries.contains(signature)) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); it++) {
+            if (it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        m_entries.erase(oldest);
+    }
+    m_entries.insert(signature, Entry{
+        .error = error,
+        .lastUse = ++m_useCounter,
+        .blobs = std::move(blobs),
+    });
+}
+
+void DrmTestCache::clear()
+{
+    m_entries.clear();
+}
+
+uint64_t DrmTestCache::hits() const
+{
+    return m_hits;
+}
+
+uint64_t DrmTestCache::misses() const
+{
+    return m_misses;
+}
+
 }
@@ -15,6 +15,7 @@
 #include <chrono>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "core/renderloop.h"
 #include "drm_pointer.h"
@@ -32,6 +33,7 @@ class DrmGpu;
 class DrmPlane;
 class DrmProperty;
 class DrmPipeline;
+class DrmTestCache;
 class OutputFrame;
 
 class DrmCommit
@@ -50,6 +52,21 @@ protected:
     bool m_defunct = false;
 };
 
+/**
+ * Describes everything a TEST_ONLY commit depends on: the commit flags and all property
+ * values, with framebuffer ids replaced by the layout of the buffers they refer to, so
+ * that tests with different buffers from the same swapchain compare equal.
+ */
+struct DrmCommitSignature
+{
+    uint32_t flags = 0;
+    std::vector<uint64_t> values;
+
+    bool operator==(const DrmCommitSignature &other) const = default;
+};
+
+size_t qHash(const DrmCommitSignature &signature, size_t seed = 0);
+
 class DrmAtomicCommit : public DrmCommit
 {
 public:
@@ -69,6 +86,11 @@ public:
     void setPresentationMode(PresentationMode mode);
 
     bool test();
+    /**
+     * Like test(), but reuses the result of an identical earlier test from @p cache
+     * instead of asking the kernel again. Must only be used on the main thread.
+     */
+    bool testCached(DrmTestCache *cache);
     bool testAllowModeset();
     bool commit();
     bool commitModeset();
@@ -91,6 +113,8 @@ public:
 
 private:
     bool doCommit(uint32_t flags);
+    uint32_t testFlags() const;
+    std::optional<DrmCommitSignature> signature(uint32_t flags) const;
 
     const QList<DrmPipeline *> m_pipelines;
     std::optional<std::chrono::steady_clock::time_point> m_targetPageflipTime;
@@ -122,4 +146,41 @@ private:
     PresentationMode m_mode = PresentationMode::VSync;
 };
 
+/**
+ * Remembers the results of atomic tests, as most frames test the same plane configuration
+ * as the frame before. The results are only valid for the current kernel state of the
+ * objects that aren't part of the tests, so the cache has to be cleared after modesets,
+ * hotplugs, failed commits, changes to the planes used by other crtcs and anything else
+ * that changes that state.
+ */
+class DrmTestCache
+{
+public:
+    /**
+     * @returns the errno value of the cached test, 0 if it succeeded,
+     *          or std::nullopt if the result isn't known yet
+     */
+    std::optional<int> result(const DrmCommitSignature &signature);
+    void insert(const DrmCommitSignature &signature, int error, std::vector<std::shared_ptr<DrmBlob>> &&blobs);
+    void clear();
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    static constexpr size_t s_capacity = 64;
+
+    struct Entry
+    {
+        int error;
+        uint64_t lastUse;
+        // the blob ids are part of the signature, keep them from being reused
+        std::vector<std::shared_ptr<DrmBlob>> blobs;
+    };
+    QHash<DrmCommitSignature, Entry> m_entries;
+    uint64_t m_useCounter = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
+
 }
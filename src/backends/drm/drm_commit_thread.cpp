@@ -22,9 +22,22 @@ using namespace std::chrono_literals;
 namespace KWin
 {
 
+static const std::optional<int> s_safetyMarginOverride = environmentVariableIntValue("KWIN_DRM_OVERRIDE_SAFETY_MARGIN");
+// the time it takes to commit + scheduling inaccuracies, until enough commits have been measured
+static const std::chrono::microseconds s_safetyMarginMinimum{s_safetyMarginOverride.value_or(1500)};
+// the commit margin is learned from this percentile of the measured commit latency, plus some slack
+static constexpr double s_commitLatencyPercentile = 0.99;
+static constexpr std::chrono::microseconds s_commitLatencySlack{250};
+static constexpr std::chrono::microseconds s_commitMarginMinimum{500};
+static constexpr uint32_t s_commitLatencyMinimumSamples = 60;
+
 DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
     : m_gpu(gpu)
     , m_targetPageflipTime(std::chrono::steady_clock::now())
+    , m_commitMargin(s_safetyMarginMinimum)
+    // With NVidia, the commit ioctl returning doesn't mean that the commit has been applied,
+    // so the measured latency can't be used to reduce the margin
+    , m_learnCommitMargin(!s_safetyMarginOverride && !gpu->isNVidia())
 {
     if (!gpu->atomicModeSetting()) {
         return;
@@ -76,6 +89,7 @@ DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
                 continue;
             }
             const auto now = std::chrono::steady_clock::now();
+            m_scheduledSubmitTime = std::max(now, m_targetPageflipTime - m_safetyMargin);
             if (m_targetPageflipTime > now + m_safetyMargin) {
                 lock.unlock();
                 std::this_thread::sleep_until(m_targetPageflipTime - m_safetyMargin);
@@ -130,6 +144,8 @@ DrmCommitThread::DrmCommitThread(DrmGpu *gpu, const QString &name)
                 if (m_commits.empty()) {
                     continue;
                 }
+                // the delay was intentional, it's not part of the commit latency
+                m_scheduledSubmitTime = std::chrono::steady_clock::now();
             }
             submit();
         }
@@ -153,6 +169,8 @@ void DrmCommitThread::submit()
         // after we return from the commit ioctl, but we don't have any better
         // way to know when it's done
         m_lastCommitTime = std::chrono::steady_clock::now();
+        m_commitLatency.add(m_lastCommitTime - m_scheduledSubmitTime);
+        updateCommitMargin();
         // this is when we wanted to have completed the commit
         const auto targetTimestamp = m_targetPageflipTime - m_baseSafetyMargin;
         // this is how much safety we need to add or remove to achieve that next time
@@ -190,10 +208,33 @@ void DrmCommitThread::submit()
         }
         m_commits.clear();
         qCWarning(KWIN_DRM) << "atomic commit failed:" << strerror(errno);
+        // the commit was tested before, so cached test results evidently don't
+        // match the kernel state anymore. The cache is only used on the main thread
+        QMetaObject::invokeMethod(this, [this]() {
+            m_gpu->testCache()->clear();
+        }, Qt::ConnectionType::QueuedConnection);
     }
     QMetaObject::invokeMethod(this, &DrmCommitThread::clearDroppedCommits, Qt::ConnectionType::QueuedConnection);
 }
 
+void DrmCommitThread::updateCommitMargin()
+{
+    if (!m_learnCommitMargin || m_commitLatency.count() < s_commitLatencyMinimumSamples) {
+        return;
+    }
+    const auto maximumReasonableMargin = std::min<std::chrono::nanoseconds>(3ms, m_minVblankInterval / 2);
+    const auto learned = std::clamp<std::chrono::nanoseconds>(m_commitLatency.percentile(s_commitLatencyPercentile) + s_commitLatencySlack,
+                                                              s_commitMarginMinimum, std::max<std::chrono::nanoseconds>(s_commitMarginMinimum, maximumReasonableMargin));
+    if (learned > m_commitMargin) {
+        // commits take longer than before, don't risk missing more frames
+        m_commitMargin = learned;
+    } else {
+        // there's headroom, slowly reduce the margin to reduce latency
+        m_commitMargin -= (m_commitMargin - learned) / 10;
+    }
+    m_baseSafetyMargin = m_vblankTime + m_commitMargin;
+}
+
 static std::unique_ptr<DrmAtomicCommit> mergeCommits(std::span<const std::unique_ptr<DrmAtomicCommit>> commits)
 {
     auto ret = std::make_unique<DrmAtomicCommit>(*commits.front());
@@ -359,17 +400,13 @@ void DrmCommitThread::clearDroppedCommits()
     m_commitsToDelete.clear();
 }
 
-// TODO reduce the default for this, once we have a more accurate way to know when an atomic commit
-// is actually applied. Waiting for the commit returning seems to work on Intel and AMD, but not with NVidia
-static const std::chrono::microseconds s_safetyMarginMinimum{environmentVariableIntValue("KWIN_DRM_OVERRIDE_SAFETY_MARGIN").value_or(1500)};
-
 void DrmCommitThread::setModeInfo(uint32_t maximum, std::chrono::nanoseconds vblankTime)
 {
     std::unique_lock lock(m_mutex);
     m_minVblankInterval = std::chrono::nanoseconds(1'000'000'000'000ull / maximum);
     // the kernel rejects commits that happen during vblank
-    // the 1.5ms on top of that was chosen experimentally, for the time it takes to commit + scheduling inaccuracies
-    m_baseSafetyMargin = vblankTime + s_safetyMarginMinimum;
+    m_vblankTime = vblankTime;
+    m_baseSafetyMargin = m_vblankTime + m_commitMargin;
     m_safetyMargin = m_baseSafetyMargin + m_additionalSafetyMargin;
 }
 
@@ -406,6 +443,12 @@ std::chrono::nanoseconds DrmCommitThread::safetyMargin() const
     return m_safetyMargin;
 }
 
+LatencyHistogram DrmCommitThread::commitLatency()
+{
+    std::unique_lock lock(m_mutex);
+    return m_commitLatency;
+}
+
 void DrmCommitThread::handlePing()
 {
     // this will process the pageflip and call pageFlipped if there is one
@@ -8,6 +8,8 @@
 */
 #pragma once
 
+#include "core/latencyhistogram.h"
+
 #include <QObject>
 #include <QThread>
 #include <condition_variable>
@@ -42,12 +44,18 @@ public:
      *         in order to get presented at that timestamp
      */
     std::chrono::nanoseconds safetyMargin() const;
+    /**
+     * @return how long it took from the moment a commit should have been submitted until
+     *         the commit ioctl returned, for recent commits
+     */
+    LatencyHistogram commitLatency();
 
 private:
     void clearDroppedCommits();
     TimePoint estimateNextVblank(TimePoint now) const;
     void optimizeCommits(TimePoint pageflipTarget);
     void submit();
+    void updateCommitMargin();
     void handlePing();
 
     DrmGpu *const m_gpu;
@@ -66,6 +74,15 @@ private:
     bool m_tearing = false;
     std::chrono::nanoseconds m_safetyMargin{0};
     std::chrono::nanoseconds m_baseSafetyMargin{0};
+    std::chrono::nanoseconds m_vblankTime{0};
+    /**
+     * the part of the base safety margin that covers waking up and committing,
+     * learned from m_commitLatency unless the margin is fixed
+     */
+    std::chrono::nanoseconds m_commitMargin;
+    const bool m_learnCommitMargin;
+    LatencyHistogram m_commitLatency;
+    TimePoint m_scheduledSubmitTime;
     std::chrono::nanoseconds m_additionalSafetyMargin = std::chrono::milliseconds(1);
     bool m_ping = false;
     bool m_pageflipTimeoutDetected = false;
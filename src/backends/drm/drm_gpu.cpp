@@ -229,6 +229,8 @@ bool DrmGpu::updateOutputs()
     if (!m_isActive) {
         return false;
     }
+    // connectors and leases may have changed behind our back
+    m_testCache.clear();
     DrmUniquePtr<drmModeRes> resources(drmModeGetResources(m_fd));
     if (!resources) {
         qCWarning(KWIN_DRM) << "drmModeGetResources failed:" << strerror(errno);
@@ -585,6 +587,11 @@ void DrmGpu::addDefunctCommit(std::unique_ptr<DrmCommit> &&commit)
     m_defunctCommits.push_back(std::move(commit));
 }
 
+DrmTestCache *DrmGpu::testCache()
+{
+    return &m_testCache;
+}
+
 void DrmGpu::removeOutput(DrmOutput *output)
 {
     qCDebug(KWIN_DRM) << "Removing output" << output;
@@ -616,6 +623,7 @@ std::unique_ptr<DrmLease> DrmGpu::leaseOutputs(const QList<DrmOutput *> &outputs
     if (alreadyLeased) {
         return nullptr;
     }
+    m_testCache.clear();
 
     // allocate crtcs for the outputss
     for (DrmOutput *output : outputs) {
@@ -745,6 +753,8 @@ void DrmGpu::setActive(bool active)
 {
     if (m_isActive != active) {
         m_isActive = active;
+        // another drm master may have changed the kernel state in the meantime
+        m_testCache.clear();
         if (active) {
             for (const DrmOutput *output : std::as_const(m_drmOutputs)) {
                 output->renderLoop()->uninhibit();
@@ -10,6 +10,7 @@
 
 #include "core/drmdevice.h"
 #include "drm_buffer.h"
+#include "drm_commit.h"
 #include "drm_pipeline.h"
 #include "utils/filedescriptor.h"
 #include "utils/version.h"
@@ -128,6 +129,7 @@ public:
     void dispatchEvents();
 
     void addDefunctCommit(std::unique_ptr<DrmCommit> &&commit);
+    DrmTestCache *testCache();
 
 Q_SIGNALS:
     void activeChanged(bool active);
@@ -189,6 +191,7 @@ private:
     bool m_inModeset = false;
     QHash<GraphicsBuffer *, std::weak_ptr<DrmFramebufferData>> m_fbCache;
     std::vector<std::unique_ptr<DrmCommit>> m_defunctCommits;
+    DrmTestCache m_testCache;
     QTimer m_delayedModesetTimer;
 };
 
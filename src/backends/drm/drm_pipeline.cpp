@@ -92,6 +92,7 @@ DrmPipeline::Error DrmPipeline::present(const QList<OutputLayer *> &layersToUpda
             return Error::InvalidArguments;
         }
         m_next.needsModesetProperties = m_pending.needsModesetProperties = false;
+        updatePlaneConfiguration();
         m_commitThread->addCommit(std::move(partialUpdate));
         return Error::None;
     } else {
@@ -157,6 +158,8 @@ DrmPipeline::Error DrmPipeline::commitPipelinesAtomic(const QList<DrmPipeline *>
         // and already was disabled before, to work around some quirks in old userspace.
         // Instead of using DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, do the modeset in a blocking
         // fashion without page flip events and trigger the pageflip notification directly
+        // Cached test results only apply to the modeset state they were tested against
+        pipelines.front()->gpu()->testCache()->clear();
         if (!commit->commitModeset()) {
             qCCritical(KWIN_DRM) << "Atomic modeset commit failed!" << strerror(errno);
             return errnoToError();
@@ -168,7 +171,7 @@ DrmPipeline::Error DrmPipeline::commitPipelinesAtomic(const QList<DrmPipeline *>
         return Error::None;
     }
     case CommitMode::Test: {
-        if (!commit->test()) {
+        if (!commit->testCached(pipelines.front()->gpu()->testCache())) {
             return errnoToError();
         }
         return Error::None;
@@ -448,6 +451,7 @@ bool DrmPipeline::presentAsync(OutputLayer *layer, std::optional<std::chrono::na
         auto partialUpdate = std::make_unique<DrmAtomicCommit>(QList<DrmPipeline *>{this});
         prepareAtomicPlane(partialUpdate.get(), drmLayer->plane(), drmLayer, nullptr);
         partialUpdate->setAllowedVrrDelay(allowedVrrDelay);
+        updatePlaneConfiguration();
         m_commitThread->addCommit(std::move(partialUpdate));
         return true;
     } else {
@@ -455,6 +459,40 @@ bool DrmPipeline::presentAsync(OutputLayer *layer, std::optional<std::chrono::na
     }
 }
 
+void DrmPipeline::updatePlaneConfiguration()
+{
+    std::vector<uint64_t> configuration;
+    for (const auto layer : std::as_const(m_pending.layers)) {
+        if (!layer->plane() || !layer->isEnabled()) {
+            continue;
+        }
+        const QSize sourceSize = layer->sourceRect().toRect().size();
+        const QSize targetSize = layer->targetRect().size();
+        configuration.push_back(layer->plane()->id());
+        configuration.push_back((uint64_t(sourceSize.width()) << 32) | uint32_t(sourceSize.height()));
+        configuration.push_back((uint64_t(targetSize.width()) << 32) | uint32_t(targetSize.height()));
+        const auto fb = layer->currentBuffer();
+        const DmaBufAttributes *attributes = fb && fb->buffer() ? fb->buffer()->dmabufAttributes() : nullptr;
+        if (attributes) {
+            configuration.push_back(attributes->format);
+            configuration.push_back(attributes->modifier);
+        }
+    }
+    if (configuration == m_planeConfiguration) {
+        return;
+    }
+    m_planeConfiguration = std::move(configuration);
+    // Cached tests only cover the planes of the tested pipelines, but whether they pass can
+    // depend on the planes used by other crtcs as well, for example with shared bandwidth
+    const auto pipelines = gpu()->pipelines();
+    const bool otherPipelines = std::ranges::any_of(pipelines, [this](DrmPipeline *pipeline) {
+        return pipeline != this && pipeline->m_pending.crtc && pipeline->m_pending.active;
+    });
+    if (otherPipelines) {
+        gpu()->testCache()->clear();
+    }
+}
+
 void DrmPipeline::applyPendingChanges()
 {
     const bool layersChanged = m_next.layers != m_pending.layers;
@@ -483,6 +521,7 @@ void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp)
     m_commitThread->pageFlipped(timestamp);
     // the commit thread adjusts the safety margin on every commit
     m_output->renderLoop()->setPresentationSafetyMargin(m_commitThread->safetyMargin());
+    m_output->renderLoop()->setCommitLatency(m_commitThread->commitLatency());
     if (gpu()->needsModeset()) {
         gpu()->maybeModeset(nullptr, nullptr);
     }
@@ -136,6 +136,7 @@ private:
     Error prepareAtomicPresentation(DrmAtomicCommit *commit, const std::shared_ptr<OutputFrame> &frame);
     Error prepareAtomicPlane(DrmAtomicCommit *commit, DrmPlane *plane, DrmPipelineLayer *layer, const std::shared_ptr<OutputFrame> &frame);
     void prepareAtomicDisable(DrmAtomicCommit *commit);
+    void updatePlaneConfiguration();
     static Error commitPipelinesAtomic(const QList<DrmPipeline *> &pipelines, CommitMode mode, const std::shared_ptr<OutputFrame> &frame, const QList<DrmObject *> &unusedObjects);
 
     DrmOutput *m_output = nullptr;
@@ -143,6 +144,8 @@ private:
 
     bool m_modesetPresentPending = false;
     ColorPipeline m_currentLegacyGamma;
+    // which planes were last presented, with their sizes and buffer layouts
+    std::vector<uint64_t> m_planeConfiguration;
 
     struct State
     {
@@ -9,6 +9,7 @@
 #include "connection.h"
 #include "context.h"
 #include "device.h"
+#include "eventqueue.h"
 #include "events.h"
 
 // TODO: Make it compile also in testing environment
@@ -101,6 +102,7 @@ Connection *Connection::create(Session *session)
 
 Connection::Connection(std::unique_ptr<Context> &&input)
     : m_notifier(nullptr)
+    , m_eventQueue(std::make_unique<EventQueue>())
     , m_connectionAdaptor(std::make_unique<ConnectionAdaptor>(this))
     , m_input(std::move(input))
 {
@@ -116,7 +118,7 @@ Connection::~Connection()
         Q_EMIT deviceRemoved(device);
     }
 
-    m_eventQueue.clear();
+    m_eventQueue.reset();
     qDeleteAll(m_devices);
     qDeleteAll(m_tools);
 }
@@ -159,21 +161,53 @@ void Connection::deactivate()
 
 void Connection::handleEvent()
 {
+    // the lock only guards libinput against the device handling in the main thread,
+    // the event queue itself doesn't need it
     QMutexLocker locker(&m_mutex);
-    const bool wasEmpty = m_eventQueue.empty();
+    bool notify = false;
     do {
+        if (m_eventQueue->isFull()) {
+            // leave the remaining events in libinput and stop watching the fd until processEvents()
+            // has made room, otherwise the notifier fires over and over again
+            if (m_notifier) {
+                m_notifier->setEnabled(false);
+            }
+            m_eventQueueFull = true;
+            notify = true;
+            break;
+        }
         m_input->dispatch();
-        std::unique_ptr<Event> event = m_input->event();
+        libinput_event *event = libinput_get_event(*m_input);
         if (!event) {
             break;
         }
-        m_eventQueue.push_back(std::move(event));
+        m_eventQueue->push(event);
+        notify = true;
     } while (true);
-    if (wasEmpty && !m_eventQueue.empty()) {
+    if (notify && !m_eventsReadPending.exchange(true)) {
         Q_EMIT eventsRead();
     }
 }
 
+void Connection::resumeReading()
+{
+    if (m_notifier) {
+        m_notifier->setEnabled(true);
+    }
+    handleEvent();
+}
+
+void Connection::resumeReadingIfDrained()
+{
+    // wait until half of the queue is free, so the reader isn't woken up for every single slot
+    if (!m_eventQueueFull || m_eventQueue->size() > m_eventQueue->capacity() / 2) {
+        return;
+    }
+    if (m_eventQueueFull.exchange(false)) {
+        QMetaObject::invokeMethod(this, &Connection::resumeReading, Qt::QueuedConnection);
+    }
+}
+
 #ifndef KWIN_BUILD_TESTING
 QPointF devicePointToGlobalPosition(const QPointF &devicePos, const Output *output)
 {
@@ -228,6 +262,7 @@ TabletTool *Connection::getOrCreateTool(libinput_tablet_tool *handle)
         }
     }
 
+    QMutexLocker locker(&m_mutex);
     auto tool = new TabletTool(handle);
     tool->moveToThread(thread());
     m_tools.append(tool);
@@ -237,10 +272,15 @@ TabletTool *Connection::getOrCreateTool(libinput_tablet_tool *handle)
 
 void Connection::processEvents()
 {
-    QMutexLocker locker(&m_mutex);
-    while (m_eventQueue.size() != 0) {
-        std::unique_ptr<Event> event = std::move(m_eventQueue.front());
-        m_eventQueue.pop_front();
+    // events that are queued from now on need another pass
+    m_eventsReadPending = false;
+
+    while (Event *event = m_eventQueue->peek()) {
+        // The handlers of the signals call into libinput, e.g. to update the keyboard LEDs or
+        // to configure devices, while the reader thread dispatches it. The lock is taken for
+        // every single event, so the reader can go on in between.
+        QMutexLocker locker(&m_mutex);
+        size_t consumed = 1;
         switch (event->type()) {
         case LIBINPUT_EVENT_DEVICE_ADDED: {
             auto device = new Device(event->nativeDevice());
@@ -276,7 +316,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_KEYBOARD_KEY: {
-            KeyEvent *ke = static_cast<KeyEvent *>(event.get());
+            KeyEvent *ke = static_cast<KeyEvent *>(event);
             const int seatKeyCount = libinput_event_keyboard_get_seat_key_count(*ke);
             const int keyState = libinput_event_keyboard_get_key_state(*ke);
             if ((keyState == LIBINPUT_KEY_STATE_PRESSED && seatKeyCount != 1) ||
@@ -287,7 +327,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_POINTER_SCROLL_WHEEL: {
-            const PointerEvent *pointerEvent = static_cast<PointerEvent *>(event.get());
+            const PointerEvent *pointerEvent = static_cast<PointerEvent *>(event);
             const auto axes = pointerEvent->axis();
             for (const PointerAxis &axis : axes) {
                 Q_EMIT pointerEvent->device()->pointerAxisChanged(axis,
@@ -302,7 +342,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_POINTER_SCROLL_FINGER: {
-            const PointerEvent *pointerEvent = static_cast<PointerEvent *>(event.get());
+            const PointerEvent *pointerEvent = static_cast<PointerEvent *>(event);
             const auto axes = pointerEvent->axis();
             for (const PointerAxis &axis : axes) {
                 Q_EMIT pointerEvent->device()->pointerAxisChanged(axis,
@@ -317,7 +357,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_POINTER_SCROLL_CONTINUOUS: {
-            const PointerEvent *pointerEvent = static_cast<PointerEvent *>(event.get());
+            const PointerEvent *pointerEvent = static_cast<PointerEvent *>(event);
             const auto axes = pointerEvent->axis();
             for (const PointerAxis &axis : axes) {
                 Q_EMIT pointerEvent->device()->pointerAxisChanged(axis,
@@ -332,7 +372,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_POINTER_BUTTON: {
-            PointerEvent *pe = static_cast<PointerEvent *>(event.get());
+            PointerEvent *pe = static_cast<PointerEvent *>(event);
             const int seatButtonCount = libinput_event_pointer_get_seat_button_count(*pe);
             const int buttonState = libinput_event_pointer_get_button_state(*pe);
             if ((buttonState == LIBINPUT_BUTTON_STATE_PRESSED && seatButtonCount != 1) ||
@@ -344,28 +384,26 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_POINTER_MOTION: {
-            PointerEvent *pe = static_cast<PointerEvent *>(event.get());
+            PointerEvent *pe = static_cast<PointerEvent *>(event);
             auto delta = pe->delta();
             auto deltaNonAccel = pe->deltaUnaccelerated();
             auto latestTime = pe->time();
-            auto it = m_eventQueue.begin();
-            while (it != m_eventQueue.end()) {
-                if ((*it)->type() == LIBINPUT_EVENT_POINTER_MOTION) {
-                    std::unique_ptr<PointerEvent> p{static_cast<PointerEvent *>(it->release())};
-                    delta += p->delta();
-                    deltaNonAccel += p->deltaUnaccelerated();
-                    latestTime = p->time();
-                    it = m_eventQueue.erase(it);
-                } else {
+            while (Event *next = m_eventQueue->peek(consumed)) {
+                if (next->type() != LIBINPUT_EVENT_POINTER_MOTION) {
                     break;
                 }
+                const PointerEvent *p = static_cast<PointerEvent *>(next);
+                delta += p->delta();
+                deltaNonAccel += p->deltaUnaccelerated();
+                latestTime = p->time();
+                ++consumed;
             }
             Q_EMIT pe->device()->pointerMotion(delta, deltaNonAccel, latestTime, pe->device());
             Q_EMIT pe->device()->pointerFrame(pe->device());
             break;
         }
         case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: {
-            PointerEvent *pe = static_cast<PointerEvent *>(event.get());
+            PointerEvent *pe = static_cast<PointerEvent *>(event);
             if (workspace()) {
                 Q_EMIT pe->device()->pointerMotionAbsolute(pe->absolutePos(workspace()->geometry().size()), pe->time(), pe->device());
                 Q_EMIT pe->device()->pointerFrame(pe->device());
@@ -374,7 +412,7 @@ void Connection::processEvents()
         }
         case LIBINPUT_EVENT_TOUCH_DOWN: {
 #ifndef KWIN_BUILD_TESTING
-            TouchEvent *te = static_cast<TouchEvent *>(event.get());
+            TouchEvent *te = static_cast<TouchEvent *>(event);
             const auto *output = te->device()->output();
             if (!output) {
                 qCWarning(KWIN_LIBINPUT) << "Touch down received for device with no output assigned";
@@ -386,7 +424,7 @@ void Connection::processEvents()
 #endif
         }
         case LIBINPUT_EVENT_TOUCH_UP: {
-            TouchEvent *te = static_cast<TouchEvent *>(event.get());
+            TouchEvent *te = static_cast<TouchEvent *>(event);
             const auto *output = te->device()->output();
             if (!output) {
                 break;
@@ -396,7 +434,7 @@ void Connection::processEvents()
         }
         case LIBINPUT_EVENT_TOUCH_MOTION: {
 #ifndef KWIN_BUILD_TESTING
-            TouchEvent *te = static_cast<TouchEvent *>(event.get());
+            TouchEvent *te = static_cast<TouchEvent *>(event);
             const auto *output = te->device()->output();
             if (!output) {
                 break;
@@ -415,17 +453,17 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN: {
-            PinchGestureEvent *pe = static_cast<PinchGestureEvent *>(event.get());
+            PinchGestureEvent *pe = static_cast<PinchGestureEvent *>(event);
             Q_EMIT pe->device()->pinchGestureBegin(pe->fingerCount(), pe->time(), pe->device());
             break;
         }
         case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE: {
-            PinchGestureEvent *pe = static_cast<PinchGestureEvent *>(event.get());
+            PinchGestureEvent *pe = static_cast<PinchGestureEvent *>(event);
             Q_EMIT pe->device()->pinchGestureUpdate(pe->scale(), pe->angleDelta(), pe->delta(), pe->time(), pe->device());
             break;
         }
         case LIBINPUT_EVENT_GESTURE_PINCH_END: {
-            PinchGestureEvent *pe = static_cast<PinchGestureEvent *>(event.get());
+            PinchGestureEvent *pe = static_cast<PinchGestureEvent *>(event);
             if (pe->isCancelled()) {
                 Q_EMIT pe->device()->pinchGestureCancelled(pe->time(), pe->device());
             } else {
@@ -434,17 +472,17 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN: {
-            SwipeGestureEvent *se = static_cast<SwipeGestureEvent *>(event.get());
+            SwipeGestureEvent *se = static_cast<SwipeGestureEvent *>(event);
             Q_EMIT se->device()->swipeGestureBegin(se->fingerCount(), se->time(), se->device());
             break;
         }
         case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE: {
-            SwipeGestureEvent *se = static_cast<SwipeGestureEvent *>(event.get());
+            SwipeGestureEvent *se = static_cast<SwipeGestureEvent *>(event);
             Q_EMIT se->device()->swipeGestureUpdate(se->delta(), se->time(), se->device());
             break;
         }
         case LIBINPUT_EVENT_GESTURE_SWIPE_END: {
-            SwipeGestureEvent *se = static_cast<SwipeGestureEvent *>(event.get());
+            SwipeGestureEvent *se = static_cast<SwipeGestureEvent *>(event);
             if (se->isCancelled()) {
                 Q_EMIT se->device()->swipeGestureCancelled(se->time(), se->device());
             } else {
@@ -453,12 +491,12 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_GESTURE_HOLD_BEGIN: {
-            HoldGestureEvent *he = static_cast<HoldGestureEvent *>(event.get());
+            HoldGestureEvent *he = static_cast<HoldGestureEvent *>(event);
             Q_EMIT he->device()->holdGestureBegin(he->fingerCount(), he->time(), he->device());
             break;
         }
         case LIBINPUT_EVENT_GESTURE_HOLD_END: {
-            HoldGestureEvent *he = static_cast<HoldGestureEvent *>(event.get());
+            HoldGestureEvent *he = static_cast<HoldGestureEvent *>(event);
             if (he->isCancelled()) {
                 Q_EMIT he->device()->holdGestureCancelled(he->time(), he->device());
             } else {
@@ -467,16 +505,13 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_SWITCH_TOGGLE: {
-            SwitchEvent *se = static_cast<SwitchEvent *>(event.get());
+            SwitchEvent *se = static_cast<SwitchEvent *>(event);
             Q_EMIT se->device()->switchToggle(se->state(), se->time(), se->device());
             break;
         }
         case LIBINPUT_EVENT_TABLET_TOOL_AXIS: {
-            auto *tte = static_cast<TabletToolEvent *>(event.get());
-            if (libinput_tablet_tool_config_pressure_range_is_available(tte->tool())) {
-                tte->device()->setSupportsPressureRange(true);
-                libinput_tablet_tool_config_pressure_range_set(tte->tool(), tte->device()->pressureRangeMin(), tte->device()->pressureRangeMax());
-            }
+            auto *tte = static_cast<TabletToolEvent *>(event);
+            applyPressureRange(tte);
 
             if (event->device()->tabletToolIsRelative()) {
                 Q_EMIT event->device()->tabletToolAxisEventRelative(tte->delta(),
@@ -506,11 +541,8 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY: {
-            auto *tte = static_cast<TabletToolEvent *>(event.get());
-            if (libinput_tablet_tool_config_pressure_range_is_available(tte->tool())) {
-                tte->device()->setSupportsPressureRange(true);
-                libinput_tablet_tool_config_pressure_range_set(tte->tool(), tte->device()->pressureRangeMin(), tte->device()->pressureRangeMax());
-            }
+            auto *tte = static_cast<TabletToolEvent *>(event);
+            applyPressureRange(tte);
             Q_EMIT event->device()->tabletToolProximityEvent(tabletToolPosition(tte),
                                                              tte->xTilt(),
                                                              tte->yTilt(),
@@ -524,11 +556,8 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_TABLET_TOOL_TIP: {
-            auto *tte = static_cast<TabletToolEvent *>(event.get());
-            if (libinput_tablet_tool_config_pressure_range_is_available(tte->tool())) {
-                tte->device()->setSupportsPressureRange(true);
-                libinput_tablet_tool_config_pressure_range_set(tte->tool(), tte->device()->pressureRangeMin(), tte->device()->pressureRangeMax());
-            }
+            auto *tte = static_cast<TabletToolEvent *>(event);
+            applyPressureRange(tte);
             Q_EMIT event->device()->tabletToolTipEvent(tabletToolPosition(tte),
                                                        tte->device()->pressureCurve().valueForProgress(tte->pressure()),
                                                        tte->xTilt(),
@@ -543,14 +572,14 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_TABLET_TOOL_BUTTON: {
-            auto *tabletEvent = static_cast<TabletToolButtonEvent *>(event.get());
+            auto *tabletEvent = static_cast<TabletToolButtonEvent *>(event);
             Q_EMIT event->device()->tabletToolButtonEvent(tabletEvent->buttonId(),
                                                           tabletEvent->isButtonPressed(),
                                                           getOrCreateTool(tabletEvent->tool()), tabletEvent->time(), tabletEvent->device());
             break;
         }
         case LIBINPUT_EVENT_TABLET_PAD_BUTTON: {
-            auto *tabletEvent = static_cast<TabletPadButtonEvent *>(event.get());
+            auto *tabletEvent = static_cast<TabletPadButtonEvent *>(event);
             Q_EMIT event->device()->tabletPadButtonEvent(tabletEvent->buttonId(),
                                                          tabletEvent->isButtonPressed(),
                                                          tabletEvent->group(),
@@ -560,7 +589,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_TABLET_PAD_RING: {
-            auto *tabletEvent = static_cast<TabletPadRingEvent *>(event.get());
+            auto *tabletEvent = static_cast<TabletPadRingEvent *>(event);
             tabletEvent->position();
             Q_EMIT event->device()->tabletPadRingEvent(tabletEvent->number(),
                                                        tabletEvent->position(),
@@ -571,7 +600,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_TABLET_PAD_STRIP: {
-            auto *tabletEvent = static_cast<TabletPadStripEvent *>(event.get());
+            auto *tabletEvent = static_cast<TabletPadStripEvent *>(event);
             Q_EMIT event->device()->tabletPadStripEvent(tabletEvent->number(),
                                                         tabletEvent->position(),
                                                         tabletEvent->source() == LIBINPUT_TABLET_PAD_STRIP_SOURCE_FINGER,
@@ -581,7 +610,7 @@ void Connection::processEvents()
             break;
         }
         case LIBINPUT_EVENT_TABLET_PAD_DIAL: {
-            auto *tabletEvent = static_cast<TabletPadDialEvent *>(event.get());
+            auto *tabletEvent = static_cast<TabletPadDialEvent *>(event);
             Q_EMIT event->device()->tabletPadDialEvent(tabletEvent->number(), tabletEvent->delta(), tabletEvent->group(), tabletEvent->time(), tabletEvent->device());
             break;
         }
@@ -589,6 +618,21 @@ void Connection::processEvents()
             // nothing
             break;
         }
+        m_eventQueue->pop(consumed);
+        resumeReadingIfDrained();
+    }
+
+    // the reader may have found the queue full right before it was drained
+    resumeReadingIfDrained();
+}
+
+void Connection::applyPressureRange(TabletToolEvent *event)
+{
+    // the reader thread dispatches libinput concurrently
+    QMutexLocker locker(&m_mutex);
+    if (libinput_tablet_tool_config_pressure_range_is_available(event->tool())) {
+        event->device()->setSupportsPressureRange(true);
+        libinput_tablet_tool_config_pressure_range_set(event->tool(), event->device()->pressureRangeMin(), event->device()->pressureRangeMax());
     }
 }
 
@@ -703,6 +747,7 @@ void Connection::slotKGlobalSettingsNotifyChange(int type, int arg)
 {
     if (type == 3 /**SettingsChanged**/ && arg == 0 /** SETTINGS_MOUSE */) {
         m_config->reparseConfiguration();
+        QMutexLocker locker(&m_mutex);
         for (auto it = m_devices.constBegin(), end = m_devices.constEnd(); it != end; ++it) {
             if ((*it)->isPointer()) {
                 applyDeviceConfig(*it);
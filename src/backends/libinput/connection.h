@@ -18,7 +18,8 @@
 #include <QRecursiveMutex>
 #include <QSize>
 #include <QStringList>
-#include <deque>
+
+#include <atomic>
 
 class QSocketNotifier;
 class QThread;
@@ -35,10 +36,12 @@ namespace LibInput
 {
 
 class Event;
+class EventQueue;
 class Device;
 class Context;
 class ConnectionAdaptor;
 class TabletTool;
+class TabletToolEvent;
 
 class KWIN_EXPORT Connection : public QObject
 {
@@ -73,6 +76,9 @@ private Q_SLOTS:
 private:
     Connection(std::unique_ptr<Context> &&input);
     void handleEvent();
+    void resumeReading();
+    void resumeReadingIfDrained();
+    void applyPressureRange(TabletToolEvent *event);
     void applyDeviceConfig(Device *device);
     void applyScreenToDevice(Device *device);
     void doSetup();
@@ -80,7 +86,9 @@ private:
 
     std::unique_ptr<QSocketNotifier> m_notifier;
     QRecursiveMutex m_mutex;
-    std::deque<std::unique_ptr<Event>> m_eventQueue;
+    std::unique_ptr<EventQueue> m_eventQueue;
+    std::atomic<bool> m_eventsReadPending = false;
+    std::atomic<bool> m_eventQueueFull = false;
     QList<Device *> m_devices;
     QList<TabletTool *> m_tools;
     KSharedConfigPtr m_config;
@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "eventqueue.h"
+
+#include <bit>
+
+namespace KWin
+{
+namespace LibInput
+{
+
+EventQueue::EventQueue(size_t capacity)
+    : m_slots(std::make_unique<Slot[]>(capacity))
+    , m_mask(capacity - 1)
+{
+    Q_ASSERT(std::has_single_bit(capacity));
+}
+
+EventQueue::~EventQueue()
+{
+    const size_t head = m_head.load(std::memory_order_acquire);
+    for (; m_reclaimed != head; ++m_reclaimed) {
+        Slot &slot = m_slots[m_reclaimed & m_mask];
+        slot.event->~Event();
+        slot.event = nullptr;
+    }
+}
+
+size_t EventQueue::capacity() const
+{
+    return m_mask + 1;
+}
+
+bool EventQueue::isFull()
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_reclaimed < capacity()) {
+        return false;
+    }
+    reclaim();
+    return head - m_reclaimed == capacity();
+}
+
+void EventQueue::push(libinput_event *event)
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    Q_ASSERT(head - m_reclaimed < capacity());
+
+    Slot &slot = m_slots[head & m_mask];
+    slot.event = Event::create(event, slot.storage);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void EventQueue::reclaim()
+{
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    for (; m_reclaimed != tail; ++m_reclaimed) {
+        Slot &slot = m_slots[m_reclaimed & m_mask];
+        slot.event->~Event();
+        slot.event = nullptr;
+    }
+}
+
+Event *EventQueue::peek(size_t index) const
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    if (head - tail <= index) {
+        return nullptr;
+    }
+    return m_slots[(tail + index) & m_mask].event;
+}
+
+size_t EventQueue::size() const
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    return head - tail;
+}
+
+void EventQueue::pop(size_t count)
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    Q_ASSERT(m_head.load(std::memory_order_acquire) - tail >= count);
+    m_tail.store(tail + count, std::memory_order_release);
+}
+
+} // namespace LibInput
+} // namespace KWin
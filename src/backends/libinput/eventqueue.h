@@ -0,0 +1,82 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "events.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace KWin
+{
+namespace LibInput
+{
+
+/**
+ * A bounded lock-free queue that passes events from the thread reading libinput (the producer)
+ * to the thread processing them (the consumer).
+ *
+ * The event wrappers are constructed in preallocated slots, so queuing an event doesn't allocate.
+ * Popping an event only hands its slot back; the event is destroyed by the producer in reclaim(),
+ * which keeps all libinput_event_destroy() calls on the thread that dispatches libinput.
+ */
+class KWIN_EXPORT EventQueue
+{
+public:
+    /**
+     * Creates a queue with room for @a capacity events, it must be a power of two.
+     */
+    explicit EventQueue(size_t capacity = 1024);
+    ~EventQueue();
+
+    size_t capacity() const;
+
+    // The following functions may only be called by the producer
+    /**
+     * Returns @c true if no more events can be pushed before the consumer pops some.
+     */
+    bool isFull();
+    /**
+     * Wraps and queues the @a event, the queue takes the ownership of it. The queue must not be full.
+     */
+    void push(libinput_event *event);
+    /**
+     * Destroys the events that the consumer has popped.
+     */
+    void reclaim();
+
+    // The following functions may only be called by the consumer
+    /**
+     * Returns the event @a index positions after the head of the queue, or @c nullptr if there's
+     * no such event yet.
+     */
+    Event *peek(size_t index = 0) const;
+    /**
+     * Returns the number of events that have been pushed but not popped yet.
+     */
+    size_t size() const;
+    /**
+     * Pops @a count events from the head of the queue. The popped events must not be used anymore.
+     */
+    void pop(size_t count = 1);
+
+private:
+    struct Slot
+    {
+        alignas(std::max_align_t) std::byte storage[Event::maximumSize()];
+        Event *event = nullptr;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    const size_t m_mask;
+    size_t m_reclaimed = 0; // owned by the producer, all slots before it are free
+    alignas(64) std::atomic<size_t> m_head{0}; // written by the producer
+    alignas(64) std::atomic<size_t> m_tail{0}; // written by the consumer
+};
+
+} // namespace LibInput
+} // namespace KWin
@@ -11,12 +11,28 @@
 
 #include <QSize>
 
+#include <new>
+
 namespace KWin
 {
 namespace LibInput
 {
 
+template<typename T, typename... Args>
+static T *construct(void *storage, Args &&...args)
+{
+    if (storage) {
+        return new (storage) T(std::forward<Args>(args)...);
+    }
+    return new T(std::forward<Args>(args)...);
+}
+
 std::unique_ptr<Event> Event::create(libinput_event *event)
+{
+    return std::unique_ptr<Event>(create(event, nullptr));
+}
+
+Event *Event::create(libinput_event *event, void *storage)
 {
     if (!event) {
         return nullptr;
@@ -26,49 +42,52 @@ std::unique_ptr<Event> Event::create(libinput_event *event)
     // TODO: add device notify events
     switch (t) {
     case LIBINPUT_EVENT_KEYBOARD_KEY:
-        return std::make_unique<KeyEvent>(event);
+        return construct<KeyEvent>(storage, event);
     case LIBINPUT_EVENT_POINTER_SCROLL_WHEEL:
     case LIBINPUT_EVENT_POINTER_SCROLL_FINGER:
     case LIBINPUT_EVENT_POINTER_SCROLL_CONTINUOUS:
     case LIBINPUT_EVENT_POINTER_BUTTON:
     case LIBINPUT_EVENT_POINTER_MOTION:
     case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-        return std::make_unique<PointerEvent>(event, t);
+        return construct<PointerEvent>(storage, event, t);
     case LIBINPUT_EVENT_TOUCH_DOWN:
     case LIBINPUT_EVENT_TOUCH_UP:
     case LIBINPUT_EVENT_TOUCH_MOTION:
     case LIBINPUT_EVENT_TOUCH_CANCEL:
     case LIBINPUT_EVENT_TOUCH_FRAME:
-        return std::make_unique<TouchEvent>(event, t);
+        return construct<TouchEvent>(storage, event, t);
     case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
     case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
     case LIBINPUT_EVENT_GESTURE_SWIPE_END:
-        return std::make_unique<SwipeGestureEvent>(event, t);
+        return construct<SwipeGestureEvent>(storage, event, t);
     case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
     case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
     case LIBINPUT_EVENT_GESTURE_PINCH_END:
-        return std::make_unique<PinchGestureEvent>(event, t);
+        return construct<PinchGestureEvent>(storage, event, t);
     case LIBINPUT_EVENT_GESTURE_HOLD_BEGIN:
     case LIBINPUT_EVENT_GESTURE_HOLD_END:
-        return std::make_unique<HoldGestureEvent>(event, t);
+        return construct<HoldGestureEvent>(storage, event, t);
     case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
     case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
     case LIBINPUT_EVENT_TABLET_TOOL_TIP:
-        return std::make_unique<TabletToolEvent>(event, t);
+        return construct<TabletToolEvent>(storage, event, t);
     case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
-        return std::make_unique<TabletToolButtonEvent>(event, t);
+        return construct<TabletToolButtonEvent>(storage, event, t);
     case LIBINPUT_EVENT_TABLET_PAD_RING:
-        return std::make_unique<TabletPadRingEvent>(event, t);
+        return construct<TabletPadRingEvent>(storage, event, t);
     case LIBINPUT_EVENT_TABLET_PAD_STRIP:
-        return std::make_unique<TabletPadStripEvent>(event, t);
+        return construct<TabletPadStripEvent>(storage, event, t);
     case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
-        return std::make_unique<TabletPadButtonEvent>(event, t);
+        return construct<TabletPadButtonEvent>(storage, event, t);
     case LIBINPUT_EVENT_SWITCH_TOGGLE:
-        return std::make_unique<SwitchEvent>(event, t);
+        return construct<SwitchEvent>(storage, event, t);
     case LIBINPUT_EVENT_TABLET_PAD_DIAL:
-        return std::make_unique<TabletPadDialEvent>(event, t);
+        return construct<TabletPadDialEvent>(storage, event, t);
     default:
-        return std::unique_ptr<Event>{new Event(event, t)};
+        if (storage) {
+            return new (storage) Event(event, t);
+        }
+        return new Event(event, t);
     }
 }
 
@@ -12,6 +12,8 @@
 
 #include <libinput.h>
 
+#include <algorithm>
+
 namespace KWin
 {
 namespace LibInput
@@ -38,6 +40,13 @@ public:
     }
 
     static std::unique_ptr<Event> create(libinput_event *event);
+    /**
+     * Constructs the wrapper for @a event in the given @a storage, which must be suitably
+     * aligned and at least maximumSize() bytes big. The returned event must be destroyed by
+     * calling its destructor explicitly.
+     */
+    static Event *create(libinput_event *event, void *storage);
+    static constexpr size_t maximumSize();
 
 protected:
     Event(libinput_event *event, libinput_event_type type);
@@ -479,5 +488,23 @@ inline libinput_event_type Event::type() const
     return m_type;
 }
 
+constexpr size_t Event::maximumSize()
+{
+    return std::max({sizeof(Event),
+                     sizeof(KeyEvent),
+                     sizeof(PointerEvent),
+                     sizeof(TouchEvent),
+                     sizeof(PinchGestureEvent),
+                     sizeof(SwipeGestureEvent),
+                     sizeof(HoldGestureEvent),
+                     sizeof(SwitchEvent),
+                     sizeof(TabletToolEvent),
+                     sizeof(TabletToolButtonEvent),
+                     sizeof(TabletPadRingEvent),
+                     sizeof(TabletPadDialEvent),
+                     sizeof(TabletPadStripEvent),
+                     sizeof(TabletPadButtonEvent)});
+}
+
 }
 }
@@ -18,6 +18,7 @@
 #include "core/outputlayer.h"
 #include "core/renderbackend.h"
 #include "core/renderloop.h"
+#include "core/renderloopscheduler.h"
 #include "cursor.h"
 #include "cursorsource.h"
 #include "dbusinterface.h"
@@ -65,9 +66,15 @@ Compositor *Compositor::self()
     return s_compositor;
 }
 
+// composite the outputs whose frames are due sooner first
+static const bool s_deadlineDispatch = environmentVariableBoolValue("KWIN_RENDERLOOP_DEADLINE_DISPATCH").value_or(false);
+
 Compositor::Compositor(QObject *workspace)
     : QObject(workspace)
 {
+    if (s_deadlineDispatch) {
+        m_renderLoopScheduler = std::make_unique<RenderLoopScheduler>();
+    }
     // register DBus
     new CompositorDBusInterface(this);
     FTraceLogger::create();
@@ -100,7 +107,11 @@ void Compositor::reinitialize()
 
 void Compositor::handleFrameRequested(RenderLoop *renderLoop)
 {
+    Q_EMIT frameRequestStarted(renderLoop);
+    waylandServer()->applyQueuedTransactions();
+    Q_EMIT aboutToComposite(renderLoop);
     composite(renderLoop);
+    Q_EMIT frameRequestFinished(renderLoop);
 }
 
 bool Compositor::isActive()
@@ -468,6 +479,35 @@ static OutputLayer *findLayer(std::span<OutputLayer *const> layers, OutputLayerT
 }
 
 static const bool s_forceSoftwareCursor = environmentVariableBoolValue("KWIN_FORCE_SW_CURSOR").value_or(false);
+
+/**
+ * KWIN_RENDER_TIME_PREDICTOR is either a predictor name that applies to all outputs, or a comma
+ * separated list of output=predictor pairs, e.g. "DP-1=percentile,HDMI-A-1=average".
+ */
+static std::optional<RenderJournal::Predictor> renderTimePredictorForOutput(const Output *output)
+{
+    const auto parse = [](QStringView name) -> std::optional<RenderJournal::Predictor> {
+        if (name == QLatin1String("percentile")) {
+            return RenderJournal::Predictor::Percentile;
+        } else if (name == QLatin1String("average")) {
+            return RenderJournal::Predictor::Average;
+        }
+        return std::nullopt;
+    };
+
+    const QString value = qEnvironmentVariable("KWIN_RENDER_TIME_PREDICTOR");
+    if (!value.contains(QLatin1Char('='))) {
+        return parse(value);
+    }
+    const auto entries = QStringView(value).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (QStringView entry : entries) {
+        const qsizetype separator = entry.indexOf(QLatin1Char('='));
+        if (separator != -1 && entry.left(separator) == output->name()) {
+            return parse(entry.mid(separator + 1));
+        }
+    }
+    return std::nullopt;
+}
 static const auto s_enableOverlays = environmentVariableBoolValue("KWIN_USE_OVERLAYS");
 
 /**
@@ -588,6 +628,19 @@ void Compositor::composite(RenderLoop *renderLoop)
 
     QList<OutputLayer *> toUpdate;
 
+    // classify the frame so that render times of e.g. the overview don't skew the
+    // predictions for the plain desktop, and vice versa
+    const bool overlaysInUse = std::ranges::any_of(m_overlayViews[renderLoop], [this](const auto &entry) {
+        return entry.second->item() != m_scene->cursorItem();
+    });
+    if (effects && effects->hasActiveFullScreenEffect()) {
+        renderLoop->setRenderWorkload(RenderJournal::Workload::Effects);
+    } else if (overlaysInUse) {
+        renderLoop->setRenderWorkload(RenderJournal::Workload::Overlays);
+    } else {
+        renderLoop->setRenderWorkload(RenderJournal::Workload::Plain);
+    }
+
     renderLoop->prepareNewFrame();
     auto totalTimeQuery = std::make_unique<CpuRenderTimeQuery>();
     auto frame = std::make_shared<OutputFrame>(renderLoop, std::chrono::nanoseconds(1'000'000'000'000 / output->refreshRate()));
@@ -949,7 +1002,13 @@ void Compositor::addOutput(Output *output)
         return;
     }
     assignOutputLayers(output);
+    if (const auto predictor = renderTimePredictorForOutput(output)) {
+        output->renderLoop()->setRenderTimePredictor(*predictor);
+    }
     connect(output->renderLoop(), &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    if (m_renderLoopScheduler) {
+        m_renderLoopScheduler->addRenderLoop(output->renderLoop());
+    }
     connect(output, &Output::outputLayersChanged, this, [this, output]() {
         assignOutputLayers(output);
     });
@@ -961,6 +1020,9 @@ void Compositor::removeOutput(Output *output)
         return;
     }
     disconnect(output->renderLoop(), &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    if (m_renderLoopScheduler) {
+        m_renderLoopScheduler->removeRenderLoop(output->renderLoop());
+    }
     disconnect(output, &Output::outputLayersChanged, this, nullptr);
     m_overlayViews.erase(output->renderLoop());
     m_primaryViews.erase(output->renderLoop());
@@ -27,6 +27,7 @@ class Output;
 class RenderBackend;
 class OutputLayer;
 class RenderLoop;
+class RenderLoopScheduler;
 class RenderTarget;
 class WorkspaceScene;
 class Window;
@@ -81,6 +82,16 @@ Q_SIGNALS:
     void aboutToDestroy();
     void aboutToToggleCompositing();
     void sceneCreated();
+    void aboutToComposite(RenderLoop *renderLoop);
+    /**
+     * Emitted when the compositor starts handling a frame request from the @a renderLoop,
+     * before deferred surface commits are applied.
+     */
+    void frameRequestStarted(RenderLoop *renderLoop);
+    /**
+     * Emitted when the compositor is done handling a frame request from the @a renderLoop.
+     */
+    void frameRequestFinished(RenderLoop *renderLoop);
 
 protected:
     explicit Compositor(QObject *parent = nullptr);
@@ -108,6 +119,7 @@ protected:
     State m_state = State::Off;
     std::unique_ptr<WorkspaceScene> m_scene;
     std::unique_ptr<RenderBackend> m_backend;
+    std::unique_ptr<RenderLoopScheduler> m_renderLoopScheduler;
     std::unordered_map<RenderLoop *, std::unique_ptr<SceneView>> m_primaryViews;
     std::unordered_map<RenderLoop *, std::unordered_map<OutputLayer *, std::unique_ptr<ItemView>>> m_overlayViews;
     std::unordered_set<RenderLoop *> m_brokenCursors;
@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "core/latencyhistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace KWin
+{
+
+void LatencyHistogram::add(std::chrono::nanoseconds latency)
+{
+    m_last = latency;
+    const size_t bin = std::min<size_t>(std::max<int64_t>(latency / s_binWidth, 0), s_binCount - 1);
+    m_bins[bin]++;
+    m_count++;
+
+    if (++m_samplesSinceDecay == s_decayInterval) {
+        m_samplesSinceDecay = 0;
+        m_count = 0;
+        for (uint32_t &value : m_bins) {
+            value /= 2;
+            m_count += value;
+        }
+    }
+}
+
+uint32_t LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::last() const
+{
+    return m_last;
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double percentile) const
+{
+    if (m_count == 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+    const uint32_t rank = std::max<uint32_t>(1, std::ceil(std::clamp(percentile, 0.0, 1.0) * m_count));
+    uint32_t accumulated = 0;
+    for (size_t i = 0; i < s_binCount; ++i) {
+        accumulated += m_bins[i];
+        if (accumulated >= rank) {
+            return s_binWidth * (i + 1);
+        }
+    }
+    return s_binWidth * s_binCount;
+}
+
+std::span<const uint32_t> LatencyHistogram::bins() const
+{
+    return m_bins;
+}
+
+} // namespace KWin
@@ -0,0 +1,59 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+#include "kwin_export.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+namespace KWin
+{
+
+/**
+ * The LatencyHistogram class collects latencies in fixed-width bins, so that high
+ * percentiles can be looked up cheaply. Old samples decay: every s_decayInterval samples
+ * all bins are halved, which lets the histogram follow changes in the latency over time.
+ *
+ * The histogram is small enough to be copied around by value.
+ */
+class KWIN_EXPORT LatencyHistogram
+{
+public:
+    static constexpr std::chrono::nanoseconds s_binWidth = std::chrono::microseconds(50);
+    /**
+     * The last bin also holds all latencies that are too big for the other bins.
+     */
+    static constexpr size_t s_binCount = 80;
+    static constexpr uint32_t s_decayInterval = 256;
+
+    void add(std::chrono::nanoseconds latency);
+
+    /**
+     * Returns the (decayed) number of samples in the histogram.
+     */
+    uint32_t count() const;
+    /**
+     * Returns the most recently added latency.
+     */
+    std::chrono::nanoseconds last() const;
+    /**
+     * Returns the upper edge of the bin that contains the @a percentile (in the range [0, 1])
+     * of the samples, or zero if the histogram is empty.
+     */
+    std::chrono::nanoseconds percentile(double percentile) const;
+    std::span<const uint32_t> bins() const;
+
+private:
+    std::array<uint32_t, s_binCount> m_bins{};
+    uint32_t m_count = 0;
+    uint32_t m_samplesSinceDecay = 0;
+    std::chrono::nanoseconds m_last{0};
+};
+
+} // namespace KWin
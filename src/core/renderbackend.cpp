@@ -48,6 +48,7 @@ OutputFrame::OutputFrame(RenderLoop *loop, std::chrono::nanoseconds refreshDurat
     , m_refreshDuration(refreshDuration)
     , m_targetPageflipTime(loop->nextPresentationTimestamp())
     , m_predictedRenderTime(loop->predictedRenderTime())
+    , m_renderWorkload(loop->renderWorkload())
 {
 }
 
@@ -138,6 +139,11 @@ std::chrono::nanoseconds OutputFrame::predictedRenderTime() const
     return m_predictedRenderTime;
 }
 
+RenderJournal::Workload OutputFrame::renderWorkload() const
+{
+    return m_renderWorkload;
+}
+
 std::optional<double> OutputFrame::brightness() const
 {
     return m_brightness;
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "core/renderjournal.h"
 #include "core/rendertarget.h"
 #include "effect/globals.h"
 #include "utils/filedescriptor.h"
@@ -89,6 +90,7 @@ public:
     std::chrono::steady_clock::time_point targetPageflipTime() const;
     std::chrono::nanoseconds refreshDuration() const;
     std::chrono::nanoseconds predictedRenderTime() const;
+    RenderJournal::Workload renderWorkload() const;
 
     std::optional<double> brightness() const;
     void setBrightness(double brightness);
@@ -103,6 +105,7 @@ private:
     const std::chrono::nanoseconds m_refreshDuration;
     const std::chrono::steady_clock::time_point m_targetPageflipTime;
     const std::chrono::nanoseconds m_predictedRenderTime;
+    const RenderJournal::Workload m_renderWorkload;
     std::vector<std::shared_ptr<PresentationFeedback>> m_feedbacks;
     std::optional<ContentType> m_contentType;
     PresentationMode m_presentationMode = PresentationMode::VSync;
@@ -24,6 +24,11 @@ static std::chrono::nanoseconds mix(std::chrono::nanoseconds duration1, std::chr
 }
 
 void RenderJournal::add(std::chrono::nanoseconds renderTime, std::chrono::nanoseconds presentationTimestamp)
+{
+    add(renderTime, presentationTimestamp, m_workload);
+}
+
+void RenderJournal::add(std::chrono::nanoseconds renderTime, std::chrono::nanoseconds presentationTimestamp, Workload workload)
 {
     const auto timeDifference = m_lastAdd ? presentationTimestamp - *m_lastAdd : 10s;
     m_lastAdd = presentationTimestamp;
@@ -36,11 +41,73 @@ void RenderJournal::add(std::chrono::nanoseconds renderTime, std::chrono::nanose
     static constexpr std::chrono::nanoseconds timeConstant = 500ms;
     const double ratio = std::clamp(timeDifference.count() / double(timeConstant.count()), 0.01, 1.0);
     m_result = mix(renderTime, m_result, ratio);
+
+    Window &window = m_windows[size_t(workload)];
+    window.samples[window.next] = renderTime;
+    window.next = (window.next + 1) % s_windowSize;
+    window.count = std::min(window.count + 1, s_windowSize);
 }
 
-std::chrono::nanoseconds RenderJournal::result() const
+std::chrono::nanoseconds RenderJournal::Window::percentile() const
+{
+    std::array<std::chrono::nanoseconds, s_windowSize> sorted;
+    std::copy_n(samples.begin(), count, sorted.begin());
+    const size_t index = std::min<size_t>(std::ceil(count * s_percentile), count) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + count);
+    return sorted[index];
+}
+
+std::chrono::nanoseconds RenderJournal::averageResult() const
 {
     return m_result + m_variance * 2;
 }
 
+std::chrono::nanoseconds RenderJournal::percentileResult() const
+{
+    // with too few samples the percentile is mostly noise, fall back to the average
+    // until the window for the current workload has been populated a bit
+    static constexpr size_t minimumSampleCount = 10;
+    const Window &window = m_windows[size_t(m_workload)];
+    if (window.count < minimumSampleCount) {
+        return averageResult();
+    }
+    return window.percentile();
+}
+
+std::chrono::nanoseconds RenderJournal::result() const
+{
+    return result(m_predictor);
+}
+
+std::chrono::nanoseconds RenderJournal::result(Predictor predictor) const
+{
+    switch (predictor) {
+    case Predictor::Average:
+        return averageResult();
+    case Predictor::Percentile:
+        return percentileResult();
+    }
+    return averageResult();
+}
+
+RenderJournal::Predictor RenderJournal::predictor() const
+{
+    return m_predictor;
+}
+
+void RenderJournal::setPredictor(Predictor predictor)
+{
+    m_predictor = predictor;
+}
+
+RenderJournal::Workload RenderJournal::workload() const
+{
+    return m_workload;
+}
+
+void RenderJournal::setWorkload(Workload workload)
+{
+    m_workload = workload;
+}
+
 } // namespace KWin
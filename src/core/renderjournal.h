@@ -7,6 +7,7 @@
 #pragma once
 #include "kwin_export.h"
 
+#include <array>
 #include <chrono>
 #include <optional>
 
@@ -16,20 +17,67 @@ namespace KWin
 /**
  * The RenderJournal class measures how long it takes to render frames and estimates how
  * long it will take to render the next frame.
+ *
+ * Two predictors are available. The average predictor tracks an exponentially smoothed mean
+ * and variance of all render times. The percentile predictor keeps a window of the most recent
+ * render times per workload and predicts a high percentile of it, which reacts to bursty
+ * workloads (e.g. a blurred window appearing) within a couple of frames.
  */
 class KWIN_EXPORT RenderJournal
 {
 public:
+    enum class Predictor {
+        Average,
+        Percentile,
+    };
+
+    /**
+     * The kind of scene that is being rendered. Render times are classified by workload so
+     * that switching between e.g. a plain desktop and an active effect doesn't have to wait
+     * for the prediction to converge again.
+     */
+    enum class Workload {
+        Plain,
+        Overlays,
+        Effects,
+    };
+
     explicit RenderJournal();
 
     void add(std::chrono::nanoseconds renderTime, std::chrono::nanoseconds presentationTimestamp);
+    void add(std::chrono::nanoseconds renderTime, std::chrono::nanoseconds presentationTimestamp, Workload workload);
 
     std::chrono::nanoseconds result() const;
+    std::chrono::nanoseconds result(Predictor predictor) const;
+
+    Predictor predictor() const;
+    void setPredictor(Predictor predictor);
+
+    Workload workload() const;
+    void setWorkload(Workload workload);
+
+    static constexpr size_t s_windowSize = 120;
+    static constexpr double s_percentile = 0.95;
 
 private:
+    struct Window
+    {
+        std::chrono::nanoseconds percentile() const;
+
+        std::array<std::chrono::nanoseconds, s_windowSize> samples;
+        size_t count = 0;
+        size_t next = 0;
+    };
+
+    std::chrono::nanoseconds averageResult() const;
+    std::chrono::nanoseconds percentileResult() const;
+
     std::chrono::nanoseconds m_result{0};
     std::chrono::nanoseconds m_variance{0};
     std::optional<std::chrono::nanoseconds> m_lastAdd;
+    std::array<Window, 3> m_windows;
+    Predictor m_predictor = Predictor::Average;
+    Workload m_workload = Workload::Plain;
 };
 
 } // namespace KWin
@@ -7,6 +7,7 @@
 #include "renderloop.h"
 #include "options.h"
 #include "renderloop_p.h"
+#include "renderloopscheduler.h"
 #include "scene/surfaceitem.h"
 #include "utils/common.h"
 #include "window.h"
@@ -107,7 +108,7 @@ void RenderLoopPrivate::scheduleRepaint(std::chrono::nanoseconds lastTargetTimes
         }
     }
 
-    const std::chrono::nanoseconds nextRenderTimestamp = nextPresentationTimestamp - expectedCompositingTime;
+    nextRenderTimestamp = nextPresentationTimestamp - expectedCompositingTime;
     compositeTimer.start(std::max(0ms, std::chrono::duration_cast<std::chrono::milliseconds>(nextRenderTimestamp - currentTime)), Qt::PreciseTimer, q);
 }
 
@@ -130,14 +131,17 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp,
 {
     if (output && s_printDebugInfo && !m_debugOutput) {
         m_debugOutput = std::fstream(qPrintable("kwin perf statistics " + output->name() + ".csv"), std::ios::out);
-        *m_debugOutput << "target pageflip timestamp,pageflip timestamp,render start,render end,safety margin,refresh duration,vrr,tearing,predicted render time\n";
+        *m_debugOutput << "target pageflip timestamp,pageflip timestamp,render start,render end,safety margin,refresh duration,vrr,tearing,predicted render time,predictor,workload,average prediction,percentile prediction,commit latency,commit latency p99\n";
     }
     if (m_debugOutput) {
         auto times = renderTime.value_or(RenderTimeSpan{});
         const bool vrr = mode == PresentationMode::AdaptiveSync || mode == PresentationMode::AdaptiveAsync;
         const bool tearing = mode == PresentationMode::Async || mode == PresentationMode::AdaptiveAsync;
         *m_debugOutput << frame->targetPageflipTime().time_since_epoch().count() << "," << timestamp.count() << "," << times.start.time_since_epoch().count() << "," << times.end.time_since_epoch().count()
-                       << "," << safetyMargin.count() << "," << frame->refreshDuration().count() << "," << (vrr ? 1 : 0) << "," << (tearing ? 1 : 0) << "," << frame->predictedRenderTime().count() << "\n";
+                       << "," << safetyMargin.count() << "," << frame->refreshDuration().count() << "," << (vrr ? 1 : 0) << "," << (tearing ? 1 : 0) << "," << frame->predictedRenderTime().count()
+                       << "," << int(renderJournal.predictor()) << "," << int(frame->renderWorkload()) << "," << renderJournal.result(RenderJournal::Predictor::Average).count()
+                       << "," << renderJournal.result(RenderJournal::Predictor::Percentile).count() << "," << commitLatency.last().count()
+                       << "," << commitLatency.percentile(0.99).count() << "\n";
     }
 
     Q_ASSERT(pendingFrameCount > 0);
@@ -146,7 +150,7 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp,
     notifyVblank(timestamp);
 
     if (renderTime) {
-        renderJournal.add(renderTime->end - renderTime->start, timestamp);
+        renderJournal.add(renderTime->end - renderTime->start, timestamp, frame->renderWorkload());
     }
     if (compositeTimer.isActive()) {
         // reschedule to match the new timestamp and render time
@@ -176,6 +180,9 @@ void RenderLoop::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == d->compositeTimer.timerId()) {
         d->compositeTimer.stop();
+        if (d->scheduler) {
+            d->scheduler->dispatchEarlierDeadlines(this);
+        }
         d->dispatch();
     } else if (event->timerId() == d->delayedVrrTimer.timerId()) {
         d->delayedVrrTimer.stop();
@@ -197,6 +204,9 @@ RenderLoop::RenderLoop(Output *output)
 
 RenderLoop::~RenderLoop()
 {
+    if (d->scheduler) {
+        d->scheduler->removeRenderLoop(this);
+    }
 }
 
 void RenderLoop::inhibit()
@@ -252,6 +262,16 @@ void RenderLoop::setPresentationSafetyMargin(std::chrono::nanoseconds safetyMarg
     d->safetyMargin = safetyMargin;
 }
 
+LatencyHistogram RenderLoop::commitLatency() const
+{
+    return d->commitLatency;
+}
+
+void RenderLoop::setCommitLatency(const LatencyHistogram &latency)
+{
+    d->commitLatency = latency;
+}
+
 void RenderLoop::scheduleRepaint(Item *item, OutputLayer *outputLayer)
 {
     const bool vrr = d->presentationMode == PresentationMode::AdaptiveSync || d->presentationMode == PresentationMode::AdaptiveAsync;
@@ -312,6 +332,26 @@ std::chrono::nanoseconds RenderLoop::predictedRenderTime() const
     return d->renderJournal.result();
 }
 
+RenderJournal::Predictor RenderLoop::renderTimePredictor() const
+{
+    return d->renderJournal.predictor();
+}
+
+void RenderLoop::setRenderTimePredictor(RenderJournal::Predictor predictor)
+{
+    d->renderJournal.setPredictor(predictor);
+}
+
+RenderJournal::Workload RenderLoop::renderWorkload() const
+{
+    return d->renderJournal.workload();
+}
+
+void RenderLoop::setRenderWorkload(RenderJournal::Workload workload)
+{
+    d->renderJournal.setWorkload(workload);
+}
+
 } // namespace KWin
 
 #include "moc_renderloop.cpp"
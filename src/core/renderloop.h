@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "core/latencyhistogram.h"
+#include "core/renderjournal.h"
 #include "effect/globals.h"
 
 #include <QObject>
@@ -73,6 +75,13 @@ public:
 
     void setPresentationSafetyMargin(std::chrono::nanoseconds safetyMargin);
 
+    /**
+     * Returns how long it took the output backend to submit recent frames to the display
+     * hardware, if the backend measures that.
+     */
+    LatencyHistogram commitLatency() const;
+    void setCommitLatency(const LatencyHistogram &latency);
+
     /**
      * Schedules a compositing cycle at the next available moment.
      */
@@ -100,6 +109,19 @@ public:
      */
     std::chrono::nanoseconds predictedRenderTime() const;
 
+    /**
+     * Returns the predictor that is used to estimate render times on this output.
+     */
+    RenderJournal::Predictor renderTimePredictor() const;
+    void setRenderTimePredictor(RenderJournal::Predictor predictor);
+
+    /**
+     * The kind of scene the next frame is expected to render. Render times are tracked
+     * separately per workload if the percentile predictor is used.
+     */
+    RenderJournal::Workload renderWorkload() const;
+    void setRenderWorkload(RenderJournal::Workload workload);
+
     // TODO integrate cursor updates into the render loop / frame scheduling somehow?
     // and then remove this again
     bool activeWindowControlsVrrRefreshRate() const;
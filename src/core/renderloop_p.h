@@ -20,6 +20,7 @@ namespace KWin
 
 class SurfaceItem;
 class OutputFrame;
+class RenderLoopScheduler;
 
 class KWIN_EXPORT RenderLoopPrivate
 {
@@ -39,9 +40,11 @@ public:
 
     RenderLoop *const q;
     Output *const output;
+    RenderLoopScheduler *scheduler = nullptr;
     std::optional<std::fstream> m_debugOutput;
     std::chrono::nanoseconds lastPresentationTimestamp = std::chrono::nanoseconds::zero();
     std::chrono::nanoseconds nextPresentationTimestamp = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds nextRenderTimestamp = std::chrono::nanoseconds::zero();
     bool wasTripleBuffering = false;
     int doubleBufferingCounter = 0;
     QBasicTimer compositeTimer;
@@ -52,6 +55,7 @@ public:
     int inhibitCount = 0;
     bool pendingReschedule = false;
     std::chrono::nanoseconds safetyMargin{0};
+    LatencyHistogram commitLatency;
 
     PresentationMode presentationMode = PresentationMode::VSync;
     int maxPendingFrameCount = 1;
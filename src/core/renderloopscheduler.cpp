@@ -0,0 +1,93 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "core/renderloopscheduler.h"
+#include "core/renderloop_p.h"
+
+#include <QPointer>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+RenderLoopScheduler::RenderLoopScheduler()
+{
+}
+
+RenderLoopScheduler::~RenderLoopScheduler()
+{
+    for (RenderLoop *loop : std::as_const(m_renderLoops)) {
+        RenderLoopPrivate::get(loop)->scheduler = nullptr;
+    }
+}
+
+QList<RenderLoop *> RenderLoopScheduler::renderLoops() const
+{
+    return m_renderLoops;
+}
+
+void RenderLoopScheduler::addRenderLoop(RenderLoop *loop)
+{
+    RenderLoopPrivate *d = RenderLoopPrivate::get(loop);
+    if (d->scheduler == this) {
+        return;
+    }
+    if (d->scheduler) {
+        d->scheduler->removeRenderLoop(loop);
+    }
+    d->scheduler = this;
+    m_renderLoops.append(loop);
+}
+
+void RenderLoopScheduler::removeRenderLoop(RenderLoop *loop)
+{
+    RenderLoopPrivate *d = RenderLoopPrivate::get(loop);
+    if (d->scheduler != this) {
+        return;
+    }
+    d->scheduler = nullptr;
+    m_renderLoops.removeOne(loop);
+}
+
+void RenderLoopScheduler::dispatchEarlierDeadlines(RenderLoop *loop)
+{
+    const RenderLoopPrivate *d = RenderLoopPrivate::get(loop);
+    const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
+    const std::chrono::nanoseconds horizon = currentTime + d->renderJournal.result();
+
+    QList<QPointer<RenderLoop>> candidates;
+    for (RenderLoop *other : std::as_const(m_renderLoops)) {
+        const RenderLoopPrivate *otherPrivate = RenderLoopPrivate::get(other);
+        if (other == loop || !otherPrivate->compositeTimer.isActive()) {
+            continue;
+        }
+        if (otherPrivate->nextRenderTimestamp <= horizon && otherPrivate->nextPresentationTimestamp < d->nextPresentationTimestamp) {
+            candidates.append(other);
+        }
+    }
+    if (candidates.isEmpty()) {
+        return;
+    }
+
+    std::ranges::sort(candidates, [](const QPointer<RenderLoop> &a, const QPointer<RenderLoop> &b) {
+        return RenderLoopPrivate::get(a)->nextPresentationTimestamp < RenderLoopPrivate::get(b)->nextPresentationTimestamp;
+    });
+    // compositing a frame can add or remove outputs, hence the guarded pointers
+    for (const QPointer<RenderLoop> &candidate : std::as_const(candidates)) {
+        if (!candidate) {
+            continue;
+        }
+        RenderLoopPrivate *candidatePrivate = RenderLoopPrivate::get(candidate);
+        if (candidatePrivate->scheduler != this || !candidatePrivate->compositeTimer.isActive()) {
+            continue;
+        }
+        candidatePrivate->compositeTimer.stop();
+        candidatePrivate->dispatch();
+    }
+}
+
+} // namespace KWin
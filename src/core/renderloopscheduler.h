@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QList>
+
+namespace KWin
+{
+
+class RenderLoop;
+
+/**
+ * The RenderLoopScheduler class coordinates render loops that are composited on the same thread.
+ *
+ * When the composite timer of one render loop fires, the render loops whose frames have to be
+ * presented sooner and that are due to start compositing before this frame is done are
+ * dispatched first, ordered by their target presentation time. A slow frame on a low refresh
+ * rate output then no longer makes a high refresh rate output miss its vblank.
+ */
+class KWIN_EXPORT RenderLoopScheduler
+{
+public:
+    RenderLoopScheduler();
+    ~RenderLoopScheduler();
+
+    QList<RenderLoop *> renderLoops() const;
+    void addRenderLoop(RenderLoop *loop);
+    void removeRenderLoop(RenderLoop *loop);
+
+    /**
+     * Dispatches the render loops whose deadlines come before the deadline of the @a loop.
+     * This is called right before the @a loop itself is dispatched.
+     */
+    void dispatchEarlierDeadlines(RenderLoop *loop);
+
+private:
+    QList<RenderLoop *> m_renderLoops;
+};
+
+} // namespace KWin
@@ -86,17 +86,24 @@ GraphicsBuffer *ShmGraphicsBufferAllocator::allocate(const GraphicsBufferOptions
         return nullptr;
     }
 
+    int stride;
+    int bufferSize;
     switch (options.format) {
     case DRM_FORMAT_ARGB8888:
     case DRM_FORMAT_XRGB8888:
+        stride = options.size.width() * 4;
+        bufferSize = options.size.height() * stride;
+        break;
+    case DRM_FORMAT_NV12:
+        // the interleaved chroma plane follows the luma plane, both with 32-bit aligned rows,
+        // the luma plane is padded to an even number of rows
+        stride = (options.size.width() + 3) & ~3;
+        bufferSize = ((options.size.height() + 1) & ~1) * 3 / 2 * stride;
         break;
     default:
         return nullptr;
     }
 
-    const int stride = options.size.width() * 4;
-    const int bufferSize = options.size.height() * stride;
-
 #if HAVE_MEMFD
     FileDescriptor fd = FileDescriptor(memfd_create("shm", MFD_CLOEXEC | MFD_ALLOW_SEALING));
     if (!fd.isValid()) {
@@ -134,7 +141,7 @@ GraphicsBuffer *ShmGraphicsBufferAllocator::allocate(const GraphicsBufferOptions
         .format = options.format,
     };
 
-    MemoryMap memoryMap(attributes.stride * attributes.size.height(), PROT_READ | PROT_WRITE, MAP_SHARED, attributes.fd.get(), attributes.offset);
+    MemoryMap memoryMap(bufferSize, PROT_READ | PROT_WRITE, MAP_SHARED, attributes.fd.get(), attributes.offset);
     if (!memoryMap.isValid()) {
         return nullptr;
     }
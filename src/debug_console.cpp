@@ -9,14 +9,18 @@
 #include "debug_console.h"
 #include "compositor.h"
 #include "core/inputdevice.h"
+#include "core/output.h"
+#include "core/renderloop.h"
 #include "effect/effecthandler.h"
 #include "input_event.h"
 #include "internalwindow.h"
 #include "keyboard_input.h"
 #include "main.h"
+#include "opengl/colorpipelinecache.h"
 #include "opengl/eglbackend.h"
 #include "opengl/glplatform.h"
 #include "opengl/glutils.h"
+#include "scene/surfaceitem.h"
 #include "scene/workspacescene.h"
 #include "tiles/customtile.h"
 #include "tiles/tile.h"
@@ -44,6 +48,7 @@
 // frameworks
 #include <KLocalizedString>
 // Qt
+#include <QFormLayout>
 #include <QFutureWatcher>
 #include <QMetaProperty>
 #include <QMetaType>
@@ -53,6 +58,7 @@
 #include <QPushButton>
 #include <QScopeGuard>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 #include <QWindow>
 #include <QtConcurrentRun>
 
@@ -703,6 +709,7 @@ DebugConsole::DebugConsole()
     m_ui->tabWidget->setTabIcon(0, QIcon::fromTheme(QStringLiteral("view-list-tree")));
 
     m_ui->tabWidget->addTab(new DebugConsoleEffectsTab(), i18nc("@label", "Effects"));
+    m_ui->tabWidget->addTab(new DebugConsolePerformanceTab(), i18nc("@label", "Performance"));
 
     connect(m_ui->tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
         // delay creation of input event filter until the tab is selected
@@ -1832,6 +1839,104 @@ DebugConsoleEffectsTab::DebugConsoleEffectsTab(QWidget *parent)
     }
 }
 
+DebugConsolePerformanceTab::DebugConsolePerformanceTab(QWidget *parent)
+    : QWidget(parent)
+    , m_layout(new QFormLayout(this))
+    , m_timer(new QTimer(this))
+{
+    m_timer->setInterval(1000);
+    connect(m_timer, &QTimer::timeout, this, &DebugConsolePerformanceTab::updateValues);
+
+    addRow(i18nc("@label", "Color pipeline cache entries:"), []() {
+        return QString::number(ColorPipelineCache::self()->size());
+    });
+    addRow(i18nc("@label", "Color pipeline cache hits:"), []() {
+        return QString::number(ColorPipelineCache::self()->hits());
+    });
+    addRow(i18nc("@label", "Color pipeline cache misses:"), []() {
+        return QString::number(ColorPipelineCache::self()->misses());
+    });
+    addRow(i18nc("@label", "Shm texture uploads:"), []() {
+        QList<std::pair<qint64, QString>> uploads;
+        for (Window *window : workspace()->windows()) {
+            SurfaceItem *surfaceItem = window->surfaceItem();
+            if (!surfaceItem) {
+                continue;
+            }
+            if (auto texture = dynamic_cast<OpenGLSurfaceTexture *>(surfaceItem->texture())) {
+                if (const qint64 rate = texture->uploadedBytesPerSecond()) {
+                    uploads.append(std::make_pair(rate, window->caption()));
+                }
+            }
+        }
+        std::sort(uploads.begin(), uploads.end(), std::greater());
+
+        QStringList lines;
+        for (const auto &[rate, caption] : std::as_const(uploads).first(std::min<qsizetype>(uploads.size(), 5))) {
+            lines.append(i18nc("@label upload rate of a window", "%1: %2/s", caption, QLocale().formattedDataSize(rate)));
+        }
+        return lines.join(QLatin1Char('\n'));
+    });
+    addRow(i18nc("@label", "Commit latency:"), []() {
+        QStringList lines;
+        for (Output *output : workspace()->outputs()) {
+            const LatencyHistogram latency = output->renderLoop()->commitLatency();
+            if (!latency.count()) {
+                continue;
+            }
+            // draw the histogram up to the last non-empty bin, with one block character per bin
+            const auto bins = latency.bins();
+            const auto last = std::find_if(bins.rbegin(), bins.rend(), [](uint32_t value) {
+                return value != 0;
+            });
+            const auto used = bins.first(std::distance(last, bins.rend()));
+            const uint32_t highest = *std::max_element(used.begin(), used.end());
+            QString histogram;
+            for (const uint32_t value : used) {
+                histogram.append(value ? QChar(0x2581 + (value * 7) / highest) : QLatin1Char(' '));
+            }
+            const auto toMicroseconds = [](std::chrono::nanoseconds duration) {
+                return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            };
+            lines.append(i18nc("@label commit latency of an output, in microseconds", "%1: median %2 µs, 99th percentile %3 µs, %4 µs per bin\n%5",
+                               output->name(), toMicroseconds(latency.percentile(0.5)), toMicroseconds(latency.percentile(0.99)),
+                               toMicroseconds(LatencyHistogram::s_binWidth), histogram));
+        }
+        return lines.join(QLatin1Char('\n'));
+    });
+}
+
+void DebugConsolePerformanceTab::addRow(const QString &title, std::function<QString()> value)
+{
+    QLabel *label = new QLabel(this);
+    label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_layout->addRow(title, label);
+    m_rows.append(Row{
+        .label = label,
+        .value = std::move(value),
+    });
+}
+
+void DebugConsolePerformanceTab::updateValues()
+{
+    for (const Row &row : std::as_const(m_rows)) {
+        row.label->setText(row.value());
+    }
+}
+
+void DebugConsolePerformanceTab::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateValues();
+    m_timer->start();
+}
+
+void DebugConsolePerformanceTab::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_timer->stop();
+}
+
 } // namespace KWin
 
 #include "moc_debug_console.cpp"
@@ -22,9 +22,11 @@
 #include <functional>
 #include <memory>
 
+class QFormLayout;
 class QLabel;
 class QPushButton;
 class QTextEdit;
+class QTimer;
 
 namespace Ui
 {
@@ -218,4 +220,34 @@ public:
     explicit DebugConsoleEffectsTab(QWidget *parent = nullptr);
 };
 
+/**
+ * Shows various compositor performance counters. The values are polled periodically while
+ * the tab is visible.
+ */
+class DebugConsolePerformanceTab : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DebugConsolePerformanceTab(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void addRow(const QString &title, std::function<QString()> value);
+    void updateValues();
+
+    struct Row
+    {
+        QLabel *label;
+        std::function<QString()> value;
+    };
+
+    QFormLayout *m_layout;
+    QTimer *m_timer;
+    QList<Row> m_rows;
+};
+
 } // namespace KWin
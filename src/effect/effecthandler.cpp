@@ -70,6 +70,8 @@
 #include <QWindow>
 #include <QtMath>
 
+#include <bit>
+
 namespace KWin
 {
 #if KWIN_BUILD_X11
@@ -183,7 +185,12 @@ EffectsHandler::EffectsHandler(Compositor *compositor, WorkspaceScene *scene)
         Q_EMIT windowActivated(window ? window->effectWindow() : nullptr);
     });
     connect(ws, &Workspace::deletedRemoved, this, [this](KWin::Window *d) {
-        Q_EMIT windowDeleted(d->effectWindow());
+        EffectWindow *w = d->effectWindow();
+        Q_EMIT windowDeleted(w);
+        for (QSet<EffectWindow *> &windows : m_affectedWindows) {
+            windows.remove(w);
+        }
+        m_windowEffectMasks.remove(w);
     });
     connect(ws->sessionManager(), &SessionManager::stateChanged, this, &KWin::EffectsHandler::sessionStateChanged);
     connect(vds, &VirtualDesktopManager::layoutChanged, this, [this](int width, int height) {
@@ -332,6 +339,7 @@ EglContext *EffectsHandler::openglContext() const
 void EffectsHandler::unloadAllEffects()
 {
     m_activeEffects.clear();
+    m_windowEffectMasks.clear();
     effect_order.clear();
     m_effectLoader->clear();
 
@@ -388,32 +396,110 @@ void EffectsHandler::postPaintScreen()
 
 void EffectsHandler::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
 {
+    const EffectsIterator current = m_currentPaintWindowIterator;
+    m_currentPaintWindowIterator = nextWindowEffect(current, w);
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
         (*m_currentPaintWindowIterator++)->prePaintWindow(view, w, data, presentTime);
-        --m_currentPaintWindowIterator;
     }
+    m_currentPaintWindowIterator = current;
     // no special final code
 }
 
 void EffectsHandler::paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
 {
+    const EffectsIterator current = m_currentPaintWindowIterator;
+    m_currentPaintWindowIterator = nextWindowEffect(current, w);
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
         (*m_currentPaintWindowIterator++)->paintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
-        --m_currentPaintWindowIterator;
     } else {
         m_scene->finalPaintWindow(renderTarget, viewport, w, mask, deviceRegion, data);
     }
+    m_currentPaintWindowIterator = current;
 }
 
 void EffectsHandler::postPaintWindow(EffectWindow *w)
 {
+    const EffectsIterator current = m_currentPaintWindowIterator;
+    m_currentPaintWindowIterator = nextWindowEffect(current, w);
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
         (*m_currentPaintWindowIterator++)->postPaintWindow(w);
-        --m_currentPaintWindowIterator;
     }
+    m_currentPaintWindowIterator = current;
     // no special final code
 }
 
+// Skips the effects that have window filtering enabled but haven't registered the window
+EffectsHandler::EffectsIterator EffectsHandler::nextWindowEffect(EffectsIterator it, EffectWindow *w)
+{
+    if (m_affectedWindows.isEmpty()) {
+        return it;
+    }
+
+    // only the first 64 effects fit in the mask, the rest is never skipped
+    const qsizetype index = it - m_activeEffects.constBegin();
+    const qsizetype maskedCount = std::min<qsizetype>(m_activeEffects.size(), 64);
+    if (index >= maskedCount) {
+        return it;
+    }
+    const quint64 remaining = windowEffectMask(w) >> index;
+    if (!remaining) {
+        return m_activeEffects.constBegin() + maskedCount;
+    }
+    return it + std::countr_zero(remaining);
+}
+
+quint64 EffectsHandler::windowEffectMask(EffectWindow *w)
+{
+    auto it = m_windowEffectMasks.constFind(w);
+    if (it != m_windowEffectMasks.constEnd()) {
+        return *it;
+    }
+
+    quint64 mask = 0;
+    const qsizetype count = std::min<qsizetype>(m_activeEffects.size(), 64);
+    for (qsizetype i = 0; i < count; ++i) {
+        const auto affected = m_affectedWindows.constFind(m_activeEffects[i]);
+        if (affected == m_affectedWindows.constEnd() || affected->contains(w)) {
+            mask |= quint64(1) << i;
+        }
+    }
+    m_windowEffectMasks.insert(w, mask);
+    return mask;
+}
+
+void EffectsHandler::setWindowFilteringEnabled(Effect *effect, bool enabled)
+{
+    if (enabled == m_affectedWindows.contains(effect)) {
+        return;
+    }
+    if (enabled) {
+        m_affectedWindows.insert(effect, QSet<EffectWindow *>());
+    } else {
+        m_affectedWindows.remove(effect);
+    }
+    m_windowEffectMasks.clear();
+}
+
+void EffectsHandler::addAffectedWindow(Effect *effect, EffectWindow *window)
+{
+    auto it = m_affectedWindows.find(effect);
+    if (it == m_affectedWindows.end()) {
+        return;
+    }
+    it->insert(window);
+    m_windowEffectMasks.remove(window);
+}
+
+void EffectsHandler::removeAffectedWindow(Effect *effect, EffectWindow *window)
+{
+    auto it = m_affectedWindows.find(effect);
+    if (it == m_affectedWindows.end()) {
+        return;
+    }
+    it->remove(window);
+    m_windowEffectMasks.remove(window);
+}
+
 Effect *EffectsHandler::provides(Effect::Feature ef)
 {
     for (int i = 0; i < loaded_effects.size(); ++i) {
@@ -426,12 +512,14 @@ Effect *EffectsHandler::provides(Effect::Feature ef)
 
 void EffectsHandler::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
 {
+    const EffectsIterator current = m_currentDrawWindowIterator;
+    m_currentDrawWindowIterator = nextWindowEffect(current, w);
     if (m_currentDrawWindowIterator != m_activeEffects.constEnd()) {
         (*m_currentDrawWindowIterator++)->drawWindow(renderTarget, viewport, w, mask, deviceRegion, data);
-        --m_currentDrawWindowIterator;
     } else {
         m_scene->finalDrawWindow(renderTarget, viewport, w, mask, deviceRegion, data);
     }
+    m_currentDrawWindowIterator = current;
 }
 
 void EffectsHandler::renderWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data)
@@ -452,13 +540,17 @@ bool EffectsHandler::decorationsHaveAlpha() const
 // start another painting pass
 void EffectsHandler::startPaint()
 {
-    m_activeEffects.clear();
-    m_activeEffects.reserve(loaded_effects.count());
+    EffectsList activeEffects;
+    activeEffects.reserve(loaded_effects.count());
     for (QList<KWin::EffectPair>::const_iterator it = loaded_effects.constBegin(); it != loaded_effects.constEnd(); ++it) {
         if (it->second->isActive()) {
-            m_activeEffects << it->second;
+            activeEffects << it->second;
         }
     }
+    if (activeEffects != m_activeEffects) {
+        m_activeEffects = std::move(activeEffects);
+        m_windowEffectMasks.clear();
+    }
     m_currentDrawWindowIterator = m_activeEffects.constBegin();
     m_currentPaintWindowIterator = m_activeEffects.constBegin();
     m_currentPaintScreenIterator = m_activeEffects.constBegin();
@@ -1242,6 +1334,7 @@ void EffectsHandler::destroyEffect(Effect *effect)
     }
 
     stopMouseInterception(effect);
+    setWindowFilteringEnabled(effect, false);
 
 #if KWIN_BUILD_X11
     const QList<QByteArray> properties = m_propertiesForEffects.keys();
@@ -1326,6 +1419,7 @@ void EffectsHandler::effectsChanged()
 {
     loaded_effects.clear();
     m_activeEffects.clear(); // it's possible to have a reconfigure and a quad rebuild between two paint cycles - bug #308201
+    m_windowEffectMasks.clear();
 
     loaded_effects.reserve(effect_order.count());
     std::copy(effect_order.constBegin(), effect_order.constEnd(),
@@ -179,6 +179,28 @@ public:
     void postPaintWindow(EffectWindow *w);
     void drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data);
     void renderWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data);
+    /**
+     * Restricts the window paint hooks of the @p effect, i.e. prePaintWindow(), paintWindow(),
+     * postPaintWindow() and drawWindow(), to the windows registered with addAffectedWindow().
+     * By default, the window paint hooks of an active effect are called for every window.
+     *
+     * Effects that only transform a few windows at a time should enable this, so the paint
+     * chains of all the other windows can skip them.
+     * @see addAffectedWindow
+     * @see removeAffectedWindow
+     */
+    void setWindowFilteringEnabled(Effect *effect, bool enabled);
+    /**
+     * Tells that the @p effect wants its window paint hooks to be called for @p window. Does
+     * nothing if window filtering is not enabled for the @p effect.
+     * @see setWindowFilteringEnabled
+     */
+    void addAffectedWindow(Effect *effect, EffectWindow *window);
+    /**
+     * Tells that the @p effect is no longer interested in painting @p window.
+     * @see setWindowFilteringEnabled
+     */
+    void removeAffectedWindow(Effect *effect, EffectWindow *window);
     QVariant kwinOption(KWinOption kwopt);
     /**
      * Sets the cursor while the mouse is intercepted.
@@ -1087,6 +1109,9 @@ protected:
     typedef QList<Effect *> EffectsList;
     typedef EffectsList::const_iterator EffectsIterator;
 
+    EffectsIterator nextWindowEffect(EffectsIterator it, EffectWindow *w);
+    quint64 windowEffectMask(EffectWindow *w);
+
     struct
     {
         QPointF position;
@@ -1106,6 +1131,8 @@ protected:
     EffectsIterator m_currentDrawWindowIterator;
     EffectsIterator m_currentPaintWindowIterator;
     EffectsIterator m_currentPaintScreenIterator;
+    QHash<Effect *, QSet<EffectWindow *>> m_affectedWindows;
+    QHash<EffectWindow *, quint64> m_windowEffectMasks; // bit i is set if m_activeEffects[i] paints the window
     typedef QHash<QByteArray, QList<Effect *>> PropertyEffectMap;
 #if KWIN_BUILD_X11
     PropertyEffectMap m_propertiesForEffects;
@@ -72,6 +72,7 @@ void OffscreenEffect::redirect(EffectWindow *window)
     offscreenData->m_windowEffect = ItemEffect(window->windowItem());
     offscreenData->m_windowDamagedConnection =
         connect(window, &EffectWindow::windowDamaged, this, &OffscreenEffect::handleWindowDamaged);
+    effects->addAffectedWindow(this, window);
 
     if (d->windows.size() == 1) {
         setupConnections();
@@ -90,6 +91,7 @@ void OffscreenEffect::unredirect(EffectWindow *window)
     }
 
     d->windows.erase(it);
+    effects->removeAffectedWindow(this, window);
     if (d->windows.empty()) {
         destroyConnections();
     }
@@ -382,6 +384,7 @@ void CrossFadeEffect::redirect(EffectWindow *window)
     }
     offscreenData = std::make_unique<CrossFadeWindowData>();
     offscreenData->m_windowEffect = ItemEffect(window->windowItem());
+    effects->addAffectedWindow(this, window);
 
     // Avoid including blur and contrast effects. During a normal painting cycle they
     // won't be included, but since we call effects->drawWindow() outside usual compositing
@@ -411,6 +414,7 @@ void CrossFadeEffect::unredirect(EffectWindow *window)
     }
 
     d->windows.erase(it);
+    effects->removeAffectedWindow(this, window);
     if (d->windows.empty()) {
         disconnect(effects, &EffectsHandler::windowDeleted, this, &CrossFadeEffect::handleWindowDeleted);
     }
@@ -29,6 +29,9 @@ class ShaderEffectPrivate;
  *
  * If a window is redirected into offscreen texture, the deform() function will be
  * called to transform the offscreen texture.
+ *
+ * Redirected windows are registered with EffectsHandler::addAffectedWindow(), so if
+ * the effect only paints redirected windows, it can enable window filtering.
  */
 class KWIN_EXPORT OffscreenEffect : public Effect
 {
@@ -27,6 +27,7 @@
 #include "mousebuttons.h"
 #include "pointer_input.h"
 #include "tablet_input.h"
+#include "toplevelindex.h"
 #include "touch_input.h"
 #include "wayland/abstract_data_source.h"
 #include "wayland/xdgtopleveldrag_v1.h"
@@ -2088,6 +2089,11 @@ public:
         // -> send a relative motion event with a zero delta to signal the warp instead
         if (event->warp) {
             seat->relativePointerMotion(QPointF(0, 0), QPointF(0, 0), event->timestamp);
+        } else if (!event->history.isEmpty()) {
+            // coalesced motion, relative pointer clients still get every sample
+            for (const PointerMotionSample &sample : std::as_const(event->history)) {
+                seat->relativePointerMotion(sample.delta, sample.deltaUnaccelerated, sample.timestamp);
+            }
         } else if (!event->delta.isNull()) {
             seat->relativePointerMotion(event->delta, event->deltaUnaccelerated, event->timestamp);
         }
@@ -2959,6 +2965,11 @@ void InputRedirection::setupWorkspace()
 {
     connect(workspace(), &Workspace::outputsChanged, this, &InputRedirection::updateScreens);
 
+    m_toplevelIndex = std::make_unique<ToplevelIndex>();
+    connect(workspace(), &QObject::destroyed, this, [this]() {
+        m_toplevelIndex.reset();
+    });
+
     m_keyboard->init();
     m_pointer->init();
     m_touch->init();
@@ -3424,34 +3435,10 @@ Window *InputRedirection::findToplevel(const QPointF &pos)
             return nullptr;
         }
     }
-    const QList<Window *> &stacking = Workspace::self()->stackingOrder();
-    if (stacking.isEmpty()) {
+    if (!m_toplevelIndex) {
         return nullptr;
     }
-    auto it = stacking.end();
-    do {
-        --it;
-        Window *window = (*it);
-        if (window->isDeleted()) {
-            // a deleted window doesn't get mouse events
-            continue;
-        }
-        if (!window->isOnCurrentActivity() || !window->isOnCurrentDesktop() || window->isMinimized() || window->isHidden() || window->isHiddenByShowDesktop()) {
-            continue;
-        }
-        if (!window->readyForPainting()) {
-            continue;
-        }
-        if (isScreenLocked) {
-            if (!window->isLockScreen() && !window->isInputMethod() && !window->isLockScreenOverlay()) {
-                continue;
-            }
-        }
-        if (window->hitTest(pos)) {
-            return window;
-        }
-    } while (it != stacking.begin());
-    return nullptr;
+    return m_toplevelIndex->windowAt(pos, isScreenLocked);
 }
 
 Qt::KeyboardModifiers InputRedirection::keyboardModifiers() const
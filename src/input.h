@@ -40,6 +40,7 @@ class KeyboardInputRedirection;
 class PointerInputRedirection;
 class SeatInterface;
 class TabletInputRedirection;
+class ToplevelIndex;
 class TouchInputRedirection;
 class WindowSelectorFilter;
 struct SwitchEvent;
@@ -280,6 +281,7 @@ private:
     QList<IdleDetector *> m_idleDetectors;
     QList<Window *> m_idleInhibitors;
     std::unique_ptr<WindowSelectorFilter> m_windowSelector;
+    std::unique_ptr<ToplevelIndex> m_toplevelIndex;
 
     QList<InputEventFilter *> m_filters;
     QList<InputEventSpy *> m_spies;
@@ -18,6 +18,13 @@ namespace KWin
 class InputDevice;
 class InputDeviceTabletTool;
 
+struct PointerMotionSample
+{
+    QPointF delta;
+    QPointF deltaUnaccelerated;
+    std::chrono::microseconds timestamp;
+};
+
 struct PointerMotionEvent
 {
     InputDevice *device;
@@ -29,6 +36,11 @@ struct PointerMotionEvent
     Qt::KeyboardModifiers modifiers;
     Qt::KeyboardModifiers modifiersRelevantForShortcuts;
     std::chrono::microseconds timestamp;
+    /**
+     * The relative motion samples that were coalesced into this event, oldest first. It's
+     * empty if the event corresponds to a single motion sample.
+     */
+    QList<PointerMotionSample> history = {};
 };
 
 struct PointerButtonEvent
@@ -15,6 +15,7 @@
 #include "inputmethod.h"
 #include "keyboard_layout.h"
 #include "keyboard_repeat.h"
+#include "pointer_input.h"
 #include "wayland/datadevice.h"
 #include "wayland/display.h"
 #include "wayland/keyboard.h"
@@ -282,6 +283,8 @@ void KeyboardInputRedirection::processKey(uint32_t key, KeyboardKeyState state,
     if (!m_inited) {
         return;
     }
+    // shortcuts and clients see the key after any pointer motion that preceded it
+    input()->pointer()->flushPendingMotion();
 
     const bool ret = m_a11yKeyboardMonitor.processKey(key, state, time);
     if (ret) {
@@ -0,0 +1,91 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "opengl/colorpipelinecache.h"
+
+#include <QHashFunctions>
+
+namespace KWin
+{
+
+ColorPipelineCache *ColorPipelineCache::self()
+{
+    static ColorPipelineCache cache;
+    return &cache;
+}
+
+size_t ColorPipelineCache::KeyHash::operator()(const Key &key) const
+{
+    return qHashMulti(0, quintptr(key.from), quintptr(key.to), int(key.intent));
+}
+
+std::shared_ptr<const ColorPipelineCache::Entry> ColorPipelineCache::lookup(const std::shared_ptr<ColorDescription> &from, const std::shared_ptr<ColorDescription> &to, RenderingIntent intent)
+{
+    const Key key{
+        .from = from.get(),
+        .to = to.get(),
+        .intent = intent,
+    };
+
+    auto it = m_slots.find(key);
+    if (it != m_slots.end()) {
+        // the address of a destroyed color description may be reused by a new one
+        if (!it->second.from.expired() && !it->second.to.expired()) {
+            m_hits++;
+            return it->second.entry;
+        }
+        m_slots.erase(it);
+    }
+
+    m_misses++;
+    if (m_slots.size() >= m_evictionThreshold) {
+        evictExpired();
+        m_evictionThreshold = std::max<size_t>(64, m_slots.size() * 2);
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->pipeline = ColorPipeline::create(from, to, intent);
+    entry->uniforms = GLShader::ColorspaceUniforms::create(*from, *to, intent);
+    entry->isIdentity = entry->pipeline.isIdentity();
+
+    m_slots[key] = Slot{
+        .from = from,
+        .to = to,
+        .entry = entry,
+    };
+    return entry;
+}
+
+void ColorPipelineCache::evictExpired()
+{
+    std::erase_if(m_slots, [](const auto &item) {
+        return item.second.from.expired() || item.second.to.expired();
+    });
+}
+
+void ColorPipelineCache::clear()
+{
+    m_slots.clear();
+}
+
+size_t ColorPipelineCache::size() const
+{
+    return m_slots.size();
+}
+
+quint64 ColorPipelineCache::hits() const
+{
+    return m_hits;
+}
+
+quint64 ColorPipelineCache::misses() const
+{
+    return m_misses;
+}
+
+} // namespace KWin
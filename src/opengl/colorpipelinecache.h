@@ -0,0 +1,86 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "core/colorpipeline.h"
+#include "opengl/glshader.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace KWin
+{
+
+/**
+ * The ColorPipelineCache stores the color pipelines and the shader uniforms needed to convert
+ * between two color descriptions, so that they don't have to be recomputed for every item on
+ * every frame.
+ *
+ * Color descriptions are immutable, so the entries are keyed by the identity of the source and
+ * destination color descriptions and the rendering intent. An entry becomes stale as soon as
+ * either of the color descriptions is destroyed; stale entries are evicted lazily.
+ */
+class KWIN_EXPORT ColorPipelineCache
+{
+public:
+    struct Entry
+    {
+        ColorPipeline pipeline;
+        GLShader::ColorspaceUniforms uniforms;
+        bool isIdentity = true;
+    };
+
+    static ColorPipelineCache *self();
+
+    /**
+     * Returns the cached color conversion from @p from to @p to with the given @p intent,
+     * creating it if necessary.
+     */
+    std::shared_ptr<const Entry> lookup(const std::shared_ptr<ColorDescription> &from, const std::shared_ptr<ColorDescription> &to, RenderingIntent intent);
+
+    /**
+     * Drops all cached entries. The hit and miss counters are not affected.
+     */
+    void clear();
+
+    size_t size() const;
+    quint64 hits() const;
+    quint64 misses() const;
+
+private:
+    struct Key
+    {
+        const ColorDescription *from;
+        const ColorDescription *to;
+        RenderingIntent intent;
+
+        bool operator==(const Key &other) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Slot
+    {
+        std::weak_ptr<ColorDescription> from;
+        std::weak_ptr<ColorDescription> to;
+        std::shared_ptr<const Entry> entry;
+    };
+
+    void evictExpired();
+
+    std::unordered_map<Key, Slot, KeyHash> m_slots;
+    size_t m_evictionThreshold = 64;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+} // namespace KWin
@@ -11,6 +11,7 @@
 #include "egldisplay.h"
 #include "eglimagetexture.h"
 #include "glframebuffer.h"
+#include "glpixelunpackring.h"
 #include "glplatform.h"
 #include "glshader.h"
 #include "glshadermanager.h"
@@ -127,6 +128,7 @@ EglContext::EglContext(EglDisplay *display, EGLConfig config, ::EGLContext conte
     , m_haveSyncFences((m_isOpenglES && hasVersion(Version(3, 0))) || (!m_isOpenglES && hasVersion(Version(3, 2))) || hasOpenglExtension(QByteArrayLiteral("GL_ARB_sync")))
     , m_supportsIndexedQuads(checkIndexedQuads(this))
     , m_supportsPackInvert(hasOpenglExtension(QByteArrayLiteral("GL_MESA_pack_invert")))
+    , m_supportsComputeShaders(hasVersion(m_isOpenglES ? Version(3, 1) : Version(4, 3)))
     , m_glPlatform(std::make_unique<GLPlatform>(m_versionString, m_glslVersionString, m_renderer, m_vendor))
     , m_display(display)
     , m_handle(context)
@@ -142,6 +144,9 @@ EglContext::EglContext(EglDisplay *display, EGLConfig config, ::EGLContext conte
             m_streamingBuffer->setPersistent();
         }
     }
+    if (GLPixelUnpackRing::isSupported(this) && qgetenv("KWIN_GL_ASYNC_UPLOAD") != QByteArrayLiteral("0")) {
+        m_pixelUnpackRing = std::make_unique<GLPixelUnpackRing>();
+    }
     // It is not legal to not have a vertex array object bound in a core context
     // to make code handling old and new OpenGL versions easier, bind a dummy vao that's used for everything
     if (!isOpenGLES() && hasOpenglExtension(QByteArrayLiteral("GL_ARB_vertex_array_object"))) {
@@ -159,6 +164,7 @@ EglContext::~EglContext()
     m_shaderManager.reset();
     m_streamingBuffer.reset();
     m_indexBuffer.reset();
+    m_pixelUnpackRing.reset();
     doneCurrent();
     eglDestroyContext(m_display->handle(), m_handle);
 }
@@ -456,6 +462,11 @@ bool EglContext::supportsPackInvert() const
     return m_supportsPackInvert;
 }
 
+bool EglContext::supportsComputeShaders() const
+{
+    return m_supportsComputeShaders;
+}
+
 ShaderManager *EglContext::shaderManager() const
 {
     return m_shaderManager.get();
@@ -471,6 +482,11 @@ IndexBuffer *EglContext::indexBuffer() const
     return m_indexBuffer.get();
 }
 
+GLPixelUnpackRing *EglContext::pixelUnpackRing() const
+{
+    return m_pixelUnpackRing.get();
+}
+
 GLPlatform *EglContext::glPlatform() const
 {
     return m_glPlatform.get();
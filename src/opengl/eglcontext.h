@@ -22,6 +22,7 @@ namespace KWin
 class EglDisplay;
 class ShaderManager;
 class IndexBuffer;
+class GLPixelUnpackRing;
 class GLPlatform;
 class GLFramebuffer;
 struct DmaBufAttributes;
@@ -73,9 +74,15 @@ public:
     bool haveBufferStorage() const;
     bool haveSyncFences() const;
     bool supportsPackInvert() const;
+    bool supportsComputeShaders() const;
     ShaderManager *shaderManager() const;
     GLVertexBuffer *streamingVbo() const;
     IndexBuffer *indexBuffer() const;
+    /**
+     * @returns the ring of pixel unpack buffers used for asynchronous texture uploads,
+     * or @c nullptr if they are not supported
+     */
+    GLPixelUnpackRing *pixelUnpackRing() const;
     GLPlatform *glPlatform() const;
     QSet<QByteArray> openglExtensions() const;
 
@@ -130,6 +137,7 @@ private:
     const bool m_haveSyncFences;
     const bool m_supportsIndexedQuads;
     const bool m_supportsPackInvert;
+    const bool m_supportsComputeShaders;
     const std::unique_ptr<GLPlatform> m_glPlatform;
     glGetGraphicsResetStatus_func m_glGetGraphicsResetStatus = nullptr;
     glReadnPixels_func m_glReadnPixels = nullptr;
@@ -142,6 +150,7 @@ private:
     std::unique_ptr<ShaderManager> m_shaderManager;
     std::unique_ptr<GLVertexBuffer> m_streamingBuffer;
     std::unique_ptr<IndexBuffer> m_indexBuffer;
+    std::unique_ptr<GLPixelUnpackRing> m_pixelUnpackRing;
     QStack<GLFramebuffer *> m_fbos;
     uint32_t m_vao = 0;
 };
@@ -0,0 +1,134 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "opengl/glpixelunpackring.h"
+#include "opengl/eglcontext.h"
+
+#include <cstring>
+
+namespace KWin
+{
+
+GLPixelUnpackRing::GLPixelUnpackRing()
+{
+}
+
+GLPixelUnpackRing::~GLPixelUnpackRing()
+{
+    for (Slot &slot : m_slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        if (slot.buffer) {
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+}
+
+bool GLPixelUnpackRing::isSupported(const EglContext *context)
+{
+    if (!context->hasMapBufferRange() || !context->haveSyncFences()) {
+        return false;
+    }
+    if (context->isOpenGLES()) {
+        return context->hasVersion(Version(3, 0));
+    }
+    return context->hasVersion(Version(2, 1)) || context->hasOpenglExtension(QByteArrayLiteral("GL_ARB_pixel_buffer_object"));
+}
+
+GLPixelUnpackRing::Slot *GLPixelUnpackRing::acquireSlot()
+{
+    for (int i = 0; i < SlotCount; ++i) {
+        Slot *slot = &m_slots[(m_nextSlot + i) % SlotCount];
+        if (slot->fence) {
+            GLint status;
+            glGetSynciv(slot->fence, GL_SYNC_STATUS, 1, nullptr, &status);
+            if (status != GL_SIGNALED) {
+                continue;
+            }
+            glDeleteSync(slot->fence);
+            slot->fence = nullptr;
+        }
+        m_nextSlot = (m_nextSlot + i + 1) % SlotCount;
+        return slot;
+    }
+    return nullptr;
+}
+
+bool GLPixelUnpackRing::upload(GLenum target, const QImage &image, const QRegion &region, const QPoint &offset, GLenum format, GLenum type)
+{
+    const int bytesPerPixel = image.depth() / 8;
+    if (bytesPerPixel % 4 != 0) {
+        // the rows are packed tightly, they must satisfy the default unpack alignment
+        return false;
+    }
+
+    qsizetype totalSize = 0;
+    for (const QRect &rect : region) {
+        totalSize += qsizetype(rect.width()) * rect.height() * bytesPerPixel;
+    }
+    if (totalSize == 0) {
+        return true;
+    }
+    if (totalSize > MaxSlotSize) {
+        return false;
+    }
+
+    Slot *slot = acquireSlot();
+    if (!slot) {
+        return false;
+    }
+
+    if (!slot->buffer) {
+        glGenBuffers(1, &slot->buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->buffer);
+    if (slot->size < totalSize) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        slot->size = totalSize;
+        slot->oversizedUses = 0;
+    } else if (slot->size / 4 > totalSize) {
+        // don't keep the memory of a one-off large upload around forever
+        if (++slot->oversizedUses >= MaxOversizedUses) {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+            slot->size = totalSize;
+            slot->oversizedUses = 0;
+        }
+    } else {
+        slot->oversizedUses = 0;
+    }
+
+    auto map = static_cast<uchar *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!map) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // Pack the damaged rects tightly, so no unpack row length is needed.
+    qsizetype mapOffset = 0;
+    for (const QRect &rect : region) {
+        const qsizetype rowSize = qsizetype(rect.width()) * bytesPerPixel;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            std::memcpy(map + mapOffset, image.constScanLine(y) + qsizetype(rect.x()) * bytesPerPixel, rowSize);
+            mapOffset += rowSize;
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    mapOffset = 0;
+    for (const QRect &rect : region) {
+        glTexSubImage2D(target, 0, offset.x() + rect.x(), offset.y() + rect.y(), rect.width(), rect.height(), format, type, reinterpret_cast<const void *>(mapOffset));
+        mapOffset += qsizetype(rect.width()) * rect.height() * bytesPerPixel;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    return true;
+}
+
+} // namespace KWin
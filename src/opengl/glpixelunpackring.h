@@ -0,0 +1,72 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QImage>
+#include <QPoint>
+#include <QRegion>
+
+#include <array>
+#include <epoxy/gl.h>
+
+namespace KWin
+{
+
+class EglContext;
+
+/**
+ * The GLPixelUnpackRing uploads texture data through a small ring of pixel unpack buffers.
+ *
+ * The pixels are copied into a mapped buffer object and the texture update is sourced from
+ * that buffer, so glTexSubImage2D() returns without waiting for the transfer. Each buffer is
+ * guarded by a fence and only reused after the GPU has consumed its contents; if no buffer
+ * is free, upload() fails and the caller is expected to fall back to a direct upload rather
+ * than to stall.
+ *
+ * A buffer grows to fit the largest upload it is used for. If it keeps being used for much
+ * smaller uploads, it is shrunk again. Uploads above a size limit are not staged at all.
+ */
+class KWIN_EXPORT GLPixelUnpackRing
+{
+public:
+    explicit GLPixelUnpackRing();
+    ~GLPixelUnpackRing();
+
+    static bool isSupported(const EglContext *context);
+
+    /**
+     * Uploads the @p region of @p image to the currently bound texture of the given @p target,
+     * with the given @p offset. The @p image must already be in a format matching @p format
+     * and @p type. Returns @c false if the upload has not been performed.
+     */
+    bool upload(GLenum target, const QImage &image, const QRegion &region, const QPoint &offset, GLenum format, GLenum type);
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        qsizetype size = 0;
+        GLsync fence = nullptr;
+        int oversizedUses = 0;
+    };
+
+    Slot *acquireSlot();
+
+    static constexpr int SlotCount = 4;
+    // a full 4K frame at 4 bytes per pixel still fits
+    static constexpr qsizetype MaxSlotSize = 64 * 1024 * 1024;
+    // a buffer used this many times in a row for uploads below a quarter of its size is shrunk
+    static constexpr int MaxOversizedUses = 60;
+    std::array<Slot, SlotCount> m_slots;
+    int m_nextSlot = 0;
+};
+
+} // namespace KWin
@@ -84,4 +84,12 @@ std::optional<RenderTimeSpan> GLRenderTimeQuery::query()
         .end = end,
     };
 }
+
+std::optional<std::chrono::nanoseconds> GLRenderTimeQuery::gpuTime() const
+{
+    if (!m_gpuProbe.query) {
+        return std::nullopt;
+    }
+    return m_gpuProbe.end - m_gpuProbe.start;
+}
 }
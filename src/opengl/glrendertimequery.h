@@ -33,6 +33,12 @@ public:
      */
     std::optional<RenderTimeSpan> query() override;
 
+    /**
+     * Returns how long the GPU took to execute the commands recorded between begin()
+     * and end(), or std::nullopt if timer queries aren't supported. Only valid after query().
+     */
+    std::optional<std::chrono::nanoseconds> gpuTime() const;
+
 private:
     const std::weak_ptr<EglContext> m_context;
     bool m_hasResult = false;
@@ -107,6 +107,9 @@ const QByteArray GLShader::prepareSource(GLenum shaderType, const QByteArray &so
     if (context->isOpenGLES() && context->glslVersion() >= Version(3, 0)) {
         ba.replace("#version 140", "#version 300 es\n\nprecision highp float;\n");
     }
+    if (context->isOpenGLES() && shaderType == GL_COMPUTE_SHADER) {
+        ba.replace("#version 430", "#version 310 es\n\nprecision highp float;\nprecision highp sampler2D;\nprecision highp image2D;\n");
+    }
 
     return ba;
 }
@@ -134,7 +137,12 @@ bool GLShader::compile(GLuint program, GLenum shaderType, const QByteArray &sour
     glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 
     if (status == 0) {
-        const char *typeName = (shaderType == GL_VERTEX_SHADER ? "vertex" : "fragment");
+        const char *typeName = "fragment";
+        if (shaderType == GL_VERTEX_SHADER) {
+            typeName = "vertex";
+        } else if (shaderType == GL_COMPUTE_SHADER) {
+            typeName = "compute";
+        }
         qCCritical(KWIN_OPENGL) << "Failed to compile" << typeName << "shader:"
                                 << "\n"
                                 << log;
@@ -185,6 +193,17 @@ bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSo
     return link();
 }
 
+bool GLShader::loadCompute(const QByteArray &computeSource)
+{
+    m_valid = false;
+
+    if (!compile(m_program, GL_COMPUTE_SHADER, computeSource)) {
+        return false;
+    }
+
+    return link();
+}
+
 void GLShader::bindAttributeLocation(const char *name, int index)
 {
     glBindAttribLocation(m_program, index, name);
@@ -482,30 +501,52 @@ QMatrix4x4 GLShader::getUniformMatrix4x4(const char *name)
 
 static bool s_disableTonemapping = qEnvironmentVariableIntValue("KWIN_DISABLE_TONEMAPPING") == 1;
 
-void GLShader::setColorspaceUniforms(const std::shared_ptr<ColorDescription> &src, const std::shared_ptr<ColorDescription> &dst, RenderingIntent intent)
+GLShader::ColorspaceUniforms GLShader::ColorspaceUniforms::create(const ColorDescription &src, const ColorDescription &dst, RenderingIntent intent)
 {
-    setUniform(Mat4Uniform::ColorimetryTransformation, src->toOther(*dst, intent));
-    setUniform(IntUniform::SourceNamedTransferFunction, src->transferFunction().type);
-    if (src->transferFunction().type == TransferFunction::BT1886) {
-        setUniform(Vec2Uniform::SourceTransferFunctionParams, QVector2D(src->transferFunction().bt1886B(), src->transferFunction().bt1886A()));
+    ColorspaceUniforms ret;
+    ret.colorimetryTransformation = src.toOther(dst, intent);
+    ret.sourceNamedTransferFunction = src.transferFunction().type;
+    if (src.transferFunction().type == TransferFunction::BT1886) {
+        ret.sourceTransferFunctionParams = QVector2D(src.transferFunction().bt1886B(), src.transferFunction().bt1886A());
     } else {
-        setUniform(Vec2Uniform::SourceTransferFunctionParams, QVector2D(src->transferFunction().minLuminance, src->transferFunction().maxLuminance - src->transferFunction().minLuminance));
+        ret.sourceTransferFunctionParams = QVector2D(src.transferFunction().minLuminance, src.transferFunction().maxLuminance - src.transferFunction().minLuminance);
     }
-    setUniform(FloatUniform::SourceReferenceLuminance, src->referenceLuminance());
-    setUniform(IntUniform::DestinationNamedTransferFunction, dst->transferFunction().type);
-    if (dst->transferFunction().type == TransferFunction::BT1886) {
-        setUniform(Vec2Uniform::DestinationTransferFunctionParams, QVector2D(dst->transferFunction().bt1886B(), dst->transferFunction().bt1886A()));
+    ret.sourceReferenceLuminance = src.referenceLuminance();
+    ret.destinationNamedTransferFunction = dst.transferFunction().type;
+    if (dst.transferFunction().type == TransferFunction::BT1886) {
+        ret.destinationTransferFunctionParams = QVector2D(dst.transferFunction().bt1886B(), dst.transferFunction().bt1886A());
     } else {
-        setUniform(Vec2Uniform::DestinationTransferFunctionParams, QVector2D(dst->transferFunction().minLuminance, dst->transferFunction().maxLuminance - dst->transferFunction().minLuminance));
+        ret.destinationTransferFunctionParams = QVector2D(dst.transferFunction().minLuminance, dst.transferFunction().maxLuminance - dst.transferFunction().minLuminance);
     }
-    setUniform(FloatUniform::DestinationReferenceLuminance, dst->referenceLuminance());
-    setUniform(FloatUniform::MaxDestinationLuminance, dst->maxHdrLuminance().value_or(10'000));
+    ret.destinationReferenceLuminance = dst.referenceLuminance();
+    ret.maxDestinationLuminance = dst.maxHdrLuminance().value_or(10'000);
     if (!s_disableTonemapping && intent == RenderingIntent::Perceptual) {
-        setUniform(FloatUniform::MaxTonemappingLuminance, src->maxHdrLuminance().value_or(src->referenceLuminance()) * dst->referenceLuminance() / src->referenceLuminance());
+        ret.maxTonemappingLuminance = src.maxHdrLuminance().value_or(src.referenceLuminance()) * dst.referenceLuminance() / src.referenceLuminance();
     } else {
-        setUniform(FloatUniform::MaxTonemappingLuminance, dst->maxHdrLuminance().value_or(10'000));
+        ret.maxTonemappingLuminance = dst.maxHdrLuminance().value_or(10'000);
     }
-    setUniform(Mat4Uniform::DestinationToLMS, dst->containerColorimetry().toLMS());
-    setUniform(Mat4Uniform::LMSToDestination, dst->containerColorimetry().fromLMS());
+    ret.destinationToLMS = dst.containerColorimetry().toLMS();
+    ret.lmsToDestination = dst.containerColorimetry().fromLMS();
+    return ret;
+}
+
+void GLShader::setColorspaceUniforms(const std::shared_ptr<ColorDescription> &src, const std::shared_ptr<ColorDescription> &dst, RenderingIntent intent)
+{
+    setColorspaceUniforms(ColorspaceUniforms::create(*src, *dst, intent));
+}
+
+void GLShader::setColorspaceUniforms(const ColorspaceUniforms &uniforms)
+{
+    setUniform(Mat4Uniform::ColorimetryTransformation, uniforms.colorimetryTransformation);
+    setUniform(IntUniform::SourceNamedTransferFunction, uniforms.sourceNamedTransferFunction);
+    setUniform(Vec2Uniform::SourceTransferFunctionParams, uniforms.sourceTransferFunctionParams);
+    setUniform(FloatUniform::SourceReferenceLuminance, uniforms.sourceReferenceLuminance);
+    setUniform(IntUniform::DestinationNamedTransferFunction, uniforms.destinationNamedTransferFunction);
+    setUniform(Vec2Uniform::DestinationTransferFunctionParams, uniforms.destinationTransferFunctionParams);
+    setUniform(FloatUniform::DestinationReferenceLuminance, uniforms.destinationReferenceLuminance);
+    setUniform(FloatUniform::MaxDestinationLuminance, uniforms.maxDestinationLuminance);
+    setUniform(FloatUniform::MaxTonemappingLuminance, uniforms.maxTonemappingLuminance);
+    setUniform(Mat4Uniform::DestinationToLMS, uniforms.destinationToLMS);
+    setUniform(Mat4Uniform::LMSToDestination, uniforms.lmsToDestination);
 }
 }
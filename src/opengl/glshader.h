@@ -145,12 +145,35 @@ public:
     bool setUniform(ColorUniform uniform, const QVector4D &value);
     bool setUniform(ColorUniform uniform, const QColor &value);
 
+    /**
+     * The values of all colorspace related uniforms for a given source and destination color
+     * description, so that they can be computed once and uploaded many times.
+     */
+    struct ColorspaceUniforms
+    {
+        static ColorspaceUniforms create(const ColorDescription &src, const ColorDescription &dst, RenderingIntent intent);
+
+        QMatrix4x4 colorimetryTransformation;
+        int sourceNamedTransferFunction = 0;
+        QVector2D sourceTransferFunctionParams;
+        float sourceReferenceLuminance = 0;
+        int destinationNamedTransferFunction = 0;
+        QVector2D destinationTransferFunctionParams;
+        float destinationReferenceLuminance = 0;
+        float maxDestinationLuminance = 0;
+        float maxTonemappingLuminance = 0;
+        QMatrix4x4 destinationToLMS;
+        QMatrix4x4 lmsToDestination;
+    };
+
     void setColorspaceUniforms(const std::shared_ptr<ColorDescription> &src, const std::shared_ptr<ColorDescription> &dst, RenderingIntent intent);
+    void setColorspaceUniforms(const ColorspaceUniforms &uniforms);
 
 protected:
     GLShader(unsigned int flags = NoFlags);
     bool loadFromFiles(const QString &vertexfile, const QString &fragmentfile);
     bool load(const QByteArray &vertexSource, const QByteArray &fragmentSource);
+    bool loadCompute(const QByteArray &computeSource);
     const QByteArray prepareSource(GLenum shaderType, const QByteArray &sourceCode) const;
     bool compile(GLuint program, GLenum shaderType, const QByteArray &sourceCode) const;
     void bind();
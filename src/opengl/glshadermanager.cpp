@@ -406,4 +406,16 @@ std::unique_ptr<GLShader> ShaderManager::loadShaderFromCode(const QByteArray &ve
     return shader;
 }
 
+std::unique_ptr<GLShader> ShaderManager::loadComputeShaderFromCode(const QByteArray &computeSource)
+{
+    const auto compute = preprocess(computeSource);
+    if (!compute) {
+        return std::unique_ptr<GLShader>(new GLShader());
+    }
+
+    std::unique_ptr<GLShader> shader{new GLShader()};
+    shader->loadCompute(*compute);
+    return shader;
+}
+
 }
@@ -101,6 +101,14 @@ public:
      */
     std::unique_ptr<GLShader> loadShaderFromCode(const QByteArray &vertexSource, const QByteArray &fragmentSource);
 
+    /**
+     * Creates a GLShader with a single compute stage from the given @p computeSource.
+     * The source should start with "#version 430", it will be adjusted for OpenGL ES.
+     * The caller must check that compute shaders are supported, see EglContext::supportsComputeShaders().
+     * @return The created shader, check GLShader::isValid() before using it
+     */
+    std::unique_ptr<GLShader> loadComputeShaderFromCode(const QByteArray &computeSource);
+
     /**
      * Creates a custom shader with the given @p traits and custom @p vertexSource and or @p fragmentSource.
      * If the @p vertexSource is empty a vertex shader with the given @p traits is generated.
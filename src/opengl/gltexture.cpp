@@ -11,6 +11,7 @@
 
 #include "gltexture_p.h"
 #include "opengl/glframebuffer.h"
+#include "opengl/glpixelunpackring.h"
 #include "opengl/glplatform.h"
 #include "opengl/glutils.h"
 #include "utils/common.h"
@@ -192,6 +193,19 @@ void GLTexture::update(const QImage &image, const QRegion &region, const QPoint
 
     bind();
 
+    // Large updates are staged through a pixel unpack buffer so the transfer doesn't block.
+    static constexpr qsizetype asyncUploadThreshold = 256 * 1024;
+    if (GLPixelUnpackRing *ring = context->pixelUnpackRing()) {
+        qsizetype uploadSize = 0;
+        for (const QRect &rect : region) {
+            uploadSize += qsizetype(rect.width()) * rect.height() * (im.depth() / 8);
+        }
+        if (uploadSize >= asyncUploadThreshold && ring->upload(d->m_target, im, region, offset, glFormat, type)) {
+            unbind();
+            return;
+        }
+    }
+
     for (const QRect &rect : region) {
         Q_ASSERT(im.depth() % 8 == 0);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, im.bytesPerLine() / (im.depth() / 8));
@@ -510,6 +524,23 @@ std::unique_ptr<GLTexture> GLTexture::allocate(GLenum internalFormat, const QSiz
     return std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, texture, internalFormat, size, levels, true, OutputTransform{}));
 }
 
+std::unique_ptr<GLTexture> GLTexture::allocateImmutable(GLenum internalFormat, const QSize &size, int levels)
+{
+    if (!EglContext::currentContext()->supportsTextureStorage()) {
+        return nullptr;
+    }
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    if (texture == 0) {
+        qCWarning(KWIN_OPENGL, "generating OpenGL texture handle failed");
+        return nullptr;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, size.width(), size.height());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return std::unique_ptr<GLTexture>(new GLTexture(GL_TEXTURE_2D, texture, internalFormat, size, levels, true, OutputTransform{}));
+}
+
 std::unique_ptr<GLTexture> GLTexture::upload(const QImage &image)
 {
     if (image.isNull()) {
@@ -123,6 +123,12 @@ public:
 
     static std::unique_ptr<GLTexture> createNonOwningWrapper(GLuint textureId, GLenum internalFormat, const QSize &size);
     static std::unique_ptr<GLTexture> allocate(GLenum internalFormat, const QSize &size, int levels = 1);
+    /**
+     * Allocates a texture with immutable storage of exactly the given @p internalFormat, also
+     * on OpenGL ES, so that it can be bound as an image in compute shaders. Returns @c null if
+     * texture storage is not supported.
+     */
+    static std::unique_ptr<GLTexture> allocateImmutable(GLenum internalFormat, const QSize &size, int levels = 1);
     static std::unique_ptr<GLTexture> upload(const QImage &image);
     static std::unique_ptr<GLTexture> upload(const QPixmap &pixmap);
 
@@ -10,6 +10,7 @@
 // KConfigSkeleton
 #include "blurconfig.h"
 
+#include "core/outputlayer.h"
 #include "core/pixelgrid.h"
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
@@ -19,6 +20,7 @@
 #include "scene/scene.h"
 #include "scene/surfaceitem.h"
 #include "scene/windowitem.h"
+#include "utils/envvar.h"
 #include "wayland/blur.h"
 #include "wayland/contrast.h"
 #include "wayland/display.h"
@@ -29,6 +31,7 @@
 #include "utils/xcbutils.h"
 #endif
 
+#include <QFile>
 #include <QGuiApplication>
 #include <QMatrix4x4>
 #include <QScreen>
@@ -131,6 +134,10 @@ BlurEffect::BlurEffect()
         m_noisePass.noiseTextureSizeLocation = m_noisePass.shader->uniformLocation("noiseTextureSize");
     }
 
+    // The compute passes produce the same result as the fragment passes, KWIN_BLUR_COMPUTE=0
+    // forces the fragment passes, e.g. to compare the two.
+    m_computeEnabled = EglContext::currentContext()->supportsComputeShaders() && environmentVariableBoolValue("KWIN_BLUR_COMPUTE").value_or(true);
+
     initBlurStrengthValues();
     reconfigure(ReconfigureAll);
 
@@ -474,6 +481,85 @@ bool BlurEffect::enabledByDefault()
     return true;
 }
 
+static std::unique_ptr<GLShader> loadComputeShader(const QString &fileName, const QByteArray &imageFormat)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(KWIN_BLUR) << "Failed to read" << fileName;
+        return nullptr;
+    }
+    QByteArray source = file.readAll();
+    source.replace("IMAGE_FORMAT", imageFormat);
+
+    auto shader = ShaderManager::instance()->loadComputeShaderFromCode(source);
+    if (!shader->isValid()) {
+        qCWarning(KWIN_BLUR) << "Failed to load compute shader" << fileName;
+        return nullptr;
+    }
+    return shader;
+}
+
+BlurEffect::ComputePasses *BlurEffect::computePasses(GLenum textureFormat)
+{
+    if (!m_computeEnabled) {
+        return nullptr;
+    }
+
+    // only formats that can be used as images on both OpenGL and OpenGL ES
+    QByteArray imageFormat;
+    switch (textureFormat) {
+    case GL_RGBA8:
+        imageFormat = QByteArrayLiteral("rgba8");
+        break;
+    case GL_RGBA16F:
+        imageFormat = QByteArrayLiteral("rgba16f");
+        break;
+    default:
+        return nullptr;
+    }
+
+    auto it = m_computePasses.find(textureFormat);
+    if (it == m_computePasses.end()) {
+        ComputePasses passes;
+        passes.downsample.shader = loadComputeShader(QStringLiteral(":/effects/blur/shaders/downsample.comp"), imageFormat);
+        passes.upsample.shader = loadComputeShader(QStringLiteral(":/effects/blur/shaders/upsample.comp"), imageFormat);
+        for (ComputePass *pass : {&passes.downsample, &passes.upsample}) {
+            if (pass->shader) {
+                pass->offsetLocation = pass->shader->uniformLocation("offset");
+                pass->halfpixelLocation = pass->shader->uniformLocation("halfpixel");
+            }
+        }
+        it = m_computePasses.emplace(textureFormat, std::move(passes)).first;
+    }
+
+    // if the shaders failed to compile, fall back to the fragment passes
+    if (!it->second.downsample.shader || !it->second.upsample.shader) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void BlurEffect::dispatchComputePass(const ComputePass &pass, GLTexture *read, GLTexture *draw)
+{
+    static constexpr int workgroupSize = 8;
+
+    const QVector2D halfpixel(0.5 / read->width(), 0.5 / read->height());
+    pass.shader->setUniform(pass.halfpixelLocation, halfpixel);
+
+    read->bind();
+    glBindImageTexture(0, draw->texture(), 0, GL_FALSE, 0, GL_WRITE_ONLY, draw->internalFormat());
+    glDispatchCompute((draw->width() + workgroupSize - 1) / workgroupSize, (draw->height() + workgroupSize - 1) / workgroupSize, 1);
+
+    // the next pass samples what this pass has written
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    m_computeDispatchCount++;
+}
+
+quint64 BlurEffect::computeDispatchCount() const
+{
+    return m_computeDispatchCount;
+}
+
 bool BlurEffect::supported()
 {
     return effects->isOpenGLCompositing();
@@ -525,9 +611,32 @@ void BlurEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseco
 {
     m_paintedDeviceArea = QRegion();
     m_currentDeviceBlur = QRegion();
+    m_damagedDeviceArea = QRegion();
     m_currentView = data.view;
 
     effects->prePaintScreen(data, presentTime);
+
+    if (!m_windows.empty()) {
+        // repaints that aren't attached to a window, e.g. of items that have been hidden,
+        // may change the background of any blurred window
+        m_damagedDeviceArea = data.view->mapToDeviceCoordinatesAligned(data.paint);
+        if (OutputLayer *layer = data.view->layer()) {
+            m_damagedDeviceArea += scaleRegionAligned(layer->repaints(), data.view->scale());
+        }
+    }
+}
+
+static QRegion itemRepaints(RenderView *view, Item *item)
+{
+    QRegion repaints;
+    if (view->shouldRenderItem(item)) {
+        repaints = view->mapToDeviceCoordinatesAligned(item->repaints(view));
+    }
+    const auto childItems = item->childItems();
+    for (Item *childItem : childItems) {
+        repaints += itemRepaints(view, childItem);
+    }
+    return repaints;
 }
 
 void BlurEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
@@ -536,6 +645,12 @@ void BlurEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePain
 
     effects->prePaintWindow(view, w, data, presentTime);
 
+    // the area where the contents of this window change, before it's expanded for blurring
+    QRegion windowDamage;
+    if (!m_windows.empty()) {
+        windowDamage = data.devicePaint + itemRepaints(view, w->windowItem());
+    }
+
     const QRegion oldOpaque = data.deviceOpaque;
     if (data.deviceOpaque.intersects(m_currentDeviceBlur)) {
         // to blur an area partially we have to shrink the opaque area of a window
@@ -569,10 +684,25 @@ void BlurEffect::prePaintWindow(RenderView *view, EffectWindow *w, WindowPrePain
         }
     }
 
+    // the cached blur can only be reused if nothing behind the blurred area has changed
+    if (auto it = m_windows.find(w); it != m_windows.end()) {
+        BlurRenderData &renderInfo = it->second.render[view];
+        if (m_damagedDeviceArea.intersects(blurArea)) {
+            renderInfo.backgroundDamaged = true;
+        }
+        // if the blur of this window is rendered again, the windows above it see a new background
+        if ((renderInfo.backgroundDamaged || !renderInfo.blurValid) && data.devicePaint.intersects(blurArea)) {
+            windowDamage += data.devicePaint & blurArea;
+        }
+    }
+
     m_currentDeviceBlur += blurArea;
 
     m_paintedDeviceArea -= data.deviceOpaque;
     m_paintedDeviceArea += data.devicePaint;
+
+    m_damagedDeviceArea -= data.deviceOpaque;
+    m_damagedDeviceArea += windowDamage;
 }
 
 bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const
@@ -703,13 +833,19 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
         textureFormat = renderTarget.texture()->internalFormat();
     }
 
+    // The compute passes need textures with immutable storage, which is decided by the format.
+    ComputePasses *computePasses = this->computePasses(textureFormat);
+
     if (renderInfo.framebuffers.size() != (m_iterationCount + 1) || renderInfo.textures[0]->size() != backgroundRect.size() || renderInfo.textures[0]->internalFormat() != textureFormat) {
         renderInfo.framebuffers.clear();
         renderInfo.textures.clear();
+        renderInfo.fetchedRegion = QRegion();
+        renderInfo.blurValid = false;
 
         glClearColor(0, 0, 0, 0);
         for (size_t i = 0; i <= m_iterationCount; ++i) {
-            auto texture = GLTexture::allocate(textureFormat, backgroundRect.size() / (1 << i));
+            const QSize textureSize = backgroundRect.size() / (1 << i);
+            auto texture = computePasses ? GLTexture::allocateImmutable(textureFormat, textureSize) : GLTexture::allocate(textureFormat, textureSize);
             if (!texture) {
                 qCWarning(KWIN_BLUR) << "Failed to allocate an offscreen texture";
                 return;
@@ -730,10 +866,23 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
         }
     }
 
-    // Fetch the pixels behind the shape that is going to be blurred.
-    const QRegion dirtyRegion = viewport.mapFromDeviceCoordinatesContained(deviceRegion) & backgroundRect;
-    for (const QRect &dirtyRect : dirtyRegion) {
-        renderInfo.framebuffers[0]->blitFromRenderTarget(renderTarget, viewport, dirtyRect, dirtyRect.translated(-backgroundRect.topLeft()));
+    if (renderInfo.backgroundRect != backgroundRect) {
+        // the cached background is at the wrong position
+        renderInfo.backgroundRect = backgroundRect;
+        renderInfo.fetchedRegion = QRegion();
+        renderInfo.blurValid = false;
+    }
+
+    // If nothing behind the window has changed, the background that would be fetched now is the
+    // same as the one that is already in the textures, and the blurred result can be reused.
+    const bool reuseBlur = renderInfo.blurValid && !renderInfo.backgroundDamaged;
+    if (!reuseBlur) {
+        // Fetch the pixels behind the shape that is going to be blurred.
+        const QRegion dirtyRegion = viewport.mapFromDeviceCoordinatesContained(deviceRegion) & backgroundRect;
+        for (const QRect &dirtyRect : dirtyRegion) {
+            renderInfo.framebuffers[0]->blitFromRenderTarget(renderTarget, viewport, dirtyRect, dirtyRect.translated(-backgroundRect.topLeft()));
+        }
+        renderInfo.fetchedRegion += dirtyRegion.translated(-backgroundRect.topLeft());
     }
 
     // Upload the geometry: the first 6 vertices are used when downsampling and upsampling offscreen,
@@ -840,8 +989,28 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
     vbo->bindArrays();
 
+    // The dual Kawase algorithm with compute shaders, see the fragment passes below.
+    if (!reuseBlur && computePasses) {
+        ShaderManager::instance()->pushShader(computePasses->downsample.shader.get());
+        computePasses->downsample.shader->setUniform(computePasses->downsample.offsetLocation, float(m_offset));
+        for (size_t i = 1; i < renderInfo.textures.size(); ++i) {
+            dispatchComputePass(computePasses->downsample, renderInfo.textures[i - 1].get(), renderInfo.textures[i].get());
+        }
+        ShaderManager::instance()->popShader();
+
+        ShaderManager::instance()->pushShader(computePasses->upsample.shader.get());
+        computePasses->upsample.shader->setUniform(computePasses->upsample.offsetLocation, float(m_offset));
+        for (size_t i = renderInfo.textures.size() - 1; i > 1; --i) {
+            dispatchComputePass(computePasses->upsample, renderInfo.textures[i].get(), renderInfo.textures[i - 1].get());
+        }
+        ShaderManager::instance()->popShader();
+
+        // don't leave the last texture bound as an image, so that it can't be written by accident
+        glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, renderInfo.textures.front()->internalFormat());
+    }
+
     // The downsample pass of the dual Kawase algorithm: the background will be scaled down 50% every iteration.
-    {
+    if (!reuseBlur && !computePasses) {
         ShaderManager::instance()->pushShader(m_downsamplePass.shader.get());
 
         QMatrix4x4 projectionMatrix;
@@ -868,7 +1037,7 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
     }
 
     // The upsample pass of the dual Kawase algorithm: the background will be scaled up 200% every iteration.
-    {
+    if (!reuseBlur && !computePasses) {
         ShaderManager::instance()->pushShader(m_upsamplePass.shader.get());
 
         QMatrix4x4 projectionMatrix;
@@ -889,10 +1058,17 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
             vbo->draw(GL_TRIANGLES, 0, 6);
         }
+        GLFramebuffer::popFramebuffer();
 
         ShaderManager::instance()->popShader();
     }
 
+    if (!reuseBlur) {
+        // The blurred background can only be reused if it was computed from the whole background.
+        renderInfo.blurValid = (QRegion(QRect(QPoint(0, 0), backgroundRect.size())) - renderInfo.fetchedRegion).isEmpty();
+        renderInfo.backgroundDamaged = false;
+    }
+
     // When a window animates between opacities 0 and 1, we would like the
     // mix between the contrast effect and the transparent to change
     // linearly with the given opacity. This ensures that the animation set
@@ -942,7 +1118,6 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
         const QMatrix4x4 colorMatrix = BlurEffect::colorMatrix(blurInfo.contrast, blurInfo.saturation);
 
-        GLFramebuffer::popFramebuffer();
         const auto &read = renderInfo.framebuffers[1];
 
         const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
@@ -984,7 +1159,6 @@ void BlurEffect::blur(const RenderTarget &renderTarget, const RenderViewport &vi
 
         QMatrix4x4 colorMatrix = BlurEffect::colorMatrix(blurInfo.contrast, blurInfo.saturation);
 
-        GLFramebuffer::popFramebuffer();
         const auto &read = renderInfo.framebuffers[1];
 
         const QVector2D halfpixel(0.5 / read->colorAttachment()->width(),
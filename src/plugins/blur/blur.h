@@ -13,6 +13,7 @@
 
 #include <QList>
 
+#include <map>
 #include <unordered_map>
 
 namespace KWin
@@ -27,6 +28,17 @@ struct BlurRenderData
     /// contains not blurred background behind the window, it's cached.
     std::vector<std::unique_ptr<GLTexture>> textures;
     std::vector<std::unique_ptr<GLFramebuffer>> framebuffers;
+
+    /// The part of the first texture that has been fetched from the screen, in logical pixels
+    /// relative to the background rect
+    QRegion fetchedRegion;
+    /// The background rect the textures were filled for
+    QRect backgroundRect;
+    /// Whether the second texture contains the blurred background, which can be reused as
+    /// long as nothing behind the window changes
+    bool blurValid = false;
+    /// Whether anything behind the blurred area has changed since the blur has been computed
+    bool backgroundDamaged = true;
 };
 
 struct BlurEffectData
@@ -52,6 +64,7 @@ struct BlurEffectData
 class BlurEffect : public KWin::Effect
 {
     Q_OBJECT
+    Q_PROPERTY(quint64 computeDispatchCount READ computeDispatchCount)
 
 public:
     BlurEffect();
@@ -77,6 +90,11 @@ public:
 
     bool blocksDirectScanout() const override;
 
+    /**
+     * The number of compute passes that have been dispatched, for tests and debugging.
+     */
+    quint64 computeDispatchCount() const;
+
 public Q_SLOTS:
     void slotWindowAdded(KWin::EffectWindow *w);
     void slotWindowDeleted(KWin::EffectWindow *w);
@@ -97,6 +115,22 @@ private:
     void blur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &deviceRegion, WindowPaintData &data);
     GLTexture *ensureNoiseTexture();
 
+    struct ComputePass
+    {
+        std::unique_ptr<GLShader> shader;
+        int offsetLocation = -1;
+        int halfpixelLocation = -1;
+    };
+
+    struct ComputePasses
+    {
+        ComputePass downsample;
+        ComputePass upsample;
+    };
+
+    ComputePasses *computePasses(GLenum textureFormat);
+    void dispatchComputePass(const ComputePass &pass, GLTexture *read, GLTexture *draw);
+
 private:
     struct
     {
@@ -146,12 +180,20 @@ private:
         int noiseTextureStength = 0;
     } m_noisePass;
 
+    // The down- and upsample passes as compute shaders, they write the offscreen textures
+    // directly without going through the rasterizer. The image format is part of the shader,
+    // so they are loaded lazily per texture format.
+    std::map<GLenum, ComputePasses> m_computePasses;
+    bool m_computeEnabled = false;
+    quint64 m_computeDispatchCount = 0;
+
     bool m_valid = false;
 #if KWIN_BUILD_X11
     long net_wm_blur_region = 0;
 #endif
     QRegion m_paintedDeviceArea; // keeps track of all painted areas (from bottom to top)
     QRegion m_currentDeviceBlur; // keeps track of currently blurred area of the windows (from bottom to top)
+    QRegion m_damagedDeviceArea; // keeps track of areas whose contents changed in this frame (from bottom to top)
     RenderView *m_currentView = nullptr;
 
     size_t m_iterationCount; // number of times the texture will be downsized to half size
@@ -50,6 +50,9 @@ GlideEffect::GlideEffect()
     connect(effects, &EffectsHandler::windowAdded, this, &GlideEffect::windowAdded);
     connect(effects, &EffectsHandler::windowClosed, this, &GlideEffect::windowClosed);
     connect(effects, &EffectsHandler::windowDataChanged, this, &GlideEffect::windowDataChanged);
+
+    // windows are redirected only while they glide in or out, skip the paint hooks for the rest
+    effects->setWindowFilteringEnabled(this, true);
 }
 
 GlideEffect::~GlideEffect() = default;
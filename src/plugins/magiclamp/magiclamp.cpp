@@ -32,6 +32,9 @@ MagicLampEffect::MagicLampEffect()
     }
 
     setVertexSnappingMode(RenderGeometry::VertexSnappingMode::None);
+
+    // only windows that are being minimized or unminimized need to be painted by the effect
+    effects->setWindowFilteringEnabled(this, true);
 }
 
 bool MagicLampEffect::supported()
@@ -10,6 +10,9 @@
 #include "core/shmgraphicsbufferallocator.h"
 #include "opengl/eglbackend.h"
 #include "opengl/glframebuffer.h"
+#include "screencastreadback.h"
+
+#include <drm_fourcc.h>
 
 namespace KWin
 {
@@ -110,12 +113,21 @@ DmaBufScreenCastBuffer *DmaBufScreenCastBuffer::create(pw_buffer *pwBuffer, cons
     return new DmaBufScreenCastBuffer(buffer, std::move(texture), std::move(framebuffer), std::move(synctimeline));
 }
 
-MemFdScreenCastBuffer::MemFdScreenCastBuffer(GraphicsBuffer *buffer, GraphicsBufferView &&view)
+MemFdScreenCastBuffer::MemFdScreenCastBuffer(GraphicsBuffer *buffer, std::unique_ptr<ScreenCastReadback> &&readback, std::unique_ptr<GraphicsBufferView> &&view)
     : ScreenCastBuffer(buffer)
+    , readback(std::move(readback))
     , view(std::move(view))
 {
 }
 
+MemFdScreenCastBuffer::~MemFdScreenCastBuffer()
+{
+    if (readback) {
+        readback.reset();
+        m_buffer->unmap();
+    }
+}
+
 MemFdScreenCastBuffer *MemFdScreenCastBuffer::create(pw_buffer *pwBuffer, const GraphicsBufferOptions &options)
 {
     GraphicsBuffer *buffer = ShmGraphicsBufferAllocator().allocate(options);
@@ -123,19 +135,42 @@ MemFdScreenCastBuffer *MemFdScreenCastBuffer::create(pw_buffer *pwBuffer, const
         return nullptr;
     }
 
-    GraphicsBufferView view(buffer, GraphicsBuffer::Read | GraphicsBuffer::Write);
-    if (view.isNull()) {
-        buffer->drop();
-        return nullptr;
+    const ShmAttributes *attributes = buffer->shmAttributes();
+    const int rows = attributes->format == DRM_FORMAT_NV12 ? SPA_ROUND_UP_N(attributes->size.height(), 2) * 3 / 2 : attributes->size.height();
+
+    std::unique_ptr<ScreenCastReadback> readback;
+    if (EglBackend *backend = qobject_cast<EglBackend *>(Compositor::self()->backend())) {
+        backend->openglContext()->makeCurrent();
+        if (ScreenCastReadback::isSupported(backend->openglContext(), attributes->format)) {
+            const auto [data, stride] = buffer->map(GraphicsBuffer::Read | GraphicsBuffer::Write);
+            if (data) {
+                readback = ScreenCastReadback::create(backend->openglContext(), attributes->size, attributes->format, static_cast<uchar *>(data), stride);
+                if (!readback) {
+                    buffer->unmap();
+                }
+            }
+        }
     }
 
-    const ShmAttributes *attributes = buffer->shmAttributes();
+    std::unique_ptr<GraphicsBufferView> view;
+    if (!readback) {
+        // the frame can be only converted to YUV on the GPU
+        if (attributes->format == DRM_FORMAT_NV12) {
+            buffer->drop();
+            return nullptr;
+        }
+        view = std::make_unique<GraphicsBufferView>(buffer, GraphicsBuffer::Read | GraphicsBuffer::Write);
+        if (view->isNull()) {
+            buffer->drop();
+            return nullptr;
+        }
+    }
 
     struct spa_data *spaData = pwBuffer->buffer->datas;
     spaData->type = SPA_DATA_MemFd;
     spaData->flags = SPA_DATA_FLAG_READWRITE;
     spaData->mapoffset = 0;
-    spaData->maxsize = attributes->stride * attributes->size.height();
+    spaData->maxsize = attributes->stride * rows;
     spaData->fd = attributes->fd.get();
     spaData->data = nullptr;
     spaData->chunk->offset = 0;
@@ -143,7 +178,7 @@ MemFdScreenCastBuffer *MemFdScreenCastBuffer::create(pw_buffer *pwBuffer, const
     spaData->chunk->stride = attributes->stride;
     spaData->chunk->flags = SPA_CHUNK_FLAG_NONE;
 
-    return new MemFdScreenCastBuffer(buffer, std::move(view));
+    return new MemFdScreenCastBuffer(buffer, std::move(readback), std::move(view));
 }
 
 } // namespace KWin
@@ -17,6 +17,7 @@ namespace KWin
 class GLFramebuffer;
 class GLTexture;
 class GraphicsBuffer;
+class ScreenCastReadback;
 struct GraphicsBufferOptions;
 
 class ScreenCastBuffer
@@ -27,7 +28,7 @@ public:
 
     int m_age = 0;
 
-private:
+protected:
     GraphicsBuffer *m_buffer;
 };
 
@@ -48,11 +49,15 @@ class MemFdScreenCastBuffer : public ScreenCastBuffer
 {
 public:
     static MemFdScreenCastBuffer *create(pw_buffer *pwBuffer, const GraphicsBufferOptions &options);
+    ~MemFdScreenCastBuffer() override;
 
-    GraphicsBufferView view;
+    /// Downloads the frames asynchronously, if supported
+    std::unique_ptr<ScreenCastReadback> readback;
+    /// Used to download the frames synchronously otherwise
+    std::unique_ptr<GraphicsBufferView> view;
 
 private:
-    MemFdScreenCastBuffer(GraphicsBuffer *buffer, GraphicsBufferView &&view);
+    MemFdScreenCastBuffer(GraphicsBuffer *buffer, std::unique_ptr<ScreenCastReadback> &&readback, std::unique_ptr<GraphicsBufferView> &&view);
 };
 
 } // namespace KWin
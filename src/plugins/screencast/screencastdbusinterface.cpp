@@ -0,0 +1,68 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "screencastdbusinterface.h"
+#include "screencastmanager.h"
+#include "screencaststream.h"
+
+#include <QDBusConnection>
+
+namespace KWin
+{
+
+static const QString s_dbusObjectPath = QStringLiteral("/org/kde/KWin/ScreenCast");
+
+ScreenCastDBusInterface::ScreenCastDBusInterface(ScreencastManager *parent)
+    : QObject(parent)
+    , m_manager(parent)
+{
+    QDBusConnection::sessionBus().registerObject(s_dbusObjectPath, this, QDBusConnection::ExportAllSlots);
+}
+
+ScreenCastDBusInterface::~ScreenCastDBusInterface()
+{
+    QDBusConnection::sessionBus().unregisterObject(s_dbusObjectPath);
+}
+
+QList<uint> ScreenCastDBusInterface::streams() const
+{
+    QList<uint> nodeIds;
+    const auto streams = m_manager->findChildren<ScreenCastStream *>(Qt::FindDirectChildrenOnly);
+    for (ScreenCastStream *stream : streams) {
+        if (stream->nodeId()) {
+            nodeIds.append(stream->nodeId());
+        }
+    }
+    return nodeIds;
+}
+
+QVariantMap ScreenCastDBusInterface::streamStatistics(uint nodeId) const
+{
+    const auto streams = m_manager->findChildren<ScreenCastStream *>(Qt::FindDirectChildrenOnly);
+    for (ScreenCastStream *stream : streams) {
+        if (stream->nodeId() != nodeId) {
+            continue;
+        }
+
+        const ScreenCastStreamStatistics &statistics = stream->statistics();
+        const auto averageReadbackTime = statistics.readbackCount ? statistics.readbackTime / statistics.readbackCount : std::chrono::nanoseconds::zero();
+        return QVariantMap{
+            {QStringLiteral("name"), stream->objectName()},
+            {QStringLiteral("framesProduced"), statistics.framesProduced},
+            {QStringLiteral("framesDropped"), statistics.framesDropped},
+            {QStringLiteral("framesCoalesced"), statistics.framesCoalesced},
+            {QStringLiteral("framesSkipped"), statistics.framesSkipped},
+            {QStringLiteral("readbackCount"), statistics.readbackCount},
+            {QStringLiteral("averageReadbackTime"), qint64(std::chrono::duration_cast<std::chrono::microseconds>(averageReadbackTime).count())},
+            {QStringLiteral("maxReadbackTime"), qint64(std::chrono::duration_cast<std::chrono::microseconds>(statistics.maxReadbackTime).count())},
+        };
+    }
+    return QVariantMap();
+}
+
+} // namespace KWin
+
+#include "moc_screencastdbusinterface.cpp"
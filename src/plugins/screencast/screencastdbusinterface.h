@@ -0,0 +1,45 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+
+namespace KWin
+{
+
+class ScreencastManager;
+
+/**
+ * Exposes statistics about the running screencast streams, e.g. to diagnose remote desktop
+ * sessions that stutter or use too much CPU.
+ */
+class ScreenCastDBusInterface : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.KWin.ScreenCast")
+
+public:
+    explicit ScreenCastDBusInterface(ScreencastManager *parent);
+    ~ScreenCastDBusInterface() override;
+
+public Q_SLOTS:
+    /**
+     * Returns the PipeWire node ids of all streams.
+     */
+    QList<uint> streams() const;
+    /**
+     * Returns the statistics of the stream with the specified PipeWire @a nodeId, or an empty
+     * map if there is no such stream. Times are in microseconds.
+     */
+    QVariantMap streamStatistics(uint nodeId) const;
+
+private:
+    ScreencastManager *m_manager;
+};
+
+} // namespace KWin
@@ -14,6 +14,7 @@
 #include "outputscreencastsource.h"
 #include "pipewirecore.h"
 #include "regionscreencastsource.h"
+#include "screencastdbusinterface.h"
 #include "screencaststream.h"
 #include "wayland/display.h"
 #include "wayland/output.h"
@@ -31,6 +32,7 @@ ScreencastManager::ScreencastManager()
     : m_screencast(new ScreencastV1Interface(waylandServer()->display(), this))
 {
     getPipewireConnection();
+    new ScreenCastDBusInterface(this);
 
     connect(m_screencast, &ScreencastV1Interface::windowScreencastRequested, this, &ScreencastManager::streamWindow);
     connect(m_screencast, &ScreencastV1Interface::outputScreencastRequested, this, &ScreencastManager::streamWaylandOutput);
@@ -0,0 +1,309 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "screencastreadback.h"
+#include "compositor.h"
+#include "effect/globals.h"
+#include "kwinscreencast_logging.h"
+#include "opengl/eglbackend.h"
+#include "opengl/eglcontext.h"
+#include "opengl/eglnativefence.h"
+#include "opengl/glframebuffer.h"
+#include "opengl/glshader.h"
+#include "opengl/glshadermanager.h"
+#include "opengl/gltexture.h"
+#include "utils/envvar.h"
+
+#include <QMatrix4x4>
+#include <QSocketNotifier>
+#include <QVector2D>
+
+#include <cstring>
+#include <drm_fourcc.h>
+
+namespace KWin
+{
+
+static const bool s_partialReadback = environmentVariableBoolValue("KWIN_SCREENCAST_PARTIAL_READBACK").value_or(true);
+
+// Above this, it's cheaper to download the bounding rect than to issue many small copies
+static const int s_maxReadbackRects = 16;
+
+// The chroma plane starts at an even row, the luma plane of a frame with an odd height is padded.
+static int nv12LumaRows(int height)
+{
+    return (height + 1) & ~1;
+}
+
+static EglContext *currentBackendContext()
+{
+    EglBackend *backend = qobject_cast<EglBackend *>(Compositor::self()->backend());
+    if (!backend || !backend->openglContext()) {
+        return nullptr;
+    }
+    backend->openglContext()->makeCurrent();
+    return backend->openglContext();
+}
+
+ScreenCastReadback::ScreenCastReadback(const QSize &size, uint32_t format, uchar *data, int stride, bool flip, bool swapRedBlue)
+    : m_size(size)
+    , m_format(format)
+    , m_data(data)
+    , m_stride(stride)
+    , m_flip(flip)
+    , m_swapRedBlue(swapRedBlue)
+{
+}
+
+ScreenCastReadback::~ScreenCastReadback()
+{
+    if (!currentBackendContext()) {
+        return;
+    }
+    if (m_pixelBuffer) {
+        glDeleteBuffers(1, &m_pixelBuffer);
+    }
+}
+
+bool ScreenCastReadback::isSupported(EglContext *context, uint32_t format)
+{
+    // pixel buffer objects need OpenGL ES 3.0
+    if (context->isOpenGLES() && !context->hasVersion(Version(3, 0))) {
+        return false;
+    }
+    if (!context->hasMapBufferRange()) {
+        return false;
+    }
+
+    switch (format) {
+    case DRM_FORMAT_ARGB8888:
+    case DRM_FORMAT_XRGB8888:
+    case DRM_FORMAT_NV12:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::unique_ptr<ScreenCastReadback> ScreenCastReadback::create(EglContext *context, const QSize &size, uint32_t format, uchar *data, int stride)
+{
+    if (!isSupported(context, format)) {
+        return nullptr;
+    }
+
+    // The texture is rendered top to bottom, but OpenGL ES reads it back the other way around,
+    // see doGrabTexture(). OpenGL ES can only read back BGRA with GL_EXT_read_format_bgra,
+    // otherwise the red and blue channels are swapped while copying the pixels.
+    const bool swapRedBlue = format != DRM_FORMAT_NV12 && context->isOpenGLES() && !context->hasOpenglExtension(QByteArrayLiteral("GL_EXT_read_format_bgra"));
+    std::unique_ptr<ScreenCastReadback> readback(new ScreenCastReadback(size, format, data, stride, context->isOpenGLES(), swapRedBlue));
+
+    readback->m_texture = GLTexture::allocate(GL_RGBA8, size);
+    if (!readback->m_texture) {
+        return nullptr;
+    }
+    readback->m_texture->setContentTransform(OutputTransform::FlipY);
+    readback->m_texture->setFilter(GL_LINEAR);
+    readback->m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    readback->m_framebuffer = std::make_unique<GLFramebuffer>(readback->m_texture.get());
+    if (!readback->m_framebuffer->valid()) {
+        return nullptr;
+    }
+
+    QSize readbackSize = size;
+    if (format == DRM_FORMAT_NV12) {
+        readback->m_conversionShader = ShaderManager::instance()->generateShaderFromFile(ShaderTrait::MapTexture, QString(), QStringLiteral(":/screencast/shaders/rgbtonv12.frag"));
+        if (!readback->m_conversionShader || !readback->m_conversionShader->isValid()) {
+            qCWarning(KWIN_SCREENCAST) << "Failed to load the NV12 conversion shader";
+            return nullptr;
+        }
+        readback->m_sourceSizeLocation = readback->m_conversionShader->uniformLocation("sourceSize");
+        readback->m_flipLocation = readback->m_conversionShader->uniformLocation("flip");
+        readback->m_lumaHeightLocation = readback->m_conversionShader->uniformLocation("lumaHeight");
+
+        // every texel packs four bytes, the chroma plane has half as many rows as the luma plane
+        const int lumaRows = nv12LumaRows(size.height());
+        readbackSize = QSize(stride / 4, lumaRows + lumaRows / 2);
+        readback->m_convertedTexture = GLTexture::allocate(GL_RGBA8, readbackSize);
+        if (!readback->m_convertedTexture) {
+            return nullptr;
+        }
+        readback->m_convertedFramebuffer = std::make_unique<GLFramebuffer>(readback->m_convertedTexture.get());
+        if (!readback->m_convertedFramebuffer->valid()) {
+            return nullptr;
+        }
+    }
+
+    glGenBuffers(1, &readback->m_pixelBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->m_pixelBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, readbackSize.width() * readbackSize.height() * 4, nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return readback;
+}
+
+GLFramebuffer *ScreenCastReadback::framebuffer() const
+{
+    return m_framebuffer.get();
+}
+
+bool ScreenCastReadback::isPending() const
+{
+    return m_pending;
+}
+
+std::chrono::nanoseconds ScreenCastReadback::duration() const
+{
+    return m_duration;
+}
+
+void ScreenCastReadback::convert()
+{
+    const QSize size = m_convertedTexture->size();
+
+    ShaderBinder binder(m_conversionShader.get());
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.ortho(QRect(QPoint(), size));
+    m_conversionShader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, projectionMatrix);
+    m_conversionShader->setUniform(m_sourceSizeLocation, QVector2D(m_size.width(), m_size.height()));
+    m_conversionShader->setUniform(m_flipLocation, m_flip ? 1 : 0);
+    m_conversionShader->setUniform(m_lumaHeightLocation, float(nv12LumaRows(m_size.height())));
+
+    GLFramebuffer::pushFramebuffer(m_convertedFramebuffer.get());
+    m_texture->render(size);
+    GLFramebuffer::popFramebuffer();
+}
+
+QSize ScreenCastReadback::readbackSize() const
+{
+    return (m_format == DRM_FORMAT_NV12 ? m_convertedTexture : m_texture)->size();
+}
+
+QList<QRect> ScreenCastReadback::readbackRects(const QRegion &region, const QSize &size, uint32_t format)
+{
+    const QRect frameRect(QPoint(0, 0), size);
+    QRegion damage = region & frameRect;
+    if (damage.rectCount() > s_maxReadbackRects) {
+        damage = damage.boundingRect();
+    }
+
+    if (format != DRM_FORMAT_NV12) {
+        return QList<QRect>(damage.begin(), damage.end());
+    }
+
+    // every texel holds four luma samples, or the chroma samples of a 4x2 block
+    const int lumaRows = nv12LumaRows(size.height());
+    QRegion texels;
+    for (const QRect &rect : damage) {
+        const int left = rect.x() / 4;
+        const int right = rect.right() / 4;
+        texels += QRect(QPoint(left, rect.y()), QPoint(right, rect.bottom()));
+        texels += QRect(QPoint(left, lumaRows + rect.y() / 2), QPoint(right, lumaRows + rect.bottom() / 2));
+    }
+    return QList<QRect>(texels.begin(), texels.end());
+}
+
+bool ScreenCastReadback::start(const QRegion &region)
+{
+    EglContext *context = currentBackendContext();
+    if (!context) {
+        return false;
+    }
+
+    GLFramebuffer *source = m_framebuffer.get();
+    GLenum format = m_swapRedBlue ? GL_RGBA : GL_BGRA;
+    if (m_format == DRM_FORMAT_NV12) {
+        convert();
+        source = m_convertedFramebuffer.get();
+        format = GL_RGBA;
+    }
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_rects = readbackRects(s_partialReadback ? region : QRegion(infiniteRegion()), m_size, m_format);
+
+    // the conversion pass already takes care of the orientation
+    const bool flip = m_flip && m_format != DRM_FORMAT_NV12;
+    const QSize size = source->size();
+
+    // The damaged rects are stored at the same place as in a full readback
+    GLFramebuffer::pushFramebuffer(source);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+    glPixelStorei(GL_PACK_ROW_LENGTH, size.width());
+    for (const QRect &rect : std::as_const(m_rects)) {
+        const int row = flip ? size.height() - rect.y() - rect.height() : rect.y();
+        const intptr_t offset = (intptr_t(row) * size.width() + rect.x()) * 4;
+        glReadPixels(rect.x(), row, rect.width(), rect.height(), format, GL_UNSIGNED_BYTE, reinterpret_cast<void *>(offset));
+    }
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    GLFramebuffer::popFramebuffer();
+
+    m_pending = true;
+    m_fenceNotifier.reset();
+
+    EGLNativeFence fence(context->displayObject());
+    if (!fence.isValid()) {
+        // without a fence to wait for, mapping the pixel buffer blocks until the copy is done
+        return finish();
+    }
+
+    m_fence = fence.takeFileDescriptor();
+    m_fenceNotifier = std::make_unique<QSocketNotifier>(m_fence.get(), QSocketNotifier::Read);
+    connect(m_fenceNotifier.get(), &QSocketNotifier::activated, this, [this]() {
+        m_fenceNotifier->setEnabled(false);
+        finish();
+    });
+    return true;
+}
+
+bool ScreenCastReadback::finish()
+{
+    m_fence = FileDescriptor();
+    m_pending = false;
+
+    if (!currentBackendContext()) {
+        qCWarning(KWIN_SCREENCAST) << "Lost the OpenGL context while downloading a screencast frame";
+        Q_EMIT finished(false);
+        return false;
+    }
+
+    const QSize size = readbackSize();
+    const int rowSize = size.width() * 4;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+    const auto pixels = static_cast<const uchar *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowSize * size.height(), GL_MAP_READ_BIT));
+    if (pixels) {
+        const bool flip = m_flip && m_format != DRM_FORMAT_NV12;
+        for (const QRect &rect : std::as_const(m_rects)) {
+            for (int y = rect.y(); y <= rect.bottom(); ++y) {
+                const int sourceRow = flip ? size.height() - y - 1 : y;
+                uchar *destination = m_data + y * m_stride + rect.x() * 4;
+                const uchar *source = pixels + sourceRow * rowSize + rect.x() * 4;
+                if (m_swapRedBlue) {
+                    for (int x = 0; x < rect.width() * 4; x += 4) {
+                        destination[x] = source[x + 2];
+                        destination[x + 1] = source[x + 1];
+                        destination[x + 2] = source[x];
+                        destination[x + 3] = source[x + 3];
+                    }
+                } else {
+                    std::memcpy(destination, source, rect.width() * 4);
+                }
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        qCWarning(KWIN_SCREENCAST) << "Failed to map the screencast pixel buffer";
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_duration = std::chrono::steady_clock::now() - m_startTime;
+    Q_EMIT finished(pixels != nullptr);
+    return pixels != nullptr;
+}
+
+} // namespace KWin
+
+#include "moc_screencastreadback.cpp"
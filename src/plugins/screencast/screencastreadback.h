@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "utils/filedescriptor.h"
+
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QSize>
+
+#include <chrono>
+#include <epoxy/gl.h>
+#include <memory>
+
+class QSocketNotifier;
+
+namespace KWin
+{
+
+class EglContext;
+class GLFramebuffer;
+class GLShader;
+class GLTexture;
+
+/**
+ * Downloads the frames of a memfd screencast buffer without stalling the compositor.
+ *
+ * The frame is rendered into framebuffer(), optionally converted to NV12 on the GPU, and copied
+ * into a pixel buffer object. The pixel buffer is mapped only after a fence signals that the GPU
+ * has finished the copy, the memfd buffer must not be queued before that.
+ */
+class ScreenCastReadback : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~ScreenCastReadback() override;
+
+    static bool isSupported(EglContext *context, uint32_t format);
+    static std::unique_ptr<ScreenCastReadback> create(EglContext *context, const QSize &size, uint32_t format, uchar *data, int stride);
+
+    GLFramebuffer *framebuffer() const;
+
+    /**
+     * Starts copying the contents of the framebuffer into the memfd buffer. If the copy doesn't
+     * finish immediately, isPending() returns @c true until finished() is emitted.
+     *
+     * Only the @a region (in device pixels) is copied, the rest of the memfd buffer is assumed
+     * to be up to date. Pass infiniteRegion() if the contents of the memfd buffer are unknown.
+     *
+     * Returns @c false if the memfd buffer couldn't be updated, its contents are unknown then.
+     */
+    bool start(const QRegion &region);
+    bool isPending() const;
+
+    /**
+     * Returns how long the last download took, from start() until the data was in the memfd buffer.
+     */
+    std::chrono::nanoseconds duration() const;
+
+    /**
+     * Returns the rects of the pixel buffer that have to be downloaded to update the @a region
+     * of a frame with the specified @a size and @a format. For NV12, they are in units of the
+     * converted texture, where every texel holds four bytes.
+     */
+    static QList<QRect> readbackRects(const QRegion &region, const QSize &size, uint32_t format);
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when a pending download is done. If @a success is @c false, the
+     * contents of the memfd buffer are unknown.
+     */
+    void finished(bool success);
+
+private:
+    ScreenCastReadback(const QSize &size, uint32_t format, uchar *data, int stride, bool flip, bool swapRedBlue);
+    QSize readbackSize() const;
+    void convert();
+    bool finish();
+
+    const QSize m_size;
+    const uint32_t m_format;
+    uchar *const m_data;
+    const int m_stride;
+    const bool m_flip;
+    const bool m_swapRedBlue;
+
+    std::unique_ptr<GLTexture> m_texture;
+    std::unique_ptr<GLFramebuffer> m_framebuffer;
+
+    std::unique_ptr<GLShader> m_conversionShader;
+    int m_sourceSizeLocation = -1;
+    int m_flipLocation = -1;
+    int m_lumaHeightLocation = -1;
+    std::unique_ptr<GLTexture> m_convertedTexture;
+    std::unique_ptr<GLFramebuffer> m_convertedFramebuffer;
+
+    GLuint m_pixelBuffer = 0;
+    QList<QRect> m_rects; // in the pixel buffer, top to bottom
+    FileDescriptor m_fence;
+    std::unique_ptr<QSocketNotifier> m_fenceNotifier;
+    bool m_pending = false;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::nanoseconds m_duration{0};
+};
+
+} // namespace KWin
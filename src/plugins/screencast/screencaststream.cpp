@@ -22,6 +22,7 @@
 #include "pipewirecore.h"
 #include "scene/workspacescene.h"
 #include "screencastbuffer.h"
+#include "screencastreadback.h"
 #include "screencastsource.h"
 #include "utils/drm_format_helper.h"
 
@@ -153,7 +154,15 @@ void ScreenCastStream::newStreamParams()
     qCDebug(KWIN_SCREENCAST) << objectName() << "announcing stream params. with dmabuf:" << m_dmabufParams.has_value();
     const int buffertypes = m_dmabufParams ? (1 << SPA_DATA_DmaBuf) : (1 << SPA_DATA_MemFd);
     const int bpp = m_videoFormat.format == SPA_VIDEO_FORMAT_RGB || m_videoFormat.format == SPA_VIDEO_FORMAT_BGR ? 3 : 4;
-    const int stride = SPA_ROUND_UP_N(m_resolution.width() * bpp, 4);
+    int stride = SPA_ROUND_UP_N(m_resolution.width() * bpp, 4);
+    int size = stride * m_resolution.height();
+    if (m_videoFormat.format == SPA_VIDEO_FORMAT_NV12) {
+        // the luma plane is followed by the interleaved chroma plane with half as many rows,
+        // the chroma plane starts at an even row
+        const int lumaRows = SPA_ROUND_UP_N(m_resolution.height(), 2);
+        stride = SPA_ROUND_UP_N(m_resolution.width(), 4);
+        size = stride * (lumaRows + lumaRows / 2);
+    }
 
     struct spa_pod_dynamic_builder pod_builder;
     struct spa_pod_frame f;
@@ -182,7 +191,7 @@ void ScreenCastStream::newStreamParams()
     if (!m_dmabufParams) {
         spa_pod_builder_add(&pod_builder.b,
                             SPA_PARAM_BUFFERS_blocks, SPA_POD_Int(1),
-                            SPA_PARAM_BUFFERS_size, SPA_POD_Int(stride * m_resolution.height()),
+                            SPA_PARAM_BUFFERS_size, SPA_POD_Int(size),
                             SPA_PARAM_BUFFERS_stride, SPA_POD_Int(stride),
                             SPA_PARAM_BUFFERS_align, SPA_POD_Int(16), 0);
     } else {
@@ -303,6 +312,12 @@ void ScreenCastStream::onStreamAddBuffer(pw_buffer *pwBuffer)
                                                                  })) {
             pwBuffer->user_data = memfd;
             m_allBuffers.push_back(memfd);
+            if (memfd->readback) {
+                ScreenCastReadback *readback = memfd->readback.get();
+                connect(readback, &ScreenCastReadback::finished, this, [this, readback](bool success) {
+                    handleReadbackFinished(readback, success);
+                });
+            }
             return;
         }
     }
@@ -317,6 +332,7 @@ void ScreenCastStream::onStreamRemoveBuffer(pw_buffer *pwBuffer)
     }
 
     m_dequeuedBuffers.removeOne(pwBuffer);
+    m_pendingReadbacks.removeOne(pwBuffer);
 }
 
 ScreenCastStream::ScreenCastStream(ScreenCastSource *source, std::shared_ptr<PipeWireCore> pwCore, QObject *parent)
@@ -349,6 +365,7 @@ ScreenCastStream::ScreenCastStream(ScreenCastSource *source, std::shared_ptr<Pip
     };
 
     m_pendingFrame.setSingleShot(true);
+    m_pendingFrame.setTimerType(Qt::PreciseTimer);
     connect(&m_pendingFrame, &QTimer::timeout, this, [this] {
         record(m_pendingContents);
         m_pendingContents = Contents();
@@ -426,6 +443,10 @@ bool ScreenCastStream::createStream()
         m_modifiers = *itModifiers;
     }
     m_hasDmaBuf = testCreateDmaBuf(m_resolution, m_drmFormat, m_modifiers).has_value();
+    if (EglBackend *backend = qobject_cast<EglBackend *>(Compositor::self()->backend())) {
+        backend->openglContext()->makeCurrent();
+        m_canConvertToNV12 = ScreenCastReadback::isSupported(backend->openglContext(), DRM_FORMAT_NV12);
+    }
 
     char buffer[2048];
     QList<const spa_pod *> params = buildFormats(false, buffer);
@@ -502,18 +523,24 @@ void ScreenCastStream::scheduleRecord(Contents contents)
     m_pendingContents |= contents;
 
     if (m_pendingFrame.isActive()) {
+        // the scheduled frame will pick up this change as well
+        m_statistics.framesCoalesced++;
         return;
     }
-    std::chrono::milliseconds waitInterval{0};
+    std::chrono::nanoseconds waitInterval{0};
     if (m_videoFormat.max_framerate.num != 0 && m_lastSent.has_value()) {
         const auto now = std::chrono::steady_clock::now();
-        const auto frameInterval = std::chrono::milliseconds(1000 * m_videoFormat.max_framerate.denom / m_videoFormat.max_framerate.num);
-        const auto lastSentAgo = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastSent.value());
-        if (lastSentAgo < frameInterval) {
-            waitInterval = frameInterval - lastSentAgo;
+        const auto nextFrame = m_lastSent.value() + frameInterval();
+        if (now < nextFrame) {
+            waitInterval = nextFrame - now;
         }
     }
-    m_pendingFrame.start(waitInterval);
+    m_pendingFrame.start(std::chrono::ceil<std::chrono::milliseconds>(waitInterval));
+}
+
+std::chrono::nanoseconds ScreenCastStream::frameInterval() const
+{
+    return std::chrono::nanoseconds(1'000'000'000ll * m_videoFormat.max_framerate.denom / m_videoFormat.max_framerate.num);
 }
 
 pw_buffer *ScreenCastStream::dequeueBuffer()
@@ -576,6 +603,7 @@ void ScreenCastStream::record(Contents contents)
 
     struct pw_buffer *pwBuffer = dequeueBuffer();
     if (!pwBuffer) {
+        m_statistics.framesDropped++;
         return;
     }
 
@@ -608,10 +636,16 @@ void ScreenCastStream::record(Contents contents)
     spa_meta_sync_timeline *synctmeta = nullptr;
 
     QRegion damage;
+    bool readbackFailed = false;
     if (effectiveContents & Content::Video) {
-        if (auto memfd = dynamic_cast<MemFdScreenCastBuffer *>(buffer)) {
-            damage = m_source->render(memfd->view.image(), m_damageJournal.accumulate(memfd->m_age, infiniteRegion()));
-            bumpBufferAge(memfd);
+        const QRegion bufferRepair = m_damageJournal.accumulate(buffer->m_age, infiniteRegion());
+        auto memfd = dynamic_cast<MemFdScreenCastBuffer *>(buffer);
+        if (memfd) {
+            if (memfd->readback) {
+                damage = m_source->render(memfd->readback->framebuffer(), bufferRepair);
+            } else {
+                damage = m_source->render(memfd->view->image(), bufferRepair);
+            }
         } else if (auto dmabuf = dynamic_cast<DmaBufScreenCastBuffer *>(buffer)) {
             if (dmabuf->synctimeline) {
                 synctmeta = static_cast<spa_meta_sync_timeline *>(spa_buffer_find_meta_data(spa_buffer,
@@ -624,10 +658,31 @@ void ScreenCastStream::record(Contents contents)
                 }
             }
 
-            damage = m_source->render(dmabuf->framebuffer.get(), m_damageJournal.accumulate(dmabuf->m_age, infiniteRegion()));
-            bumpBufferAge(dmabuf);
+            damage = m_source->render(dmabuf->framebuffer.get(), bufferRepair);
+        }
+
+        // Don't send a frame identical to the previous one. The buffer has been repaired, but
+        // its age is left as is, so the repaired region will be downloaded when it's used next.
+        if (damage.isEmpty() && m_statistics.framesProduced > 0) {
+            if (!(contents & Content::Cursor)) {
+                m_statistics.framesSkipped++;
+                m_dequeuedBuffers.append(pwBuffer);
+                return;
+            }
+            if (m_cursor.mode == ScreencastV1Interface::Metadata) {
+                // only the cursor has changed, which the cursor metadata takes care of
+                effectiveContents.setFlag(Content::Video, false);
+            }
+        }
+
+        if (effectiveContents & Content::Video) {
+            if (memfd && memfd->readback) {
+                // only what changed since this buffer was last rendered needs to be downloaded
+                readbackFailed = !memfd->readback->start(bufferRepair | damage);
+            }
+            bumpBufferAge(buffer);
+            m_damageJournal.add(damage);
         }
-        m_damageJournal.add(damage);
     }
 
     if (spa_data[0].type == SPA_DATA_DmaBuf) {
@@ -658,9 +713,28 @@ void ScreenCastStream::record(Contents contents)
         // in pipewire terms, corrupted means "do not look at the frame contents" and here they're empty.
         spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
     }
+    if (readbackFailed) {
+        corruptFrame(pwBuffer);
+    }
 
-    pw_stream_queue_buffer(m_pwStream, pwBuffer);
-    m_lastSent = std::chrono::steady_clock::now();
+    // The frames must be queued in order, so if an earlier frame is still being downloaded,
+    // this one has to wait as well
+    auto memfd = dynamic_cast<MemFdScreenCastBuffer *>(buffer);
+    if (!m_pendingReadbacks.isEmpty() || (memfd && memfd->readback && memfd->readback->isPending())) {
+        m_pendingReadbacks.append(pwBuffer);
+    } else {
+        pw_stream_queue_buffer(m_pwStream, pwBuffer);
+    }
+    m_statistics.framesProduced++;
+
+    // Keep a steady cadence, i.e. if the frame is only a bit late, don't delay the next one
+    const auto now = std::chrono::steady_clock::now();
+    if (m_videoFormat.max_framerate.num != 0 && m_lastSent.has_value()) {
+        const auto scheduled = m_lastSent.value() + frameInterval();
+        m_lastSent = (now >= scheduled && now - scheduled < frameInterval()) ? scheduled : now;
+    } else {
+        m_lastSent = now;
+    }
 
     resize(m_source->textureSize());
 }
@@ -676,6 +750,52 @@ void ScreenCastStream::bumpBufferAge(ScreenCastBuffer *renderedBuffer)
     }
 }
 
+void ScreenCastStream::queuePendingReadbacks()
+{
+    while (!m_pendingReadbacks.isEmpty()) {
+        pw_buffer *pwBuffer = m_pendingReadbacks.constFirst();
+        auto memfd = dynamic_cast<MemFdScreenCastBuffer *>(static_cast<ScreenCastBuffer *>(pwBuffer->user_data));
+        if (memfd && memfd->readback && memfd->readback->isPending()) {
+            break;
+        }
+        m_pendingReadbacks.removeFirst();
+        pw_stream_queue_buffer(m_pwStream, pwBuffer);
+    }
+}
+
+void ScreenCastStream::handleReadbackFinished(ScreenCastReadback *readback, bool success)
+{
+    if (success) {
+        m_statistics.readbackCount++;
+        m_statistics.readbackTime += readback->duration();
+        m_statistics.maxReadbackTime = std::max(m_statistics.maxReadbackTime, readback->duration());
+    } else {
+        // the frame still has to be queued, otherwise the stream stalls
+        for (pw_buffer *pwBuffer : std::as_const(m_pendingReadbacks)) {
+            auto memfd = dynamic_cast<MemFdScreenCastBuffer *>(static_cast<ScreenCastBuffer *>(pwBuffer->user_data));
+            if (memfd && memfd->readback.get() == readback) {
+                corruptFrame(pwBuffer);
+                break;
+            }
+        }
+    }
+
+    queuePendingReadbacks();
+}
+
+void ScreenCastStream::corruptFrame(pw_buffer *pwBuffer)
+{
+    // the contents of the buffer are unknown, it has to be rendered from scratch when it's used next
+    static_cast<ScreenCastBuffer *>(pwBuffer->user_data)->m_age = 0;
+    pwBuffer->buffer->datas[0].chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+    corruptHeader(pwBuffer->buffer);
+}
+
+const ScreenCastStreamStatistics &ScreenCastStream::statistics() const
+{
+    return m_statistics;
+}
+
 void ScreenCastStream::resize(const QSize &resolution)
 {
     if (m_resolution == resolution) {
@@ -759,6 +879,10 @@ QList<const spa_pod *> ScreenCastStream::buildFormats(bool fixate, char buffer[2
         params.append(buildFormat(&podBuilder, dmabufFormat, &resolution, &defFramerate, &minFramerate, &maxFramerate, m_modifiers, SPA_POD_PROP_FLAG_MANDATORY | SPA_POD_PROP_FLAG_DONT_FIXATE));
     }
     params.append(buildFormat(&podBuilder, shmFormat, &resolution, &defFramerate, &minFramerate, &maxFramerate, {}, 0));
+    if (m_canConvertToNV12) {
+        // offered after the RGB format, so only consumers that prefer YUV, e.g. video encoders, pick it
+        params.append(buildFormat(&podBuilder, SPA_VIDEO_FORMAT_NV12, &resolution, &defFramerate, &minFramerate, &maxFramerate, {}, 0));
+    }
     return params;
 }
 
@@ -785,6 +909,11 @@ spa_pod *ScreenCastStream::buildFormat(struct spa_pod_builder *b, enum spa_video
     } else if (format == SPA_VIDEO_FORMAT_RGBA) {
         /* announce equivalent format without alpha */
         spa_pod_builder_add(b, SPA_FORMAT_VIDEO_format, SPA_POD_CHOICE_ENUM_Id(3, format, format, SPA_VIDEO_FORMAT_RGBx), 0);
+    } else if (format == SPA_VIDEO_FORMAT_NV12) {
+        spa_pod_builder_add(b, SPA_FORMAT_VIDEO_format, SPA_POD_Id(format), 0);
+        /* matches the conversion done in ScreenCastReadback */
+        spa_pod_builder_add(b, SPA_FORMAT_VIDEO_colorMatrix, SPA_POD_Id(SPA_VIDEO_COLOR_MATRIX_BT709), 0);
+        spa_pod_builder_add(b, SPA_FORMAT_VIDEO_colorRange, SPA_POD_Id(SPA_VIDEO_COLOR_RANGE_16_235), 0);
     } else {
         spa_pod_builder_add(b, SPA_FORMAT_VIDEO_format, SPA_POD_Id(format), 0);
     }
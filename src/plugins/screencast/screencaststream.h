@@ -30,6 +30,7 @@ namespace KWin
 class Cursor;
 class PipeWireCore;
 class ScreenCastBuffer;
+class ScreenCastReadback;
 class ScreenCastSource;
 
 struct ScreenCastDmaBufTextureParams
@@ -42,6 +43,17 @@ struct ScreenCastDmaBufTextureParams
     bool supportsSyncObj = false;
 };
 
+struct ScreenCastStreamStatistics
+{
+    quint64 framesProduced = 0; // queued to PipeWire
+    quint64 framesDropped = 0; // no buffer was available
+    quint64 framesCoalesced = 0; // merged into an already scheduled frame
+    quint64 framesSkipped = 0; // identical to the previous frame
+    quint64 readbackCount = 0;
+    std::chrono::nanoseconds readbackTime{0}; // in total
+    std::chrono::nanoseconds maxReadbackTime{0};
+};
+
 class KWIN_EXPORT ScreenCastStream : public QObject
 {
     Q_OBJECT
@@ -71,6 +83,8 @@ public:
 
     void setCursorMode(ScreencastV1Interface::CursorMode mode);
 
+    const ScreenCastStreamStatistics &statistics() const;
+
 public Q_SLOTS:
     void invalidateCursor();
 
@@ -100,6 +114,10 @@ private:
     pw_buffer *dequeueBuffer();
     void record(Contents contents);
     void bumpBufferAge(ScreenCastBuffer *renderedBuffer);
+    void queuePendingReadbacks();
+    void handleReadbackFinished(ScreenCastReadback *readback, bool success);
+    void corruptFrame(pw_buffer *pwBuffer);
+    std::chrono::nanoseconds frameInterval() const;
 
     std::optional<ScreenCastDmaBufTextureParams> testCreateDmaBuf(const QSize &size, quint32 format, const QList<uint64_t> &modifiers);
 
@@ -131,15 +149,18 @@ private:
 
     quint64 m_sequential = 0;
     bool m_hasDmaBuf = false;
+    bool m_canConvertToNV12 = false;
     quint32 m_drmFormat = 0;
 
     std::optional<std::chrono::steady_clock::time_point> m_lastSent;
     QTimer m_pendingFrame;
     Contents m_pendingContents = Content::None;
     QList<pw_buffer *> m_dequeuedBuffers;
+    QList<pw_buffer *> m_pendingReadbacks; // in the order they have to be queued
 
     QList<ScreenCastBuffer *> m_allBuffers;
     DamageJournal m_damageJournal;
+    ScreenCastStreamStatistics m_statistics;
 };
 
 } // namespace KWin
@@ -0,0 +1,50 @@
+#version 140
+
+uniform sampler2D sampler;
+uniform vec2 sourceSize;
+uniform bool flip;
+uniform float lumaHeight;
+
+in vec2 texcoord0;
+
+out vec4 fragColor;
+
+// BT.709, limited range
+float luma(vec3 rgb)
+{
+    return 16.0 / 255.0 + dot(rgb, vec3(0.2126, 0.7152, 0.0722)) * 219.0 / 255.0;
+}
+
+vec2 chroma(vec3 rgb)
+{
+    return 128.0 / 255.0 + vec2(dot(rgb, vec3(-0.1146, -0.3854, 0.5)), dot(rgb, vec3(0.5, -0.4542, -0.0458))) * 224.0 / 255.0;
+}
+
+vec3 fetch(vec2 position)
+{
+    if (flip) {
+        position.y = sourceSize.y - position.y;
+    }
+    return texture(sampler, position / sourceSize).rgb;
+}
+
+void main(void)
+{
+    // every output texel holds four bytes of the NV12 buffer: four luma samples in the
+    // luma plane, or two interleaved chroma pairs in the chroma plane below it, the luma
+    // plane has an extra row if the height is odd
+    vec2 texel = floor(gl_FragCoord.xy);
+    float x = texel.x * 4.0;
+    if (texel.y < lumaHeight) {
+        float y = texel.y + 0.5;
+        fragColor = vec4(luma(fetch(vec2(x + 0.5, y))),
+                         luma(fetch(vec2(x + 1.5, y))),
+                         luma(fetch(vec2(x + 2.5, y))),
+                         luma(fetch(vec2(x + 3.5, y))));
+    } else {
+        // sampling between four pixels averages them
+        float y = (texel.y - lumaHeight) * 2.0 + 1.0;
+        fragColor = vec4(chroma(fetch(vec2(x + 1.0, y))),
+                         chroma(fetch(vec2(x + 3.0, y))));
+    }
+}
@@ -34,6 +34,9 @@ SheetEffect::SheetEffect()
 
     connect(effects, &EffectsHandler::windowAdded, this, &SheetEffect::slotWindowAdded);
     connect(effects, &EffectsHandler::windowClosed, this, &SheetEffect::slotWindowClosed);
+
+    // don't go through the effect for windows without a sheet animation
+    effects->setWindowFilteringEnabled(this, true);
 }
 
 void SheetEffect::reconfigure(ReconfigureFlags flags)
@@ -13,7 +13,9 @@
 
 #include "config-kwin.h"
 
+#include "compositor.h"
 #include "core/output.h"
+#include "core/renderloop.h"
 #include "cursorsource.h"
 #include "decorations/decoratedwindow.h"
 #include "effect/effecthandler.h"
@@ -22,6 +24,7 @@
 #include "mousebuttons.h"
 #include "osd.h"
 #include "screenedge.h"
+#include "utils/envvar.h"
 #include "wayland/abstract_data_source.h"
 #include "wayland/display.h"
 #include "wayland/pointer.h"
@@ -149,6 +152,14 @@ void PointerInputRedirection::init()
     }
     updateAfterScreenChange();
 
+    m_coalesceMotion = environmentVariableBoolValue("KWIN_POINTER_COALESCE_MOTION").value_or(false);
+    if (m_coalesceMotion) {
+        m_pendingMotionTimer.setSingleShot(true);
+        m_pendingMotionTimer.setTimerType(Qt::PreciseTimer);
+        connect(&m_pendingMotionTimer, &QTimer::timeout, this, &PointerInputRedirection::flushPendingMotion);
+        connect(Compositor::self(), &Compositor::aboutToComposite, this, &PointerInputRedirection::flushPendingMotion);
+    }
+
     connect(waylandServer()->pointerWarp(), &PointerWarpV1::warpRequested, this, [](SurfaceInterface *surface, PointerInterface *pointer, const QPointF &point, uint32_t serial) {
         if (serial != waylandServer()->seat()->pointer()->focusedSerial()) {
             return;
@@ -204,7 +215,7 @@ public:
         if (s_counter == 0) {
             if (!s_scheduledPositions.isEmpty()) {
                 const auto pos = s_scheduledPositions.takeFirst();
-                m_pointer->processMotionInternal(pos.pos, pos.delta, pos.deltaNonAccelerated, pos.time, nullptr, pos.type);
+                m_pointer->processMotionInternal(pos.pos, pos.delta, pos.deltaNonAccelerated, pos.time, nullptr, pos.type, pos.history);
             }
         }
     }
@@ -214,9 +225,9 @@ public:
         return s_counter > 0;
     }
 
-    static void schedulePosition(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, PointerInputRedirection::MotionType type)
+    static void schedulePosition(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, PointerInputRedirection::MotionType type, const QList<PointerMotionSample> &history)
     {
-        s_scheduledPositions.append({pos, delta, deltaNonAccelerated, time, type});
+        s_scheduledPositions.append({pos, delta, deltaNonAccelerated, time, type, history});
     }
 
 private:
@@ -228,6 +239,7 @@ private:
         QPointF deltaNonAccelerated;
         std::chrono::microseconds time;
         PointerInputRedirection::MotionType type;
+        QList<PointerMotionSample> history;
     };
     static QList<ScheduledPosition> s_scheduledPositions;
 
@@ -239,27 +251,90 @@ QList<PositionUpdateBlocker::ScheduledPosition> PositionUpdateBlocker::s_schedul
 
 void PointerInputRedirection::processMotionAbsolute(const QPointF &pos, std::chrono::microseconds time, InputDevice *device)
 {
+    flushPendingMotion();
     processMotionInternal(pos, QPointF(), QPointF(), time, device, MotionType::Motion);
 }
 
 void PointerInputRedirection::processWarp(const QPointF &pos, std::chrono::microseconds time, InputDevice *device)
 {
+    flushPendingMotion();
     processMotionInternal(pos, QPointF(), QPointF(), time, device, MotionType::Warp);
 }
 
 void PointerInputRedirection::processMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device)
 {
+    if (coalesceMotion(delta, deltaNonAccelerated, time, device)) {
+        return;
+    }
     processMotionInternal(m_pos + delta, delta, deltaNonAccelerated, time, device, MotionType::Motion);
 }
 
-void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device, MotionType type)
+bool PointerInputRedirection::coalesceMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device)
+{
+    // With a locked pointer, the cursor doesn't move and the motion is only of interest
+    // to the client, which wants it as soon as possible
+    if (!m_coalesceMotion || !inited() || m_locked) {
+        flushPendingMotion();
+        return false;
+    }
+
+    if (m_pendingMotionDevice != device) {
+        flushPendingMotion();
+    }
+
+    if (m_pendingMotion.isEmpty()) {
+        m_pendingMotionDevice = device;
+
+        // The motion is processed right before the next frame is composited. If no frame
+        // comes, e.g. because the outputs are turned off, it's processed after a while anyway
+        std::chrono::milliseconds timeout(16);
+        if (Output *output = workspace()->outputAt(m_pos)) {
+            output->renderLoop()->scheduleRepaint();
+            if (output->refreshRate() > 0) {
+                timeout = std::chrono::milliseconds(2 * 1000000 / output->refreshRate() + 1);
+            }
+        }
+        m_pendingMotionTimer.start(timeout);
+    }
+
+    m_pendingMotion.append(PointerMotionSample{
+        .delta = delta,
+        .deltaUnaccelerated = deltaNonAccelerated,
+        .timestamp = time,
+    });
+    return true;
+}
+
+void PointerInputRedirection::flushPendingMotion()
+{
+    if (m_pendingMotion.isEmpty()) {
+        return;
+    }
+    m_pendingMotionTimer.stop();
+
+    const QList<PointerMotionSample> history = std::exchange(m_pendingMotion, {});
+    InputDevice *device = m_pendingMotionDevice;
+    m_pendingMotionDevice = nullptr;
+
+    QPointF delta;
+    QPointF deltaNonAccelerated;
+    for (const PointerMotionSample &sample : history) {
+        delta += sample.delta;
+        deltaNonAccelerated += sample.deltaUnaccelerated;
+    }
+
+    processMotionInternal(m_pos + delta, delta, deltaNonAccelerated, history.last().timestamp, device, MotionType::Motion, history);
+    processFrame(device);
+}
+
+void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device, MotionType type, const QList<PointerMotionSample> &history)
 {
     input()->setLastInputHandler(this);
     if (!inited()) {
         return;
     }
     if (PositionUpdateBlocker::isPositionBlocked()) {
-        PositionUpdateBlocker::schedulePosition(pos, delta, deltaNonAccelerated, time, type);
+        PositionUpdateBlocker::schedulePosition(pos, delta, deltaNonAccelerated, time, type, history);
         return;
     }
 
@@ -276,6 +351,7 @@ void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QP
         .modifiers = input()->keyboardModifiers(),
         .modifiersRelevantForShortcuts = input()->modifiersRelevantForGlobalShortcuts(),
         .timestamp = time,
+        .history = history,
     };
 
     update();
@@ -285,6 +361,7 @@ void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QP
 
 void PointerInputRedirection::processButton(uint32_t button, PointerButtonState state, std::chrono::microseconds time, InputDevice *device)
 {
+    flushPendingMotion();
     input()->setLastInputHandler(this);
     if (!inited()) {
         return;
@@ -325,6 +402,7 @@ void PointerInputRedirection::processButton(uint32_t button, PointerButtonState
 void PointerInputRedirection::processAxis(PointerAxis axis, qreal delta, qint32 deltaV120,
                                           PointerAxisSource source, bool inverted, std::chrono::microseconds time, InputDevice *device)
 {
+    flushPendingMotion();
     input()->setLastInputHandler(this);
     if (!inited()) {
         return;
@@ -354,6 +432,7 @@ void PointerInputRedirection::processAxis(PointerAxis axis, qreal delta, qint32
 
 void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
 {
+    flushPendingMotion();
     input()->setLastInputHandler(this);
     if (!inited()) {
         return;
@@ -420,6 +499,7 @@ void PointerInputRedirection::processSwipeGestureCancelled(std::chrono::microsec
 
 void PointerInputRedirection::processPinchGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
 {
+    flushPendingMotion();
     input()->setLastInputHandler(this);
     if (!inited()) {
         return;
@@ -488,6 +568,7 @@ void PointerInputRedirection::processPinchGestureCancelled(std::chrono::microsec
 
 void PointerInputRedirection::processHoldGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
 {
+    flushPendingMotion();
     if (!inited()) {
         return;
     }
@@ -537,6 +618,10 @@ void PointerInputRedirection::processFrame(KWin::InputDevice *device)
     if (!inited()) {
         return;
     }
+    if (!m_pendingMotion.isEmpty()) {
+        // the frame is sent after the coalesced motion is processed
+        return;
+    }
 
     input()->processFilters(&InputEventFilter::pointerFrame);
 }
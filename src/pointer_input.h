@@ -12,12 +12,14 @@
 
 #include "cursor.h"
 #include "input.h"
+#include "input_event.h"
 #include "utils/cursortheme.h"
 
 #include <QElapsedTimer>
 #include <QObject>
 #include <QPointF>
 #include <QPointer>
+#include <QTimer>
 
 class QWindow;
 
@@ -144,6 +146,12 @@ public:
      * @internal
      */
     void processFrame(KWin::InputDevice *device = nullptr);
+    /**
+     * Processes the relative motion events that have been coalesced since the last frame, if any.
+     *
+     * @internal
+     */
+    void flushPendingMotion();
 
 private:
     enum class EdgeBarrierType {
@@ -159,7 +167,8 @@ private:
         Motion,
         Warp
     };
-    void processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device, MotionType type);
+    void processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device, MotionType type, const QList<PointerMotionSample> &history = {});
+    bool coalesceMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device);
     void cleanupDecoration(Decoration::DecoratedWindowImpl *old, Decoration::DecoratedWindowImpl *now) override;
 
     void focusUpdate(Window *focusOld, Window *focusNow) override;
@@ -198,6 +207,10 @@ private:
     std::chrono::microseconds m_lastMoveTime = std::chrono::microseconds::zero();
     friend class PositionUpdateBlocker;
     EdgeBarrierType m_lastEdgeBarrierType = EdgeBarrierType::NormalBarrier;
+    bool m_coalesceMotion = false;
+    QList<PointerMotionSample> m_pendingMotion;
+    QPointer<InputDevice> m_pendingMotionDevice;
+    QTimer m_pendingMotionTimer;
 };
 
 class WaylandCursorImage : public QObject
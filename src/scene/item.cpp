@@ -8,9 +8,12 @@
 #include "core/outputlayer.h"
 #include "core/pixelgrid.h"
 #include "scene/scene.h"
+#include "utils/bandedregion.h"
 #include "utils/common.h"
 #include "workspace.h"
 
+#include <QVarLengthArray>
+
 namespace KWin
 {
 
@@ -282,11 +285,24 @@ void Item::updateItemToSceneTransform()
 
 QRegion Item::mapToView(const QRegion &region, const RenderView *view) const
 {
-    QRegion ret;
+    if (region.isEmpty()) {
+        return QRegion();
+    }
+
+    // mapping to the view is a pure translation, if it's by whole pixels, the region
+    // can be translated as is instead of being rebuilt rectangle by rectangle
+    const QPointF offset = mapToView(QRectF(), view).topLeft();
+    const QPoint roundedOffset = offset.toPoint();
+    if (offset.x() == roundedOffset.x() && offset.y() == roundedOffset.y()) {
+        return region.translated(roundedOffset);
+    }
+
+    QVarLengthArray<QRect, 16> rects;
+    rects.reserve(region.rectCount());
     for (QRectF rect : region) {
-        ret |= mapToView(rect, view).toAlignedRect();
+        rects.append(rect.translated(offset).toAlignedRect());
     }
-    return ret;
+    return uniteRects(rects);
 }
 
 QRectF Item::mapToView(const QRectF &rect, const RenderView *view) const
@@ -360,11 +376,12 @@ QRegion Item::paintedArea(RenderView *view, const QRegion &region) const
         }
     }
 
-    QRegion ret;
+    QVarLengthArray<QRect, 16> rects;
+    rects.reserve(parts.size());
     for (const QRectF &part : parts) {
-        ret |= scaledRect(part, 1.0 / scale).toAlignedRect();
+        rects.append(scaledRect(part, 1.0 / scale).toAlignedRect());
     }
-    return ret;
+    return uniteRects(rects);
 }
 
 void Item::stackBefore(Item *sibling)
@@ -541,6 +558,12 @@ WindowQuadList Item::buildQuads() const
 void Item::discardQuads()
 {
     m_quads.reset();
+    m_quadsSerial++;
+}
+
+quint64 Item::quadsSerial() const
+{
+    return m_quadsSerial;
 }
 
 WindowQuadList Item::quads() const
@@ -557,6 +580,11 @@ bool Item::hasRepaints(RenderView *view) const
     return it != m_repaints.end() && !it->isEmpty();
 }
 
+QRegion Item::repaints(RenderView *view) const
+{
+    return m_repaints.value(view);
+}
+
 QRegion Item::takeRepaints(RenderView *view)
 {
     auto &repaints = m_repaints[view];
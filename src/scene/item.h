@@ -149,10 +149,16 @@ public:
     void scheduleRepaint(RenderView *delegate, const QRegion &region);
     void scheduleFrame();
     bool hasRepaints(RenderView *view) const;
+    QRegion repaints(RenderView *view) const;
     QRegion takeRepaints(RenderView *delegate);
     void resetRepaints(RenderView *delegate);
 
     WindowQuadList quads() const;
+    /**
+     * Returns a number that changes every time the quads of this item are discarded. It can
+     * be used to find out whether data derived from quads() is still up to date.
+     */
+    quint64 quadsSerial() const;
     virtual void preprocess();
     const std::shared_ptr<ColorDescription> &colorDescription() const;
     RenderingIntent renderingIntent() const;
@@ -230,6 +236,7 @@ private:
     bool m_effectiveVisible = true;
     QMap<RenderView *, QRegion> m_repaints;
     mutable std::optional<WindowQuadList> m_quads;
+    quint64 m_quadsSerial = 0;
     mutable std::optional<QList<Item *>> m_sortedChildItems;
     std::shared_ptr<ColorDescription> m_colorDescription = ColorDescription::sRGB;
     RenderingIntent m_renderingIntent = RenderingIntent::Perceptual;
@@ -5,12 +5,12 @@
 */
 
 #include "scene/itemrenderer_opengl.h"
-#include "core/colorpipeline.h"
 #include "core/pixelgrid.h"
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
 #include "core/syncobjtimeline.h"
 #include "effect/effect.h"
+#include "opengl/colorpipelinecache.h"
 #include "opengl/eglnativefence.h"
 #include "scene/decorationitem.h"
 #include "scene/imageitem.h"
@@ -51,6 +51,13 @@ void ItemRendererOpenGL::endFrame()
     GLVertexBuffer::streamingBuffer()->endOfFrame();
     GLFramebuffer::popFramebuffer();
 
+    // Drop the geometry of items that are gone or haven't been painted for a while.
+    if (++m_frameCounter % 64 == 0) {
+        m_geometryCache.removeIf([this](const auto &it) {
+            return !it.value().item || m_frameCounter - it.value().lastUsedFrame > 64;
+        });
+    }
+
     if (m_eglDisplay) {
         EGLNativeFence fence(m_eglDisplay);
         if (fence.isValid()) {
@@ -98,19 +105,16 @@ static RenderGeometry clipQuads(const Item *item, const ItemRendererOpenGL::Rend
             // Scale to device coordinates, rounding as needed.
             const QRectF deviceBounds = snapToPixelGridF(scaledRect(quad.bounds(), scale));
 
-            for (const QRect &deviceClipRect : std::as_const(context->deviceClip)) {
-                const QRectF relativeDeviceClipRect = snapToPixelGridF(deviceClipRect).translated(-itemToDeviceTranslation);
-                const QRectF intersected = relativeDeviceClipRect.intersected(deviceBounds);
-                if (intersected.isValid()) {
-                    if (deviceBounds == intersected) {
-                        // case 1: completely contains, include and do not check other rects
-                        geometry.appendWindowQuad(quad, scale);
-                        break;
-                    }
-                    // case 2: intersection
+            // only the clip rects that overlap the quad are visited, and since the clip
+            // rects don't overlap, a quad inside one of them can't intersect any other
+            context->deviceClipRects.forEachIntersection(deviceBounds.translated(itemToDeviceTranslation), [&](const QRectF &deviceIntersected) {
+                const QRectF intersected = deviceIntersected.translated(-itemToDeviceTranslation);
+                if (deviceBounds == intersected) {
+                    geometry.appendWindowQuad(quad, scale);
+                } else {
                     geometry.appendSubQuad(quad, intersected, scale);
                 }
-            }
+            });
         } else {
             geometry.appendWindowQuad(quad, scale);
         }
@@ -119,6 +123,49 @@ static RenderGeometry clipQuads(const Item *item, const ItemRendererOpenGL::Rend
     return geometry;
 }
 
+RenderGeometry ItemRendererOpenGL::itemGeometry(Item *item, const RenderContext *context, const QMatrix4x4 &textureMatrix)
+{
+    const qreal scale = context->renderTargetScale;
+
+    CachedGeometry &cached = m_geometryCache[std::make_pair(item, scale)];
+    if (cached.item != item || cached.quadsSerial != item->quadsSerial() || cached.textureMatrix != textureMatrix) {
+        const WindowQuadList quads = item->quads();
+
+        cached.item = item;
+        cached.quadsSerial = item->quadsSerial();
+        cached.textureMatrix = textureMatrix;
+        cached.bounds = QRectF();
+        cached.geometry.clear();
+        cached.geometry.reserve(quads.count() * 6);
+        for (const WindowQuad &quad : quads) {
+            cached.geometry.appendWindowQuad(quad, scale);
+            cached.bounds |= snapToPixelGridF(scaledRect(quad.bounds(), scale));
+        }
+        cached.geometry.postProcessTextureCoordinates(textureMatrix);
+    }
+    cached.lastUsedFrame = m_frameCounter;
+
+    if (context->deviceClip == infiniteRegion() || context->hardwareClipping) {
+        return cached.geometry;
+    }
+
+    const QPointF itemToDeviceTranslation = context->transformStack.top().map(QPointF(0., 0.)) - context->viewportOrigin * scale;
+    const QRectF deviceBounds = cached.bounds.translated(itemToDeviceTranslation);
+    if (!context->deviceClipRects.intersects(deviceBounds)) {
+        return RenderGeometry();
+    }
+
+    // If the item lies completely within one clip rect, clipQuads() would produce the same
+    // vertices as the retained geometry, so there is no need to rebuild them.
+    if (context->deviceClipRects.containedInRect(deviceBounds)) {
+        return cached.geometry;
+    }
+
+    RenderGeometry geometry = clipQuads(item, context);
+    geometry.postProcessTextureCoordinates(textureMatrix);
+    return geometry;
+}
+
 void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter)
 {
     bool hole = false;
@@ -173,13 +220,12 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
 
     item->preprocess();
 
-    RenderGeometry geometry = clipQuads(item, context);
-
     if (auto shadowItem = qobject_cast<ShadowItem *>(item)) {
-        if (!geometry.isEmpty()) {
-            OpenGLShadowTextureProvider *textureProvider = static_cast<OpenGLShadowTextureProvider *>(shadowItem->textureProvider());
-            if (textureProvider->shadowTexture()) {
-                RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
+        OpenGLShadowTextureProvider *textureProvider = static_cast<OpenGLShadowTextureProvider *>(shadowItem->textureProvider());
+        if (textureProvider->shadowTexture()) {
+            const RenderGeometry geometry = itemGeometry(item, context, textureProvider->shadowTexture()->matrix(UnnormalizedCoordinates));
+            if (!geometry.isEmpty()) {
+                context->renderNodes.append(RenderNode{
                     .traits = ShaderTrait::MapTexture,
                     .textures = {textureProvider->shadowTexture()},
                     .geometry = geometry,
@@ -191,14 +237,14 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
                     .bufferReleasePoint = nullptr,
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(textureProvider->shadowTexture()->matrix(UnnormalizedCoordinates));
             }
         }
     } else if (auto decorationItem = qobject_cast<DecorationItem *>(item)) {
-        if (!geometry.isEmpty()) {
-            auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
-            if (renderer->texture()) {
-                RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
+        auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
+        if (renderer->texture()) {
+            const RenderGeometry geometry = itemGeometry(item, context, renderer->texture()->matrix(UnnormalizedCoordinates));
+            if (!geometry.isEmpty()) {
+                context->renderNodes.append(RenderNode{
                     .traits = ShaderTrait::MapTexture,
                     .textures = {renderer->texture()},
                     .geometry = geometry,
@@ -210,12 +256,12 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
                     .bufferReleasePoint = nullptr,
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(renderer->texture()->matrix(UnnormalizedCoordinates));
             }
         }
     } else if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
         auto texture = static_cast<OpenGLSurfaceTexture *>(surfaceItem->texture());
         if (texture && texture->isValid()) {
+            const RenderGeometry geometry = itemGeometry(item, context, texture->texture().planes.at(0)->matrix(UnnormalizedCoordinates));
             if (!geometry.isEmpty()) {
                 RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
                     .traits = texture->texture().planes.count() == 1 ? ShaderTrait::MapTexture : ShaderTrait::MapYUVTexture,
@@ -229,7 +275,6 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
                     .bufferReleasePoint = surfaceItem->bufferReleasePoint(),
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(texture->texture().planes.at(0)->matrix(UnnormalizedCoordinates));
 
                 if (!context->cornerStack.isEmpty()) {
                     const auto &top = context->cornerStack.top();
@@ -245,9 +290,10 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
             }
         }
     } else if (auto imageItem = qobject_cast<ImageItemOpenGL *>(item)) {
-        if (!geometry.isEmpty()) {
-            if (imageItem->texture()) {
-                RenderNode &renderNode = context->renderNodes.emplace_back(RenderNode{
+        if (imageItem->texture()) {
+            const RenderGeometry geometry = itemGeometry(item, context, imageItem->texture()->matrix(UnnormalizedCoordinates));
+            if (!geometry.isEmpty()) {
+                context->renderNodes.append(RenderNode{
                     .traits = ShaderTrait::MapTexture,
                     .textures = {imageItem->texture()},
                     .geometry = geometry,
@@ -259,10 +305,10 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context, co
                     .bufferReleasePoint = nullptr,
                     .paintHole = hole,
                 });
-                renderNode.geometry.postProcessTextureCoordinates(imageItem->texture()->matrix(UnnormalizedCoordinates));
             }
         }
     } else if (auto borderItem = qobject_cast<OutlinedBorderItem *>(item)) {
+        const RenderGeometry geometry = itemGeometry(item, context, QMatrix4x4());
         if (!geometry.isEmpty()) {
             const BorderOutline outline = borderItem->outline();
             const int thickness = std::round(outline.thickness() * context->renderTargetScale);
@@ -331,11 +377,15 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         return;
     }
 
+    const QRegion deviceClip = deviceRegion & renderTarget.transformedRect();
+    const bool hardwareClipping = deviceRegion != infiniteRegion() && ((mask & Scene::PAINT_WINDOW_TRANSFORMED) || (mask & Scene::PAINT_SCREEN_TRANSFORMED));
+
     RenderContext renderContext{
         .projectionMatrix = viewport.projectionMatrix(),
         .rootTransform = data.toMatrix(viewport.scale()), // TODO: unify transforms
-        .deviceClip = deviceRegion & renderTarget.transformedRect(),
-        .hardwareClipping = deviceRegion != infiniteRegion() && ((mask & Scene::PAINT_WINDOW_TRANSFORMED) || (mask & Scene::PAINT_SCREEN_TRANSFORMED)),
+        .deviceClip = deviceClip,
+        .deviceClipRects = hardwareClipping ? BandedRegion() : BandedRegion(deviceClip),
+        .hardwareClipping = hardwareClipping,
         .renderTargetScale = viewport.scale(),
         .viewportOrigin = viewport.renderRect().topLeft(),
     };
@@ -388,8 +438,17 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
 
     ShaderTraits lastTraits;
     GLShader *shader = nullptr;
+    const ColorPipelineCache::Entry *lastColorspaceUniforms = nullptr;
+    std::optional<QMatrix4x4> lastTransformMatrix;
+    std::optional<QVector4D> lastModulation;
+    bool holeBlending = false;
+    QVarLengthArray<GLTexture *, 4> boundTextures;
+    // every texture unit and target that has been bound, a unit can have a texture bound
+    // to several targets, e.g. a 2D texture and an external one
+    QVarLengthArray<std::pair<int, GLenum>, 4> boundTargets;
     for (int i = 0; i < renderContext.renderNodes.count(); i++) {
         const RenderNode &renderNode = renderContext.renderNodes[i];
+        const auto colorConversion = ColorPipelineCache::self()->lookup(renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
 
         ShaderTraits traits = renderNode.traits;
         if (renderNode.opacity != 1.0 || data.brightness() != 1.0) {
@@ -401,19 +460,22 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         if (data.brightness() != 1.0 || data.saturation() != 1.0) {
             // make sure that brightness and saturation adjustments are always applied in linear space
             traits |= ShaderTrait::TransformColorspace;
-        } else {
-            const auto colorTransformation = ColorPipeline::create(renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
-            if (!colorTransformation.isIdentity()) {
-                traits |= ShaderTrait::TransformColorspace;
-            }
+        } else if (!colorConversion->isIdentity) {
+            traits |= ShaderTrait::TransformColorspace;
         }
 
         if (renderNode.paintHole) {
             traits = (traits & ShaderTrait::RoundedCorners) | ShaderTrait::UniformColor;
-            glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            if (!holeBlending) {
+                glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                holeBlending = true;
+            }
             setBlendEnabled(true);
         } else {
-            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            if (holeBlending) {
+                glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                holeBlending = false;
+            }
             setBlendEnabled(renderNode.hasAlpha || renderNode.opacity < 1.0);
         }
 
@@ -423,6 +485,9 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
                 ShaderManager::instance()->popShader();
             }
             shader = ShaderManager::instance()->pushShader(traits);
+            lastColorspaceUniforms = nullptr;
+            lastTransformMatrix.reset();
+            lastModulation.reset();
             if (traits & ShaderTrait::AdjustSaturation) {
                 const auto toXYZ = renderTarget.colorDescription()->containerColorimetry().toXYZ();
                 shader->setUniform(GLShader::FloatUniform::Saturation, data.saturation());
@@ -436,12 +501,21 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
                 shader->setUniform(GLShader::IntUniform::Sampler1, 1);
             }
         }
-        shader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
+        if (lastTransformMatrix != renderNode.transformMatrix) {
+            shader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
+            lastTransformMatrix = renderNode.transformMatrix;
+        }
         if (traits & ShaderTrait::Modulate) {
-            shader->setUniform(GLShader::Vec4Uniform::ModulationConstant, modulate(renderNode.opacity, data.brightness()));
+            const QVector4D modulation = modulate(renderNode.opacity, data.brightness());
+            if (lastModulation != modulation) {
+                shader->setUniform(GLShader::Vec4Uniform::ModulationConstant, modulation);
+                lastModulation = modulation;
+            }
         }
-        if (traits & ShaderTrait::TransformColorspace) {
-            shader->setColorspaceUniforms(renderNode.colorDescription, renderTarget.colorDescription(), renderNode.renderingIntent);
+        if ((traits & ShaderTrait::TransformColorspace) && lastColorspaceUniforms != colorConversion.get()) {
+            // consecutive nodes usually share the color description, skip redundant uploads
+            shader->setColorspaceUniforms(colorConversion->uniforms);
+            lastColorspaceUniforms = colorConversion.get();
         }
         if (traits & ShaderTrait::MapYUVTexture) {
             shader->setUniform(GLShader::Mat4Uniform::YuvToRgb, renderNode.colorDescription->yuvMatrix());
@@ -460,22 +534,39 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
             shader->setUniform(GLShader::ColorUniform::Color, QColor(0, 0, 0, 255));
         }
 
-        for (int i = 0; i < renderNode.textures.count() && !renderNode.paintHole; ++i) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            renderNode.textures[i]->bind();
-        }
-
-        vbo->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
-                  renderNode.vertexCount, renderContext.hardwareClipping);
-
-        for (int i = 0; i < renderNode.textures.count() && !renderNode.paintHole; ++i) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            renderNode.textures[i]->unbind();
+        if (!renderNode.paintHole) {
+            // Textures stay bound until another node needs the texture unit.
+            for (int unit = 0; unit < renderNode.textures.count(); ++unit) {
+                if (unit < boundTextures.count() && boundTextures[unit] == renderNode.textures[unit]) {
+                    continue;
+                }
+                glActiveTexture(GL_TEXTURE0 + unit);
+                renderNode.textures[unit]->bind();
+                const std::pair<int, GLenum> target(unit, renderNode.textures[unit]->target());
+                if (!boundTargets.contains(target)) {
+                    boundTargets.append(target);
+                }
+                if (unit < boundTextures.count()) {
+                    boundTextures[unit] = renderNode.textures[unit];
+                } else {
+                    boundTextures.append(renderNode.textures[unit]);
+                }
+            }
         }
 
         if (renderNode.bufferReleasePoint) {
             m_releasePoints.insert(renderNode.bufferReleasePoint);
         }
+
+        vbo->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
+                  renderNode.vertexCount, renderContext.hardwareClipping);
+    }
+    for (const auto &[unit, target] : std::as_const(boundTargets)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, 0);
+    }
+    if (holeBlending) {
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     }
     if (shader) {
         // some other code assumes texture 0 is active
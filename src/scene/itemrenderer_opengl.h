@@ -9,6 +9,9 @@
 #include "opengl/glutils.h"
 #include "scene/itemrenderer.h"
 #include "scene/surfaceitem.h"
+#include "utils/bandedregion.h"
+
+#include <QPointer>
 
 #include <unordered_set>
 
@@ -55,6 +58,7 @@ public:
         const QMatrix4x4 projectionMatrix;
         const QMatrix4x4 rootTransform;
         const QRegion deviceClip;
+        const BandedRegion deviceClipRects;
         const bool hardwareClipping;
         const qreal renderTargetScale;
         const QPointF viewportOrigin;
@@ -74,12 +78,29 @@ private:
     QVector4D modulate(float opacity, float brightness) const;
     void setBlendEnabled(bool enabled);
     void createRenderNode(Item *item, RenderContext *context, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter);
+    RenderGeometry itemGeometry(Item *item, const RenderContext *context, const QMatrix4x4 &textureMatrix);
     void visualizeFractional(const RenderViewport &viewport, const QRegion &logicalRegion, const RenderContext &renderContext);
 
     bool m_blendingEnabled = false;
     EglDisplay *const m_eglDisplay;
     std::unordered_set<std::shared_ptr<SyncReleasePoint>> m_releasePoints;
 
+    /**
+     * The unclipped geometry of an item in device coordinates, retained across frames so it
+     * only needs to be rebuilt when the quads, the scale or the texture matrix change.
+     */
+    struct CachedGeometry
+    {
+        QPointer<Item> item;
+        quint64 quadsSerial = 0;
+        QMatrix4x4 textureMatrix;
+        RenderGeometry geometry;
+        QRectF bounds;
+        quint64 lastUsedFrame = 0;
+    };
+    QHash<std::pair<Item *, qreal>, CachedGeometry> m_geometryCache;
+    quint64 m_frameCounter = 0;
+
     struct
     {
         bool fractionalEnabled = false;
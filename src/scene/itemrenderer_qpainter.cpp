@@ -10,15 +10,56 @@
 #include "effect/effect.h"
 #include "scene/decorationitem.h"
 #include "scene/imageitem.h"
+#include "scene/qpainterblit.h"
 #include "scene/surfaceitem.h"
 #include "scene/workspacescene.h"
+#include "utils/envvar.h"
 #include "window.h"
 
 #include <QPainter>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
 
 namespace KWin
 {
 
+static const bool s_fastBlit = environmentVariableBoolValue("KWIN_QPAINTER_FAST_BLIT").value_or(true);
+
+/**
+ * Paints the @a source rect of the @a image at the @a target rect with the QPainterBlit kernels,
+ * if the painter state allows that, i.e. the image is painted 1:1 at an integer position.
+ */
+static bool blitImage(QPainter *painter, const QRegion &deviceClip, const QImage &image, const QRectF &target, const QRectF &source)
+{
+    if (!s_fastBlit || painter->device()->devType() != QInternal::Image || painter->compositionMode() != QPainter::CompositionMode_SourceOver) {
+        return false;
+    }
+    QImage *device = static_cast<QImage *>(painter->device());
+    if (!QPainterBlit::isSupported(device->format()) || !QPainterBlit::isSupported(image.format())) {
+        return false;
+    }
+
+    const QTransform transform = painter->combinedTransform();
+    if (transform.type() > QTransform::TxTranslate) {
+        return false;
+    }
+    const QRectF deviceRect = transform.mapRect(target);
+    const QRect alignedDeviceRect = deviceRect.toRect();
+    const QRect alignedSource = source.toRect();
+    if (QRectF(alignedDeviceRect) != deviceRect || QRectF(alignedSource) != source) {
+        return false;
+    }
+    if (alignedSource.size() != alignedDeviceRect.size() || !image.rect().contains(alignedSource)) {
+        return false;
+    }
+
+    QPainterBlit::blit(device, alignedDeviceRect.topLeft(), image, alignedSource, deviceClip, painter->opacity());
+    return true;
+}
+
 ItemRendererQPainter::ItemRendererQPainter()
     : m_painter(std::make_unique<QPainter>())
 {
@@ -35,29 +76,53 @@ std::unique_ptr<ImageItem> ItemRendererQPainter::createImageItem(Item *parent)
 
 QPainter *ItemRendererQPainter::painter() const
 {
+    // whoever paints with the painter expects the items to be painted already
+    flush();
     return m_painter.get();
 }
 
+ItemRendererQPainter::ParallelRendering ItemRendererQPainter::parallelRendering() const
+{
+    return m_parallelRendering;
+}
+
+void ItemRendererQPainter::setParallelRendering(ParallelRendering mode)
+{
+    m_parallelRendering = mode;
+}
+
 void ItemRendererQPainter::beginFrame(const RenderTarget &renderTarget, const RenderViewport &viewport)
 {
     QImage *buffer = renderTarget.image();
+    m_image = buffer;
+    m_window = viewport.renderRect().toRect();
     m_painter->begin(buffer);
-    m_painter->setWindow(viewport.renderRect().toRect());
+    m_painter->setWindow(m_window);
 }
 
 void ItemRendererQPainter::endFrame()
 {
+    flush();
     m_painter->end();
+    m_image = nullptr;
 }
 
 void ItemRendererQPainter::renderBackground(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &deviceRegion)
 {
-    m_painter->setCompositionMode(QPainter::CompositionMode_Source);
     const QRegion clipped = deviceRegion & renderTarget.transformedRect();
+    if (clipped.isEmpty()) {
+        return;
+    }
+
+    PaintCommand command{
+        .type = PaintCommand::Type::Background,
+    };
+    command.background.reserve(clipped.rectCount());
     for (const QRect &rect : clipped) {
-        m_painter->fillRect(viewport.mapFromDeviceCoordinates(rect), Qt::transparent);
+        command.background.append(viewport.mapFromDeviceCoordinates(rect));
     }
-    m_painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+    m_commands.append(std::move(command));
+    m_commandsDamage += clipped;
 }
 
 void ItemRendererQPainter::renderItem(const RenderTarget &renderTarget, const RenderViewport &viewport, Item *item, int mask, const QRegion &deviceRegion, const WindowPaintData &data, const std::function<bool(Item *)> &filter, const std::function<bool(Item *)> &holeFilter)
@@ -75,48 +140,54 @@ void ItemRendererQPainter::renderItem(const RenderTarget &renderTarget, const Re
 
     const QRegion logicalRegion = viewport.mapFromDeviceCoordinatesAligned(effectiveRegion);
 
-    m_painter->save();
-    m_painter->setClipRegion(logicalRegion);
-    m_painter->setClipping(true);
-    m_painter->setOpacity(data.opacity());
-
+    QTransform transform;
     if (mask & Scene::PAINT_WINDOW_TRANSFORMED) {
-        m_painter->translate(data.xTranslation(), data.yTranslation());
-        m_painter->scale(data.xScale(), data.yScale());
+        transform.translate(data.xTranslation(), data.yTranslation());
+        transform.scale(data.xScale(), data.yScale());
     }
 
-    renderItem(m_painter.get(), item, filter);
-
-    m_painter->restore();
+    collectItem(item, transform, std::clamp(data.opacity(), 0.0, 1.0), logicalRegion, filter);
+    m_commandsDamage += effectiveRegion & renderTarget.transformedRect();
 }
 
-void ItemRendererQPainter::renderItem(QPainter *painter, Item *item, const std::function<bool(Item *)> &filter) const
+void ItemRendererQPainter::collectItem(Item *item, const QTransform &parentTransform, qreal parentOpacity, const QRegion &clip, const std::function<bool(Item *)> &filter)
 {
     if (filter && filter(item)) {
         return;
     }
     const QList<Item *> sortedChildItems = item->sortedChildItems();
 
-    painter->save();
-    painter->translate(item->position());
-    painter->setOpacity(painter->opacity() * item->opacity());
+    QTransform transform = parentTransform;
+    transform.translate(item->position().x(), item->position().y());
+    const qreal opacity = std::clamp(parentOpacity * item->opacity(), 0.0, 1.0);
 
     for (Item *childItem : sortedChildItems) {
         if (childItem->z() >= 0) {
             break;
         }
         if (childItem->explicitVisible()) {
-            renderItem(painter, childItem, filter);
+            collectItem(childItem, transform, opacity, clip, filter);
         }
     }
 
     item->preprocess();
+    PaintCommand command{
+        .type = PaintCommand::Type::Image,
+        .transform = transform,
+        .opacity = opacity,
+        .clip = clip,
+    };
     if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
-        renderSurfaceItem(painter, surfaceItem);
+        command.type = PaintCommand::Type::Surface;
+        collectSurfaceItem(command, surfaceItem);
     } else if (auto decorationItem = qobject_cast<DecorationItem *>(item)) {
-        renderDecorationItem(painter, decorationItem);
+        command.type = PaintCommand::Type::Decoration;
+        collectDecorationItem(command, decorationItem);
     } else if (auto imageItem = qobject_cast<ImageItem *>(item)) {
-        renderImageItem(painter, imageItem);
+        collectImageItem(command, imageItem);
+    }
+    if (!command.images.isEmpty()) {
+        m_commands.append(std::move(command));
     }
 
     for (Item *childItem : sortedChildItems) {
@@ -124,14 +195,110 @@ void ItemRendererQPainter::renderItem(QPainter *painter, Item *item, const std::
             continue;
         }
         if (childItem->explicitVisible()) {
-            renderItem(painter, childItem, filter);
+            collectItem(childItem, transform, opacity, clip, filter);
         }
     }
+}
+
+void ItemRendererQPainter::flush() const
+{
+    if (m_commands.isEmpty()) {
+        return;
+    }
 
+    // Below this many repainted pixels, handing the work over to other threads costs more than it saves.
+    static constexpr qint64 parallelThreshold = 512 * 512;
+    // Bands shorter than this are not worth the per band overhead of replaying all commands.
+    static constexpr int minimumBandHeight = 64;
+
+    const QRect bounds = m_commandsDamage.boundingRect();
+    const int threadCount = QThreadPool::globalInstance()->maxThreadCount();
+
+    bool parallel = false;
+    switch (m_parallelRendering) {
+    case ParallelRendering::Never:
+        break;
+    case ParallelRendering::Automatic:
+        parallel = threadCount > 1 && qint64(bounds.width()) * bounds.height() >= parallelThreshold;
+        break;
+    case ParallelRendering::Always:
+        parallel = true;
+        break;
+    }
+
+    const int bandCount = std::min(std::max(threadCount, 1), bounds.height() / minimumBandHeight);
+    if (!parallel || bandCount < 2 || !m_image) {
+        for (const PaintCommand &command : std::as_const(m_commands)) {
+            paint(m_painter.get(), command);
+        }
+    } else {
+        QList<QRect> bands;
+        bands.reserve(bandCount);
+        for (int i = 0; i < bandCount; ++i) {
+            const int top = bounds.y() + bounds.height() * i / bandCount;
+            const int bottom = bounds.y() + bounds.height() * (i + 1) / bandCount;
+            bands.append(QRect(0, top, m_image->width(), bottom - top));
+        }
+
+        // Every band gets its own image that shares the pixels of the render target, a QImage
+        // cannot be painted by several painters at once. The commands only hold plain data, the
+        // worker threads do not touch the items.
+        uchar *bits = m_image->bits();
+        const qsizetype bytesPerLine = m_image->bytesPerLine();
+        const QImage::Format format = m_image->format();
+        const QSize deviceSize = m_image->size();
+        QtConcurrent::blockingMap(bands, [&](const QRect &band) {
+            QImage tile(bits + band.y() * bytesPerLine, band.width(), band.height(), bytesPerLine, format);
+            QPainter painter(&tile);
+            painter.setViewport(QRect(QPoint(0, -band.y()), deviceSize));
+            painter.setWindow(m_window);
+            for (const PaintCommand &command : std::as_const(m_commands)) {
+                paint(&painter, command);
+            }
+        });
+    }
+
+    m_commands.clear();
+    m_commandsDamage = QRegion();
+}
+
+void ItemRendererQPainter::paint(QPainter *painter, const PaintCommand &command) const
+{
+    painter->save();
+    switch (command.type) {
+    case PaintCommand::Type::Background:
+        painter->setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRectF &rect : command.background) {
+            painter->fillRect(rect, Qt::transparent);
+        }
+        break;
+    case PaintCommand::Type::Surface:
+    case PaintCommand::Type::Decoration:
+    case PaintCommand::Type::Image: {
+        // the fast path needs to know what the clip region is in device coordinates
+        std::optional<QRegion> deviceClip;
+        const QTransform clipTransform = painter->deviceTransform();
+        if (clipTransform.type() <= QTransform::TxTranslate && clipTransform.dx() == std::round(clipTransform.dx()) && clipTransform.dy() == std::round(clipTransform.dy())) {
+            deviceClip = command.clip.translated(int(clipTransform.dx()), int(clipTransform.dy()));
+        }
+
+        painter->setClipRegion(command.clip);
+        painter->setClipping(true);
+        painter->setWorldTransform(command.transform);
+        painter->setOpacity(command.opacity);
+        for (const PaintCommand::DrawImage &draw : command.images) {
+            if (command.type == PaintCommand::Type::Surface && deviceClip && blitImage(painter, *deviceClip, draw.image, draw.target, draw.source)) {
+                continue;
+            }
+            painter->drawImage(draw.target, draw.image, draw.source);
+        }
+        break;
+    }
+    }
     painter->restore();
 }
 
-void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem) const
+void ItemRendererQPainter::collectSurfaceItem(PaintCommand &command, SurfaceItem *surfaceItem) const
 {
     const auto surfaceTexture = static_cast<QPainterSurfaceTexture *>(surfaceItem->texture());
     if (!surfaceTexture || !surfaceTexture->isValid()) {
@@ -141,75 +308,94 @@ void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *sur
     const OutputTransform surfaceToBufferTransform = surfaceItem->bufferTransform();
     const QSizeF transformedSize = surfaceToBufferTransform.map(surfaceItem->destinationSize());
 
-    painter->save();
+    QTransform bufferTransform;
     switch (surfaceToBufferTransform.kind()) {
     case OutputTransform::Normal:
         break;
     case OutputTransform::Rotate90:
-        painter->translate(transformedSize.height(), 0);
-        painter->rotate(90);
+        bufferTransform.translate(transformedSize.height(), 0);
+        bufferTransform.rotate(90);
         break;
     case OutputTransform::Rotate180:
-        painter->translate(transformedSize.width(), transformedSize.height());
-        painter->rotate(180);
+        bufferTransform.translate(transformedSize.width(), transformedSize.height());
+        bufferTransform.rotate(180);
         break;
     case OutputTransform::Rotate270:
-        painter->translate(0, transformedSize.width());
-        painter->rotate(270);
+        bufferTransform.translate(0, transformedSize.width());
+        bufferTransform.rotate(270);
         break;
     case OutputTransform::FlipX:
-        painter->translate(transformedSize.width(), 0);
-        painter->scale(-1, 1);
+        bufferTransform.translate(transformedSize.width(), 0);
+        bufferTransform.scale(-1, 1);
         break;
     case OutputTransform::FlipX90:
-        painter->scale(-1, 1);
-        painter->rotate(90);
+        bufferTransform.scale(-1, 1);
+        bufferTransform.rotate(90);
         break;
     case OutputTransform::FlipX180:
-        painter->translate(0, transformedSize.height());
-        painter->scale(-1, 1);
-        painter->rotate(180);
+        bufferTransform.translate(0, transformedSize.height());
+        bufferTransform.scale(-1, 1);
+        bufferTransform.rotate(180);
         break;
     case OutputTransform::FlipX270:
-        painter->translate(transformedSize.height(), transformedSize.width());
-        painter->scale(-1, 1);
-        painter->rotate(270);
+        bufferTransform.translate(transformedSize.height(), transformedSize.width());
+        bufferTransform.scale(-1, 1);
+        bufferTransform.rotate(270);
         break;
     }
+    command.transform = bufferTransform * command.transform;
 
+    const QImage image = surfaceTexture->image();
     const QRectF sourceBox = surfaceItem->bufferSourceBox();
     const qreal xSourceBoxScale = sourceBox.width() / transformedSize.width();
     const qreal ySourceBoxScale = sourceBox.height() / transformedSize.height();
 
     const QList<QRectF> shape = surfaceItem->shape();
+    command.images.reserve(shape.size());
     for (const QRectF rect : shape) {
         const QRectF target = surfaceToBufferTransform.map(rect, surfaceItem->size());
         const QRectF source(sourceBox.x() + target.x() * xSourceBoxScale,
                             sourceBox.y() + target.y() * ySourceBoxScale,
                             target.width() * xSourceBoxScale,
                             target.height() * ySourceBoxScale);
-
-        painter->drawImage(target, surfaceTexture->image(), source);
+        command.images.append(PaintCommand::DrawImage{
+            .image = image,
+            .target = target,
+            .source = source,
+        });
     }
-
-    painter->restore();
 }
 
-void ItemRendererQPainter::renderDecorationItem(QPainter *painter, DecorationItem *decorationItem) const
+void ItemRendererQPainter::collectDecorationItem(PaintCommand &command, DecorationItem *decorationItem) const
 {
     const auto renderer = static_cast<const SceneQPainterDecorationRenderer *>(decorationItem->renderer());
     QRectF dtr, dlr, drr, dbr;
     decorationItem->window()->layoutDecorationRects(dlr, dtr, drr, dbr);
 
-    painter->drawImage(dtr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Top));
-    painter->drawImage(dlr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Left));
-    painter->drawImage(drr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Right));
-    painter->drawImage(dbr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom));
+    const std::pair<QRectF, SceneQPainterDecorationRenderer::DecorationPart> parts[] = {
+        {dtr, SceneQPainterDecorationRenderer::DecorationPart::Top},
+        {dlr, SceneQPainterDecorationRenderer::DecorationPart::Left},
+        {drr, SceneQPainterDecorationRenderer::DecorationPart::Right},
+        {dbr, SceneQPainterDecorationRenderer::DecorationPart::Bottom},
+    };
+    for (const auto &[target, part] : parts) {
+        const QImage image = renderer->image(part);
+        command.images.append(PaintCommand::DrawImage{
+            .image = image,
+            .target = target,
+            .source = image.rect(),
+        });
+    }
 }
 
-void ItemRendererQPainter::renderImageItem(QPainter *painter, ImageItem *imageItem) const
+void ItemRendererQPainter::collectImageItem(PaintCommand &command, ImageItem *imageItem) const
 {
-    painter->drawImage(imageItem->rect(), imageItem->image());
+    const QImage image = imageItem->image();
+    command.images.append(PaintCommand::DrawImage{
+        .image = image,
+        .target = imageItem->rect(),
+        .source = image.rect(),
+    });
 }
 
 } // namespace KWin
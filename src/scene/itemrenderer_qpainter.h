@@ -8,6 +8,14 @@
 
 #include "scene/itemrenderer.h"
 
+#include <QImage>
+#include <QList>
+#include <QRectF>
+#include <QRegion>
+#include <QTransform>
+
+#include <optional>
+
 class QPainter;
 
 namespace KWin
@@ -19,6 +27,15 @@ class SurfaceItem;
 class KWIN_EXPORT ItemRendererQPainter : public ItemRenderer
 {
 public:
+    /**
+     * Specifies whether the frame is painted in horizontal bands on worker threads.
+     */
+    enum class ParallelRendering {
+        Never,
+        Automatic, // only if the repainted area is big enough
+        Always,
+    };
+
     ItemRendererQPainter();
     ~ItemRendererQPainter() override;
 
@@ -32,13 +49,53 @@ public:
 
     std::unique_ptr<ImageItem> createImageItem(Item *parent = nullptr) override;
 
+    ParallelRendering parallelRendering() const;
+    void setParallelRendering(ParallelRendering mode);
+
 private:
-    void renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem) const;
-    void renderDecorationItem(QPainter *painter, DecorationItem *decorationItem) const;
-    void renderImageItem(QPainter *painter, ImageItem *imageItem) const;
-    void renderItem(QPainter *painter, Item *item, const std::function<bool(Item *)> &filter) const;
+    /**
+     * The items are not painted right away, but collected along with their painter state, so
+     * that the whole frame can be painted on several threads at once. The commands are painted
+     * before anyone else gets to use the painter, so the paint order is preserved.
+     *
+     * Everything that is needed to paint an item is looked up when the command is recorded,
+     * the worker threads must not touch the items, the windows or the decorations.
+     */
+    struct PaintCommand
+    {
+        enum class Type {
+            Background,
+            Surface,
+            Decoration,
+            Image,
+        };
+        struct DrawImage
+        {
+            QImage image;
+            QRectF target;
+            QRectF source;
+        };
+        Type type;
+        QTransform transform;
+        qreal opacity = 1.0;
+        QRegion clip; // in logical coordinates
+        QList<QRectF> background; // in logical coordinates
+        QList<DrawImage> images;
+    };
+
+    void collectItem(Item *item, const QTransform &transform, qreal opacity, const QRegion &clip, const std::function<bool(Item *)> &filter);
+    void collectSurfaceItem(PaintCommand &command, SurfaceItem *surfaceItem) const;
+    void collectDecorationItem(PaintCommand &command, DecorationItem *decorationItem) const;
+    void collectImageItem(PaintCommand &command, ImageItem *imageItem) const;
+    void flush() const;
+    void paint(QPainter *painter, const PaintCommand &command) const;
 
     std::unique_ptr<QPainter> m_painter;
+    QImage *m_image = nullptr;
+    QRect m_window;
+    ParallelRendering m_parallelRendering = ParallelRendering::Automatic;
+    mutable QList<PaintCommand> m_commands;
+    mutable QRegion m_commandsDamage; // in device coordinates
 };
 
 } // namespace KWin
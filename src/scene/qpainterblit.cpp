@@ -0,0 +1,340 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "scene/qpainterblit.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KWIN_BLIT_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define KWIN_BLIT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace KWin
+{
+namespace QPainterBlit
+{
+
+// The arithmetic below matches the one in qdrawhelper, x / 255 is computed as
+// (x + (x >> 8) + 0x80) >> 8. All kernels produce the same pixels as the scalar ones, which
+// match QPainter exactly unless a constant opacity is applied. In that case, QPainter either
+// interpolates or multiplies and blends, depending on the clip, so a channel may differ by one.
+
+static inline uint32_t byteMul(uint32_t x, uint32_t a)
+{
+    uint64_t t = ((uint64_t(x) | (uint64_t(x) << 24)) & 0x00ff00ff00ff00ffull) * a;
+    t = (t + ((t >> 8) & 0x00ff00ff00ff00ffull) + 0x0080008000800080ull) >> 8;
+    t &= 0x00ff00ff00ff00ffull;
+    return uint32_t(t) | uint32_t(t >> 24);
+}
+
+static inline uint32_t interpolate255(uint32_t x, uint32_t a, uint32_t y, uint32_t b)
+{
+    uint32_t t = (x & 0xff00ff) * a + (y & 0xff00ff) * b;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+    x = ((x >> 8) & 0xff00ff) * a + ((y >> 8) & 0xff00ff) * b;
+    x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+    x &= 0xff00ff00;
+    return x | t;
+}
+
+static void copyOpaqueGeneric(uint32_t *dst, const uint32_t *src, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        dst[i] = src[i] | 0xff000000;
+    }
+}
+
+static void blendOverGeneric(uint32_t *dst, const uint32_t *src, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const uint32_t s = src[i];
+        dst[i] = s + byteMul(dst[i], 255 - (s >> 24));
+    }
+}
+
+static void blendOverGeneric(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+    for (int i = 0; i < count; ++i) {
+        const uint32_t s = byteMul(src[i], opacity);
+        dst[i] = s + byteMul(dst[i], 255 - (s >> 24));
+    }
+}
+
+static void blendOpaqueGeneric(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+    for (int i = 0; i < count; ++i) {
+        dst[i] = interpolate255(src[i] | 0xff000000, opacity, dst[i], 255 - opacity);
+    }
+}
+
+#if KWIN_BLIT_AVX2
+
+static const bool s_hasAvx2 = [] {
+    // static initializers may run before the one of libgcc that fills in the cpu model
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}();
+
+__attribute__((target("avx2"))) static inline __m256i div255Avx2(__m256i t)
+{
+    t = _mm256_add_epi16(t, _mm256_srli_epi16(t, 8));
+    t = _mm256_add_epi16(t, _mm256_set1_epi16(0x80));
+    return _mm256_srli_epi16(t, 8);
+}
+
+// Replicates the alpha channel of every unpacked pixel into all of its four 16-bit lanes
+__attribute__((target("avx2"))) static inline __m256i alphaAvx2(__m256i pixels)
+{
+    pixels = _mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm256_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+__attribute__((target("avx2"))) static void copyOpaqueAvx2(uint32_t *dst, const uint32_t *src, int count)
+{
+    const __m256i alphaMask = _mm256_set1_epi32(0xff000000);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(s, alphaMask));
+    }
+    copyOpaqueGeneric(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void blendOverAvx2(uint32_t *dst, const uint32_t *src, int count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32(0xff000000);
+    const __m256i max = _mm256_set1_epi16(255);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (_mm256_testz_si256(s, s)) {
+            continue;
+        }
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, alphaMask), alphaMask)) == -1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), s);
+            continue;
+        }
+
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        const __m256i inverseAlphaLo = _mm256_sub_epi16(max, alphaAvx2(_mm256_unpacklo_epi8(s, zero)));
+        const __m256i inverseAlphaHi = _mm256_sub_epi16(max, alphaAvx2(_mm256_unpackhi_epi8(s, zero)));
+        const __m256i lo = div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inverseAlphaLo));
+        const __m256i hi = div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inverseAlphaHi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi8(s, _mm256_packus_epi16(lo, hi)));
+    }
+    blendOverGeneric(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void blendOverAvx2(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16(opacity);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+
+        const __m256i sLo = div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), alpha));
+        const __m256i sHi = div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), alpha));
+        const __m256i dLo = div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(max, alphaAvx2(sLo))));
+        const __m256i dHi = div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(max, alphaAvx2(sHi))));
+        const __m256i lo = _mm256_add_epi16(sLo, dLo);
+        const __m256i hi = _mm256_add_epi16(sHi, dHi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blendOverGeneric(dst + i, src + i, count - i, opacity);
+}
+
+__attribute__((target("avx2"))) static void blendOpaqueAvx2(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32(0xff000000);
+    const __m256i alpha = _mm256_set1_epi16(opacity);
+    const __m256i inverseAlpha = _mm256_set1_epi16(255 - opacity);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i s = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)), alphaMask);
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+
+        const __m256i lo = div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), alpha),
+                                                       _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inverseAlpha)));
+        const __m256i hi = div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), alpha),
+                                                       _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inverseAlpha)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blendOpaqueGeneric(dst + i, src + i, count - i, opacity);
+}
+
+#endif
+
+#if KWIN_BLIT_NEON
+
+static inline uint8x8_t div255Neon(uint16x8_t t)
+{
+    t = vaddq_u16(t, vshrq_n_u16(t, 8));
+    t = vaddq_u16(t, vdupq_n_u16(0x80));
+    return vshrn_n_u16(t, 8);
+}
+
+// Replicates the alpha channel of every pixel into all of its four bytes
+static inline uint8x16_t alphaNeon(uint8x16_t pixels)
+{
+    static const uint8_t indices[16] = {3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15};
+    return vqtbl1q_u8(pixels, vld1q_u8(indices));
+}
+
+static void copyOpaqueNeon(uint32_t *dst, const uint32_t *src, int count)
+{
+    const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u32(dst + i, vorrq_u32(vld1q_u32(src + i), alphaMask));
+    }
+    copyOpaqueGeneric(dst + i, src + i, count - i);
+}
+
+static void blendOverNeon(uint32_t *dst, const uint32_t *src, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint8x16_t s = vreinterpretq_u8_u32(vld1q_u32(src + i));
+        const uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(dst + i));
+        const uint8x16_t inverseAlpha = vmvnq_u8(alphaNeon(s));
+        const uint8x8_t lo = div255Neon(vmull_u8(vget_low_u8(d), vget_low_u8(inverseAlpha)));
+        const uint8x8_t hi = div255Neon(vmull_high_u8(d, inverseAlpha));
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(vaddq_u8(s, vcombine_u8(lo, hi))));
+    }
+    blendOverGeneric(dst + i, src + i, count - i);
+}
+
+static void blendOverNeon(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+    const uint8x16_t alpha = vdupq_n_u8(opacity);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t s = vreinterpretq_u8_u32(vld1q_u32(src + i));
+        s = vcombine_u8(div255Neon(vmull_u8(vget_low_u8(s), vget_low_u8(alpha))), div255Neon(vmull_high_u8(s, alpha)));
+
+        const uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(dst + i));
+        const uint8x16_t inverseAlpha = vmvnq_u8(alphaNeon(s));
+        const uint8x8_t lo = div255Neon(vmull_u8(vget_low_u8(d), vget_low_u8(inverseAlpha)));
+        const uint8x8_t hi = div255Neon(vmull_high_u8(d, inverseAlpha));
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(vaddq_u8(s, vcombine_u8(lo, hi))));
+    }
+    blendOverGeneric(dst + i, src + i, count - i, opacity);
+}
+
+static void blendOpaqueNeon(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+    const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+    const uint8x16_t alpha = vdupq_n_u8(opacity);
+    const uint8x16_t inverseAlpha = vdupq_n_u8(255 - opacity);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint8x16_t s = vreinterpretq_u8_u32(vorrq_u32(vld1q_u32(src + i), alphaMask));
+        const uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(dst + i));
+        const uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(s), vget_low_u8(alpha)), vget_low_u8(d), vget_low_u8(inverseAlpha));
+        const uint16x8_t hi = vmlal_high_u8(vmull_high_u8(s, alpha), d, inverseAlpha);
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(vcombine_u8(div255Neon(lo), div255Neon(hi))));
+    }
+    blendOpaqueGeneric(dst + i, src + i, count - i, opacity);
+}
+
+#endif
+
+void copyOpaque(uint32_t *dst, const uint32_t *src, int count)
+{
+#if KWIN_BLIT_AVX2
+    if (s_hasAvx2) {
+        return copyOpaqueAvx2(dst, src, count);
+    }
+#elif KWIN_BLIT_NEON
+    return copyOpaqueNeon(dst, src, count);
+#endif
+    copyOpaqueGeneric(dst, src, count);
+}
+
+void blendOver(uint32_t *dst, const uint32_t *src, int count)
+{
+#if KWIN_BLIT_AVX2
+    if (s_hasAvx2) {
+        return blendOverAvx2(dst, src, count);
+    }
+#elif KWIN_BLIT_NEON
+    return blendOverNeon(dst, src, count);
+#endif
+    blendOverGeneric(dst, src, count);
+}
+
+void blendOver(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+#if KWIN_BLIT_AVX2
+    if (s_hasAvx2) {
+        return blendOverAvx2(dst, src, count, opacity);
+    }
+#elif KWIN_BLIT_NEON
+    return blendOverNeon(dst, src, count, opacity);
+#endif
+    blendOverGeneric(dst, src, count, opacity);
+}
+
+void blendOpaque(uint32_t *dst, const uint32_t *src, int count, int opacity)
+{
+#if KWIN_BLIT_AVX2
+    if (s_hasAvx2) {
+        return blendOpaqueAvx2(dst, src, count, opacity);
+    }
+#elif KWIN_BLIT_NEON
+    return blendOpaqueNeon(dst, src, count, opacity);
+#endif
+    blendOpaqueGeneric(dst, src, count, opacity);
+}
+
+bool isSupported(QImage::Format format)
+{
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied;
+}
+
+void blit(QImage *target, const QPoint &position, const QImage &source, const QRect &sourceRect, const QRegion &clip, qreal opacity)
+{
+    // QPainter works with opacity in the range [0, 256], and scales it down to [0, 255] for blending
+    const int constAlpha = qRound(opacity * 256);
+    if (constAlpha <= 0) {
+        return;
+    }
+    const int alpha = (constAlpha * 255) >> 8;
+    const bool opaque = !source.hasAlphaChannel();
+
+    const QPoint offset = sourceRect.topLeft() - position;
+    const QRegion region = clip & QRect(position, sourceRect.size()) & target->rect();
+    for (const QRect &rect : region) {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            uint32_t *dst = reinterpret_cast<uint32_t *>(target->scanLine(y)) + rect.x();
+            const uint32_t *src = reinterpret_cast<const uint32_t *>(source.constScanLine(y + offset.y())) + rect.x() + offset.x();
+            if (opaque) {
+                if (constAlpha >= 256) {
+                    copyOpaque(dst, src, rect.width());
+                } else {
+                    blendOpaque(dst, src, rect.width(), alpha);
+                }
+            } else {
+                if (constAlpha >= 256) {
+                    blendOver(dst, src, rect.width());
+                } else {
+                    blendOver(dst, src, rect.width(), alpha);
+                }
+            }
+        }
+    }
+}
+
+} // namespace QPainterBlit
+} // namespace KWin
@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QImage>
+#include <QRegion>
+
+#include <cstdint>
+
+namespace KWin
+{
+
+/**
+ * Fast paths for the most common case in the QPainter compositor: a client buffer that is
+ * painted 1:1 at an integer position. Opaque copies and plain blending produce the same pixels
+ * as the raster paint engine of QPainter, with a constant opacity the result may be off by one
+ * because QPainter itself rounds differently depending on the clip. The kernels skip the span
+ * machinery of QPainter and use AVX2 or NEON if available.
+ *
+ * The row kernels work on 32-bit native endian pixels, i.e. QImage::Format_RGB32 and
+ * QImage::Format_ARGB32_Premultiplied (XRGB8888 and ARGB8888 on little endian).
+ */
+namespace QPainterBlit
+{
+
+/**
+ * Copies an opaque row, the alpha channel is set to 0xff.
+ */
+KWIN_EXPORT void copyOpaque(uint32_t *dst, const uint32_t *src, int count);
+
+/**
+ * Blends a premultiplied row over @a dst.
+ */
+KWIN_EXPORT void blendOver(uint32_t *dst, const uint32_t *src, int count);
+
+/**
+ * Blends a premultiplied row over @a dst with the given @a opacity, in the range [0, 255].
+ */
+KWIN_EXPORT void blendOver(uint32_t *dst, const uint32_t *src, int count, int opacity);
+
+/**
+ * Blends an opaque row over @a dst with the given @a opacity, in the range [0, 255].
+ */
+KWIN_EXPORT void blendOpaque(uint32_t *dst, const uint32_t *src, int count, int opacity);
+
+/**
+ * Returns @c true if the images in the given @a format can be passed to blit().
+ */
+KWIN_EXPORT bool isSupported(QImage::Format format);
+
+/**
+ * Paints the @a sourceRect of the @a source image at @a position in the @a target image,
+ * like QPainter::drawImage() with the SourceOver composition mode would do. Only the pixels
+ * inside the @a clip region are touched.
+ */
+KWIN_EXPORT void blit(QImage *target, const QPoint &position, const QImage &source, const QRect &sourceRect, const QRegion &clip, qreal opacity);
+
+} // namespace QPainterBlit
+
+} // namespace KWin
@@ -373,6 +373,7 @@ bool OpenGLSurfaceTexture::loadShmTexture(GraphicsBuffer *buffer)
 
     m_bufferType = BufferType::Shm;
     m_size = buffer->size();
+    recordUpload(view.image()->sizeInBytes());
 
     return true;
 }
@@ -399,7 +400,34 @@ void OpenGLSurfaceTexture::updateShmTexture(GraphicsBuffer *buffer, const QRegio
         return;
     }
 
-    m_texture.planes[0]->update(*view.image(), simplifyDamage(region));
+    const QRegion damage = simplifyDamage(region);
+    m_texture.planes[0]->update(*view.image(), damage);
+
+    qint64 uploadedBytes = 0;
+    for (const QRect &rect : damage) {
+        uploadedBytes += qint64(rect.width()) * rect.height() * (view.image()->depth() / 8);
+    }
+    recordUpload(uploadedBytes);
+}
+
+void OpenGLSurfaceTexture::recordUpload(qint64 bytes)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = now - m_uploadStatistics.windowStart;
+    if (elapsed >= std::chrono::seconds(1)) {
+        m_uploadStatistics.bytesPerSecond = elapsed < std::chrono::seconds(2) ? m_uploadStatistics.windowBytes : 0;
+        m_uploadStatistics.windowStart = now;
+        m_uploadStatistics.windowBytes = 0;
+    }
+    m_uploadStatistics.windowBytes += bytes;
+}
+
+qint64 OpenGLSurfaceTexture::uploadedBytesPerSecond() const
+{
+    if (std::chrono::steady_clock::now() - m_uploadStatistics.windowStart >= std::chrono::seconds(2)) {
+        return 0;
+    }
+    return m_uploadStatistics.bytesPerSecond;
 }
 
 bool OpenGLSurfaceTexture::loadDmabufTexture(GraphicsBuffer *buffer)
@@ -150,7 +150,14 @@ public:
 
     OpenGLSurfaceContents texture() const;
 
+    /**
+     * Returns the amount of shm buffer data uploaded to the texture per second, measured over
+     * the last full second.
+     */
+    qint64 uploadedBytesPerSecond() const;
+
 private:
+    void recordUpload(qint64 bytes);
     bool loadShmTexture(GraphicsBuffer *buffer);
     void updateShmTexture(GraphicsBuffer *buffer, const QRegion &region);
     bool loadDmabufTexture(GraphicsBuffer *buffer);
@@ -170,6 +177,13 @@ private:
     EglBackend *m_backend;
     SurfaceItem *m_item;
     OpenGLSurfaceContents m_texture;
+
+    struct
+    {
+        std::chrono::steady_clock::time_point windowStart;
+        qint64 windowBytes = 0;
+        qint64 bytesPerSecond = 0;
+    } m_uploadStatistics;
 };
 
 class KWIN_EXPORT QPainterSurfaceTexture : public SurfaceTexture
@@ -74,6 +74,8 @@
 #include "window.h"
 #include "workspace.h"
 
+#include <QThreadPool>
+#include <QtConcurrentMap>
 #include <QtMath>
 
 namespace KWin
@@ -94,6 +96,13 @@ WorkspaceScene::WorkspaceScene(std::unique_ptr<ItemRenderer> renderer)
         setGeometry(workspace()->geometry());
     });
 
+    const QByteArray parallelPreparation = qgetenv("KWIN_SCENE_PARALLEL_PREPARE");
+    if (parallelPreparation == QByteArrayLiteral("0")) {
+        m_parallelPreparation = ParallelPreparation::Never;
+    } else if (parallelPreparation == QByteArrayLiteral("1")) {
+        m_parallelPreparation = ParallelPreparation::Always;
+    }
+
     connect(waylandServer()->seat(), &SeatInterface::dragStarted, this, &WorkspaceScene::createDndIconItem);
     connect(waylandServer()->seat(), &SeatInterface::dragEnded, this, &WorkspaceScene::destroyDndIconItem);
 
@@ -525,25 +534,104 @@ void WorkspaceScene::preparePaintGenericScreen()
     }
 }
 
-void WorkspaceScene::preparePaintSimpleScreen()
+/**
+ * The opaque regions of the items of a window. Item::opaque() reads the state of the window,
+ * the decoration and the surface, so it is called on the main thread.
+ */
+struct WindowOpaqueSnapshot
 {
-    for (WindowItem *windowItem : std::as_const(stacking_order)) {
-        Window *window = windowItem->window();
-        WindowPrePaintData data;
-        data.mask = m_paintContext.mask;
+    const SurfaceItem *surfaceItem = nullptr;
+    QRegion surfaceOpaque;
+    const DecorationItem *decorationItem = nullptr;
+    QRegion decorationOpaque;
+};
 
-        // Clip out the decoration for opaque windows; the decoration is drawn in the second pass.
-        if (window->opacity() == 1.0) {
-            const SurfaceItem *surfaceItem = windowItem->surfaceItem();
-            if (Q_LIKELY(surfaceItem)) {
-                data.deviceOpaque = painted_delegate->mapToDeviceCoordinatesContained(surfaceItem->mapToScene(surfaceItem->borderRadius().clip(surfaceItem->opaque(), surfaceItem->rect())));
-            }
+static WindowOpaqueSnapshot snapshotWindowOpaque(const WindowItem *windowItem)
+{
+    // Clip out the decoration for opaque windows; the decoration is drawn in the second pass.
+    if (windowItem->window()->opacity() != 1.0) {
+        return WindowOpaqueSnapshot{};
+    }
 
-            const DecorationItem *decorationItem = windowItem->decorationItem();
-            if (decorationItem) {
-                data.deviceOpaque += painted_delegate->mapToDeviceCoordinatesContained(decorationItem->mapToScene(decorationItem->borderRadius().clip(decorationItem->opaque(), decorationItem->rect())));
-            }
+    WindowOpaqueSnapshot snapshot;
+    if (const SurfaceItem *surfaceItem = windowItem->surfaceItem(); Q_LIKELY(surfaceItem)) {
+        snapshot.surfaceItem = surfaceItem;
+        snapshot.surfaceOpaque = surfaceItem->opaque();
+    }
+    if (const DecorationItem *decorationItem = windowItem->decorationItem()) {
+        snapshot.decorationItem = decorationItem;
+        snapshot.decorationOpaque = decorationItem->opaque();
+    }
+    return snapshot;
+}
+
+// Only reads the geometry of the items, it can run on a worker thread.
+static QRegion windowOpaqueRegion(const SceneView *delegate, const WindowOpaqueSnapshot &snapshot)
+{
+    QRegion deviceOpaque;
+    if (snapshot.surfaceItem) {
+        const SurfaceItem *surfaceItem = snapshot.surfaceItem;
+        deviceOpaque = delegate->mapToDeviceCoordinatesContained(surfaceItem->mapToScene(surfaceItem->borderRadius().clip(snapshot.surfaceOpaque, surfaceItem->rect())));
+    }
+    if (snapshot.decorationItem) {
+        const DecorationItem *decorationItem = snapshot.decorationItem;
+        deviceOpaque += delegate->mapToDeviceCoordinatesContained(decorationItem->mapToScene(decorationItem->borderRadius().clip(snapshot.decorationOpaque, decorationItem->rect())));
+    }
+    return deviceOpaque;
+}
+
+WorkspaceScene::ParallelPreparation WorkspaceScene::parallelPreparation() const
+{
+    return m_parallelPreparation;
+}
+
+void WorkspaceScene::setParallelPreparation(ParallelPreparation mode)
+{
+    m_parallelPreparation = mode;
+}
+
+void WorkspaceScene::preparePaintSimpleScreen()
+{
+    // Below this many windows, handing the work over to other threads costs more than it saves.
+    static constexpr qsizetype parallelThreshold = 16;
+
+    bool parallel = false;
+    switch (m_parallelPreparation) {
+    case ParallelPreparation::Never:
+        break;
+    case ParallelPreparation::Automatic:
+        parallel = stacking_order.size() >= parallelThreshold && QThreadPool::globalInstance()->maxThreadCount() > 1;
+        break;
+    case ParallelPreparation::Always:
+        parallel = true;
+        break;
+    }
+
+    QList<WindowOpaqueSnapshot> snapshots;
+    snapshots.reserve(stacking_order.size());
+    for (const WindowItem *windowItem : std::as_const(stacking_order)) {
+        snapshots.append(snapshotWindowOpaque(windowItem));
+    }
+
+    // The main thread is blocked while the worker threads run, so nothing can change the items.
+    const SceneView *delegate = painted_delegate;
+    QList<QRegion> opaqueRegions;
+    if (parallel) {
+        opaqueRegions = QtConcurrent::blockingMapped<QList<QRegion>>(snapshots, [delegate](const WindowOpaqueSnapshot &snapshot) {
+            return windowOpaqueRegion(delegate, snapshot);
+        });
+    } else {
+        opaqueRegions.reserve(snapshots.size());
+        for (const WindowOpaqueSnapshot &snapshot : std::as_const(snapshots)) {
+            opaqueRegions.append(windowOpaqueRegion(delegate, snapshot));
         }
+    }
+
+    for (qsizetype i = 0; i < stacking_order.size(); ++i) {
+        WindowItem *windowItem = stacking_order[i];
+        WindowPrePaintData data;
+        data.mask = m_paintContext.mask;
+        data.deviceOpaque = opaqueRegions[i];
 
         effects->prePaintWindow(painted_delegate, windowItem->effectWindow(), data, m_expectedPresentTimestamp);
         m_paintContext.phase2Data.append(Phase2Data{
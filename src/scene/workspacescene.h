@@ -49,6 +49,20 @@ public:
 
     EglContext *openglContext() const;
 
+    enum class ParallelPreparation {
+        Never,
+        Automatic,
+        Always,
+    };
+
+    /**
+     * Controls whether the per window work in prePaint() that only reads the item tree,
+     * such as computing the opaque regions, is distributed across the global thread pool.
+     * By default, this happens only if there are many windows to process.
+     */
+    ParallelPreparation parallelPreparation() const;
+    void setParallelPreparation(ParallelPreparation mode);
+
     /**
      * Whether the Scene is able to drive animations.
      * This is used as a hint to the effects system which effects can be supported.
@@ -117,6 +131,7 @@ private:
     std::unique_ptr<Item> m_overlayItem;
     std::unique_ptr<DragAndDropIconItem> m_dndIcon;
     std::unique_ptr<CursorItem> m_cursorItem;
+    ParallelPreparation m_parallelPreparation = ParallelPreparation::Automatic;
 };
 
 } // namespace
@@ -0,0 +1,229 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "toplevelindex.h"
+#include "effect/globals.h"
+#include "virtualdesktops.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <KDecoration3/Decoration>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// The cells are large enough that most windows only span a few of them
+static const int s_cellSize = 256;
+
+ToplevelIndex::ToplevelIndex(QObject *parent)
+    : QObject(parent)
+{
+    Workspace *ws = workspace();
+    connect(ws, &Workspace::stackingOrderChanged, this, &ToplevelIndex::invalidate);
+    connect(ws, &Workspace::geometryChanged, this, &ToplevelIndex::invalidate);
+    connect(ws, &Workspace::currentActivityChanged, this, &ToplevelIndex::invalidate);
+    connect(ws, &Workspace::showingDesktopChanged, this, &ToplevelIndex::invalidate);
+    connect(ws, &Workspace::windowAdded, this, &ToplevelIndex::addWindow);
+    connect(ws, &Workspace::windowRemoved, this, &ToplevelIndex::invalidate);
+    connect(VirtualDesktopManager::self(), &VirtualDesktopManager::currentChanged, this, &ToplevelIndex::invalidate);
+
+    const auto windows = ws->windows();
+    for (Window *window : windows) {
+        addWindow(window);
+    }
+}
+
+ToplevelIndex::~ToplevelIndex() = default;
+
+void ToplevelIndex::addWindow(Window *window)
+{
+    connect(window, &Window::closed, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::desktopsChanged, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::activitiesChanged, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::minimizedChanged, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::hiddenChanged, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::hiddenByShowDesktopChanged, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::readyForPaintingChanged, this, &ToplevelIndex::invalidate);
+    connect(window, &Window::decorationChanged, this, &ToplevelIndex::invalidate);
+
+    const auto update = [this, window]() {
+        updateWindow(window);
+    };
+    connect(window, &Window::frameGeometryChanged, this, update);
+    connect(window, &Window::bufferGeometryChanged, this, update);
+    connect(window, &Window::visibleGeometryChanged, this, update);
+
+    invalidate();
+}
+
+void ToplevelIndex::invalidate()
+{
+    m_dirty = true;
+}
+
+bool ToplevelIndex::isEligible(const Window *window)
+{
+    if (window->isDeleted()) {
+        // a deleted window doesn't get mouse events
+        return false;
+    }
+    if (!window->isOnCurrentActivity() || !window->isOnCurrentDesktop() || window->isMinimized() || window->isHidden() || window->isHiddenByShowDesktop()) {
+        return false;
+    }
+    return window->readyForPainting();
+}
+
+QRectF ToplevelIndex::inputGeometry(const Window *window)
+{
+    // subsurfaces can stick out of the buffer, and the resize borders out of the frame
+    QRectF geometry = window->frameGeometry() | window->bufferGeometry() | window->visibleGeometry();
+    if (window->isDecorated()) {
+        geometry |= window->frameGeometry() + window->decoration()->resizeOnlyBorders();
+    }
+    return geometry;
+}
+
+QRect ToplevelIndex::cellsFor(const QRectF &geometry) const
+{
+    const QRect rect = geometry.toAlignedRect() & m_gridGeometry;
+    if (rect.isEmpty()) {
+        return QRect();
+    }
+    const QPoint topLeft = rect.topLeft() - m_gridGeometry.topLeft();
+    const QPoint bottomRight = rect.bottomRight() - m_gridGeometry.topLeft();
+    return QRect(QPoint(topLeft.x() / s_cellSize, topLeft.y() / s_cellSize),
+                 QPoint(bottomRight.x() / s_cellSize, bottomRight.y() / s_cellSize));
+}
+
+std::vector<Window *> *ToplevelIndex::cellAt(const QPointF &pos)
+{
+    const QPoint point = flooredPoint(pos);
+    if (!m_gridGeometry.contains(point)) {
+        return nullptr;
+    }
+    const QPoint cell = (point - m_gridGeometry.topLeft()) / s_cellSize;
+    return &m_cells[cell.y() * m_columns + cell.x()];
+}
+
+void ToplevelIndex::insert(Window *window, const Entry &entry)
+{
+    for (int y = entry.cells.top(); y <= entry.cells.bottom(); ++y) {
+        for (int x = entry.cells.left(); x <= entry.cells.right(); ++x) {
+            std::vector<Window *> &cell = m_cells[y * m_columns + x];
+            const auto it = std::upper_bound(cell.begin(), cell.end(), entry.position, [this](int position, Window *other) {
+                return position < m_entries.value(other).position;
+            });
+            cell.insert(it, window);
+        }
+    }
+}
+
+void ToplevelIndex::remove(Window *window, const Entry &entry)
+{
+    for (int y = entry.cells.top(); y <= entry.cells.bottom(); ++y) {
+        for (int x = entry.cells.left(); x <= entry.cells.right(); ++x) {
+            std::vector<Window *> &cell = m_cells[y * m_columns + x];
+            cell.erase(std::find(cell.begin(), cell.end(), window));
+        }
+    }
+}
+
+void ToplevelIndex::updateWindow(Window *window)
+{
+    if (m_dirty) {
+        return;
+    }
+    auto it = m_entries.find(window);
+    if (it == m_entries.end()) {
+        return;
+    }
+    const QRect cells = cellsFor(inputGeometry(window));
+    if (it->cells == cells) {
+        return;
+    }
+    remove(window, *it);
+    it->cells = cells;
+    insert(window, *it);
+}
+
+void ToplevelIndex::rebuild()
+{
+    m_dirty = false;
+    m_windows.clear();
+    m_entries.clear();
+    m_cells.clear();
+
+    Workspace *ws = Workspace::self();
+    if (!ws) {
+        m_gridGeometry = QRect();
+        return;
+    }
+
+    m_gridGeometry = ws->geometry();
+    m_columns = (m_gridGeometry.width() + s_cellSize - 1) / s_cellSize;
+    m_rows = (m_gridGeometry.height() + s_cellSize - 1) / s_cellSize;
+    m_cells.resize(m_columns * m_rows);
+
+    const QList<Window *> &stacking = ws->stackingOrder();
+    for (auto it = stacking.crbegin(); it != stacking.crend(); ++it) {
+        Window *window = *it;
+        if (!isEligible(window)) {
+            continue;
+        }
+        const Entry entry{
+            .position = int(m_windows.size()),
+            .cells = cellsFor(inputGeometry(window)),
+        };
+        m_windows.append(window);
+        m_entries.insert(window, entry);
+        insert(window, entry);
+    }
+}
+
+QList<Window *> ToplevelIndex::windows()
+{
+    if (m_dirty) {
+        rebuild();
+    }
+    return m_windows;
+}
+
+Window *ToplevelIndex::windowAt(const QPointF &pos, bool lockScreen)
+{
+    if (m_dirty) {
+        rebuild();
+    }
+
+    const auto accepts = [&pos, lockScreen](Window *window) {
+        if (lockScreen && !window->isLockScreen() && !window->isInputMethod() && !window->isLockScreenOverlay()) {
+            return false;
+        }
+        return window->hitTest(pos);
+    };
+
+    if (const std::vector<Window *> *cell = cellAt(pos)) {
+        for (Window *window : *cell) {
+            if (accepts(window)) {
+                return window;
+            }
+        }
+        return nullptr;
+    }
+
+    // the position is outside of the workspace, so check all windows
+    for (Window *window : std::as_const(m_windows)) {
+        if (accepts(window)) {
+            return window;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace KWin
+
+#include "moc_toplevelindex.cpp"
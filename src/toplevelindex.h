@@ -0,0 +1,80 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QRect>
+
+#include <vector>
+
+namespace KWin
+{
+
+class Window;
+
+/**
+ * The ToplevelIndex keeps the windows that can receive input, i.e. the windows on the current
+ * desktop and activity that are neither minimized nor hidden, in a uniform grid that covers the
+ * workspace. Every cell lists the windows that may intersect it from top to bottom, so hit-testing
+ * a position only has to look at a handful of windows instead of the whole stacking order.
+ *
+ * Geometry changes move a window between the cells. Changes of the stacking order or of the
+ * visibility of a window invalidate the index, it's rebuilt on the next query.
+ */
+class KWIN_EXPORT ToplevelIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ToplevelIndex(QObject *parent = nullptr);
+    ~ToplevelIndex() override;
+
+    /**
+     * Returns the topmost window that accepts input at @a pos, or @c null if there is none.
+     * If @a lockScreen is @c true, only lock screen, lock screen overlay, and input method
+     * windows are considered.
+     */
+    Window *windowAt(const QPointF &pos, bool lockScreen);
+
+    /**
+     * Returns the windows that can receive input, from top to bottom.
+     */
+    QList<Window *> windows();
+
+private:
+    struct Entry
+    {
+        int position;
+        QRect cells;
+    };
+
+    void invalidate();
+    void rebuild();
+    void addWindow(Window *window);
+    void updateWindow(Window *window);
+    void insert(Window *window, const Entry &entry);
+    void remove(Window *window, const Entry &entry);
+    QRect cellsFor(const QRectF &geometry) const;
+    std::vector<Window *> *cellAt(const QPointF &pos);
+
+    static bool isEligible(const Window *window);
+    static QRectF inputGeometry(const Window *window);
+
+    QList<Window *> m_windows;
+    QHash<Window *, Entry> m_entries;
+    std::vector<std::vector<Window *>> m_cells;
+    QRect m_gridGeometry;
+    int m_columns = 0;
+    int m_rows = 0;
+    bool m_dirty = true;
+};
+
+} // namespace KWin
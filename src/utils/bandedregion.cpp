@@ -0,0 +1,93 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/bandedregion.h"
+
+namespace KWin
+{
+
+BandedRegion::BandedRegion(const QRegion &region, const QPointF &offset)
+{
+    const int count = region.rectCount();
+    if (!count) {
+        return;
+    }
+
+    m_left.reserve(count);
+    m_right.reserve(count);
+
+    for (const QRect &rect : region) {
+        const QRectF translated = QRectF(rect).translated(offset);
+        if (m_bandTop.empty() || m_bandTop.back() != translated.top() || m_bandBottom.back() != translated.bottom()) {
+            m_bandTop.push_back(translated.top());
+            m_bandBottom.push_back(translated.bottom());
+            m_bandStart.push_back(m_left.size());
+        }
+        m_left.push_back(translated.left());
+        m_right.push_back(translated.right());
+    }
+    m_bandStart.push_back(m_left.size());
+
+    m_boundingRect = QRectF(region.boundingRect()).translated(offset);
+}
+
+bool BandedRegion::containedInRect(const QRectF &rect) const
+{
+    if (!m_boundingRect.contains(rect)) {
+        return false;
+    }
+
+    // a rectangle of the region can only contain the given rect if its band spans all of it
+    const size_t band = firstBand(rect.top());
+    if (band == m_bandTop.size() || m_bandTop[band] > rect.top() || m_bandBottom[band] < rect.bottom()) {
+        return false;
+    }
+    for (size_t i = m_bandStart[band]; i < m_bandStart[band + 1]; ++i) {
+        if (m_left[i] <= rect.left() && m_right[i] >= rect.right()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BandedRegion::intersects(const QRectF &rect) const
+{
+    if (!m_boundingRect.intersects(rect)) {
+        return false;
+    }
+    bool intersects = false;
+    forEachIntersection(rect, [&intersects](const QRectF &) {
+        intersects = true;
+    });
+    return intersects;
+}
+
+QRegion BandedRegion::toRegion() const
+{
+    std::vector<QRect> rects;
+    rects.reserve(m_left.size());
+    for (size_t band = 0; band < m_bandTop.size(); ++band) {
+        for (size_t i = m_bandStart[band]; i < m_bandStart[band + 1]; ++i) {
+            rects.push_back(QRectF(QPointF(m_left[i], m_bandTop[band]), QPointF(m_right[i], m_bandBottom[band])).toAlignedRect());
+        }
+    }
+    return uniteRects(rects);
+}
+
+QRegion uniteRects(std::span<const QRect> rects)
+{
+    if (rects.size() <= 4) {
+        QRegion region;
+        for (const QRect &rect : rects) {
+            region += rect;
+        }
+        return region;
+    }
+    const size_t middle = rects.size() / 2;
+    return uniteRects(rects.first(middle)) | uniteRects(rects.subspan(middle));
+}
+
+} // namespace KWin
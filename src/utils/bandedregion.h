@@ -0,0 +1,126 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QRegion>
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace KWin
+{
+
+/**
+ * The BandedRegion class is a read-only copy of a QRegion that is optimized for testing
+ * many rectangles against the same region, e.g. clipping the quads of every item against
+ * the device clip region of a frame.
+ *
+ * The rectangles of a QRegion are sorted in horizontal bands, from top to bottom, and from
+ * left to right within a band. BandedRegion keeps the edges of the rectangles in separate
+ * arrays, so a query only visits the bands and the rectangles that overlap it, instead of
+ * walking through all the rectangles of the region.
+ */
+class KWIN_EXPORT BandedRegion
+{
+public:
+    BandedRegion() = default;
+
+    /**
+     * Constructs a BandedRegion from the given @a region, translated by @a offset.
+     */
+    explicit BandedRegion(const QRegion &region, const QPointF &offset = QPointF());
+
+    bool isEmpty() const;
+    QRectF boundingRect() const;
+    size_t rectCount() const;
+
+    /**
+     * Returns @c true if the specified @a rect is entirely inside a single rectangle of the region.
+     */
+    bool containedInRect(const QRectF &rect) const;
+
+    /**
+     * Returns @c true if the specified @a rect overlaps the region.
+     */
+    bool intersects(const QRectF &rect) const;
+
+    /**
+     * Calls @a callback with the intersection of @a rect and every rectangle of the region
+     * that overlaps it, in the same order as the rectangles appear in the QRegion.
+     */
+    template<typename Callback>
+    void forEachIntersection(const QRectF &rect, Callback callback) const;
+
+    QRegion toRegion() const;
+
+private:
+    size_t firstBand(double top) const;
+
+    std::vector<double> m_bandTop;
+    std::vector<double> m_bandBottom;
+    std::vector<uint32_t> m_bandStart;
+    std::vector<double> m_left;
+    std::vector<double> m_right;
+    QRectF m_boundingRect;
+};
+
+inline bool BandedRegion::isEmpty() const
+{
+    return m_left.empty();
+}
+
+inline QRectF BandedRegion::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+inline size_t BandedRegion::rectCount() const
+{
+    return m_left.size();
+}
+
+inline size_t BandedRegion::firstBand(double top) const
+{
+    return std::upper_bound(m_bandBottom.begin(), m_bandBottom.end(), top) - m_bandBottom.begin();
+}
+
+template<typename Callback>
+void BandedRegion::forEachIntersection(const QRectF &rect, Callback callback) const
+{
+    const double left = rect.left();
+    const double top = rect.top();
+    const double right = rect.right();
+    const double bottom = rect.bottom();
+
+    for (size_t band = firstBand(top); band < m_bandTop.size() && m_bandTop[band] < bottom; ++band) {
+        const double y1 = std::max(top, m_bandTop[band]);
+        const double y2 = std::min(bottom, m_bandBottom[band]);
+        if (y1 >= y2) {
+            continue;
+        }
+        const auto first = m_right.begin() + m_bandStart[band];
+        const auto last = m_right.begin() + m_bandStart[band + 1];
+        for (size_t i = std::upper_bound(first, last, left) - m_right.begin(); i < m_bandStart[band + 1] && m_left[i] < right; ++i) {
+            const double x1 = std::max(left, m_left[i]);
+            const double x2 = std::min(right, m_right[i]);
+            if (x1 < x2) {
+                callback(QRectF(QPointF(x1, y1), QPointF(x2, y2)));
+            }
+        }
+    }
+}
+
+/**
+ * Returns the union of the given @a rects. The rectangles are united pairwise, which avoids
+ * the quadratic cost of adding them to a QRegion one by one.
+ */
+KWIN_EXPORT QRegion uniteRects(std::span<const QRect> rects);
+
+} // namespace KWin
@@ -8,18 +8,31 @@
 
 #include "kwin_export.h"
 
-#include <QList>
 #include <QRegion>
 
+#include <algorithm>
+#include <vector>
+
 namespace KWin
 {
 
 /**
  * The DamageJournal class is a helper that tracks last N damage regions.
+ *
+ * The regions are stored in a ring buffer of fixed capacity, so adding damage doesn't
+ * allocate in the steady state. The unions of the most recent regions are cached, so
+ * querying the same buffer age multiple times per frame (e.g. once per layer and once
+ * for the screencast stream) only unites regions once.
  */
 class KWIN_EXPORT DamageJournal
 {
 public:
+    DamageJournal()
+    {
+        m_log.resize(m_capacity);
+        m_accumulated.resize(m_capacity);
+    }
+
     /**
      * Returns the maximum number of damage regions that can be stored in the journal.
      */
@@ -34,7 +47,21 @@ public:
      */
     void setCapacity(int capacity)
     {
+        Q_ASSERT(capacity > 0);
+        if (m_capacity == capacity) {
+            return;
+        }
+        std::vector<QRegion> log(capacity);
+        const int size = std::min(m_size, capacity);
+        for (int i = 0; i < size; ++i) {
+            log[size - 1 - i] = at(i);
+        }
+        m_log = std::move(log);
+        m_accumulated.assign(capacity, QRegion());
         m_capacity = capacity;
+        m_size = size;
+        m_next = size % capacity;
+        m_accumulatedCount = 0;
     }
 
     /**
@@ -42,10 +69,10 @@ public:
      */
     void add(const QRegion &region)
     {
-        while (m_log.size() >= m_capacity) {
-            m_log.removeLast();
-        }
-        m_log.prepend(region);
+        m_log[m_next] = region;
+        m_next = (m_next + 1) % m_capacity;
+        m_size = std::min(m_size + 1, m_capacity);
+        m_accumulatedCount = 0;
     }
 
     /**
@@ -54,7 +81,8 @@ public:
      */
     void clear()
     {
-        m_log.clear();
+        m_size = 0;
+        m_accumulatedCount = 0;
     }
 
     /**
@@ -65,25 +93,45 @@ public:
      */
     QRegion accumulate(int bufferAge, const QRegion &fallback = QRegion()) const
     {
-        QRegion region;
-        if (bufferAge > 0 && bufferAge <= m_log.size()) {
-            for (int i = 0; i < bufferAge - 1; ++i) {
-                region += m_log[i];
+        if (bufferAge <= 0 || bufferAge > m_size) {
+            return fallback;
+        }
+        const int count = bufferAge - 1;
+        if (count == 0) {
+            return QRegion();
+        }
+        // m_accumulated[i] is the union of the i + 1 most recent regions
+        for (; m_accumulatedCount < count; ++m_accumulatedCount) {
+            if (m_accumulatedCount == 0) {
+                m_accumulated[0] = at(0);
+            } else {
+                m_accumulated[m_accumulatedCount] = m_accumulated[m_accumulatedCount - 1] | at(m_accumulatedCount);
             }
-        } else {
-            region = fallback;
         }
-        return region;
+        return m_accumulated[count - 1];
     }
 
     QRegion lastDamage() const
     {
-        return m_log.first();
+        Q_ASSERT(m_size > 0);
+        return at(0);
     }
 
 private:
-    QList<QRegion> m_log;
+    /**
+     * Returns the damage region that was added @a index frames ago.
+     */
+    const QRegion &at(int index) const
+    {
+        return m_log[(m_next + m_capacity - 1 - index) % m_capacity];
+    }
+
+    std::vector<QRegion> m_log;
+    mutable std::vector<QRegion> m_accumulated;
+    mutable int m_accumulatedCount = 0;
     int m_capacity = 10;
+    int m_size = 0;
+    int m_next = 0;
 };
 
 } // namespace KWin
@@ -40,6 +40,8 @@ bool TransactionEntry::isDiscarded() const
     return !surface || surface->tearingDown() || surface->client()->tearingDown();
 }
 
+static TransactionQueue *s_queue = nullptr;
+
 Transaction::Transaction()
 {
 }
@@ -65,6 +67,18 @@ bool Transaction::isReady() const
     });
 }
 
+QList<SurfaceInterface *> Transaction::surfaces() const
+{
+    QList<SurfaceInterface *> surfaces;
+    surfaces.reserve(m_entries.size());
+    for (const TransactionEntry &entry : m_entries) {
+        if (entry.surface) {
+            surfaces.append(entry.surface);
+        }
+    }
+    return surfaces;
+}
+
 Transaction *Transaction::next(SurfaceInterface *surface) const
 {
     for (const TransactionEntry &entry : m_entries) {
@@ -196,11 +210,64 @@ void Transaction::apply()
 
 void Transaction::tryApply()
 {
-    if (isReady()) {
+    if (m_queued || !isReady()) {
+        return;
+    }
+
+    if (s_queue && !s_queue->m_applying) {
+        s_queue->enqueue(this);
+    } else {
         apply();
     }
 }
 
+bool Transaction::coalesce()
+{
+    if (!s_queue || m_entries.size() != 1) {
+        return false;
+    }
+
+    TransactionEntry &entry = m_entries.front();
+    if (entry.isDiscarded() || !entry.fences.empty() || entry.state->hasFifoWaitCondition) {
+        return false;
+    }
+
+    // The damage of both states is going to be combined, so it must be in the same coordinate space.
+    const SurfaceState::Fields geometryFields = SurfaceState::Field::BufferScale | SurfaceState::Field::BufferTransform
+        | SurfaceState::Field::SourceGeometry | SurfaceState::Field::DestinationSize;
+    if (entry.state->committed & geometryFields) {
+        return false;
+    }
+
+    Transaction *queued = entry.surface->lastTransaction();
+    if (!queued || !queued->m_queued || queued->m_entries.size() != 1) {
+        return false;
+    }
+
+    TransactionEntry &queuedEntry = queued->m_entries.front();
+    if (queuedEntry.surface != entry.surface) {
+        return false;
+    }
+
+    // Offsets are relative to the previous commit, and some roles, e.g. cursors and drag
+    // icons, add them up, so each of them has to be applied on its own.
+    if (!entry.state->offset.isNull() || !queuedEntry.state->offset.isNull()) {
+        return false;
+    }
+
+    const QRegion damage = queuedEntry.state->damage;
+    const QRegion bufferDamage = queuedEntry.state->bufferDamage;
+    if (entry.state->committed & SurfaceState::Field::Buffer) {
+        queuedEntry.buffer = std::move(entry.buffer);
+    }
+    entry.state->mergeInto(queuedEntry.state.get());
+    queuedEntry.state->damage += damage;
+    queuedEntry.state->bufferDamage += bufferDamage;
+
+    delete this;
+    return true;
+}
+
 void Transaction::commit()
 {
     for (TransactionEntry &entry : m_entries) {
@@ -216,6 +283,17 @@ void Transaction::commit()
                 watchDmaBuf(&entry);
             }
         }
+    }
+
+    // If the previous state of the surface hasn't been applied yet, there is no need to apply both.
+    if (coalesce()) {
+        return;
+    }
+
+    for (TransactionEntry &entry : m_entries) {
+        if (!entry.surface) {
+            continue;
+        }
 
         if (entry.surface->firstTransaction()) {
             Transaction *lastTransaction = entry.surface->lastTransaction();
@@ -286,4 +364,52 @@ void Transaction::watchDmaBuf(TransactionEntry *entry)
 #endif
 }
 
+TransactionQueue::TransactionQueue(QObject *parent)
+    : QObject(parent)
+{
+    Q_ASSERT(!s_queue);
+    s_queue = this;
+}
+
+TransactionQueue::~TransactionQueue()
+{
+    s_queue = nullptr;
+
+    // Transactions that are still in the queue have no other owner.
+    apply();
+}
+
+TransactionQueue *TransactionQueue::self()
+{
+    return s_queue;
+}
+
+bool TransactionQueue::isEmpty() const
+{
+    return m_transactions.empty();
+}
+
+void TransactionQueue::enqueue(Transaction *transaction)
+{
+    transaction->m_queued = true;
+    m_transactions.push_back(transaction);
+    Q_EMIT transactionQueued(transaction);
+}
+
+void TransactionQueue::apply()
+{
+    if (m_applying) {
+        return;
+    }
+
+    m_applying = true;
+    const std::vector<Transaction *> transactions = std::exchange(m_transactions, {});
+    for (Transaction *transaction : transactions) {
+        transaction->apply();
+    }
+    m_applying = false;
+}
+
 } // namespace KWin
+
+#include "moc_transaction.cpp"
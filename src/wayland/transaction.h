@@ -8,6 +8,7 @@
 
 #include "core/graphicsbuffer.h"
 
+#include <QObject>
 #include <QPointer>
 #include <QSocketNotifier>
 
@@ -102,6 +103,11 @@ public:
      */
     bool isReady() const;
 
+    /**
+     * Returns the surfaces that are affected by this transaction.
+     */
+    QList<SurfaceInterface *> surfaces() const;
+
     /**
      * Returns the next transaction for the specified \a surface. If this transaction does
      * not affect the given surface, \c null is returned.
@@ -138,16 +144,71 @@ public:
      * Attempts to apply the transaction. The transaction won't be applied if it has unresolved
      * dependencies, for example previous transactions have not been applied yet, or one of the
      * graphics buffers in the transaction is not ready to be used yet.
+     *
+     * If there is a TransactionQueue, a ready transaction is put in the queue instead.
      */
     void tryApply();
 
 private:
     void apply();
+    bool coalesce();
 
     void watchSyncObj(TransactionEntry *entry);
     void watchDmaBuf(TransactionEntry *entry);
 
     std::vector<TransactionEntry> m_entries;
+    bool m_queued = false;
+
+    friend class TransactionQueue;
+};
+
+/**
+ * \internal
+ *
+ * The TransactionQueue collects the transactions that are ready to be applied, so they can be
+ * applied in one batch, for example right before the next frame is composited, rather than
+ * as soon as the client commits the surface state.
+ *
+ * While a transaction sits in the queue, the following commits of the same surface are merged
+ * into it when possible, so the state changes of a surface that commits several times per frame
+ * are only applied and announced once.
+ *
+ * Only one queue can exist at a time. If there is none, transactions are applied immediately.
+ */
+class KWIN_EXPORT TransactionQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransactionQueue(QObject *parent = nullptr);
+    ~TransactionQueue() override;
+
+    static TransactionQueue *self();
+
+    /**
+     * Returns \c true if there are no transactions waiting to be applied; otherwise returns \c false.
+     */
+    bool isEmpty() const;
+
+    /**
+     * Applies the queued transactions in the order they have become ready. Transactions that
+     * become ready while the queue is being applied are applied immediately.
+     */
+    void apply();
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when the specified \a transaction is put in the queue.
+     */
+    void transactionQueued(Transaction *transaction);
+
+private:
+    void enqueue(Transaction *transaction);
+
+    std::vector<Transaction *> m_transactions;
+    bool m_applying = false;
+
+    friend class Transaction;
 };
 
 } // namespace KWin
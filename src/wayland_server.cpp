@@ -14,6 +14,7 @@
 #include "core/drmdevice.h"
 #include "core/output.h"
 #include "core/outputbackend.h"
+#include "core/renderloop.h"
 #include "core/session.h"
 #include "idle_inhibition.h"
 #include "inputpanelv1integration.h"
@@ -75,8 +76,10 @@
 #include "wayland/shadow.h"
 #include "wayland/singlepixelbuffer.h"
 #include "wayland/subcompositor.h"
+#include "wayland/surface.h"
 #include "wayland/tablet_v2.h"
 #include "wayland/tearingcontrol_v1.h"
+#include "wayland/transaction.h"
 #include "wayland/viewporter.h"
 #include "wayland/xdgactivation_v1.h"
 #include "wayland/xdgdecoration_v1.h"
@@ -102,6 +105,7 @@
 // Qt
 #include <QDir>
 #include <QFileInfo>
+#include <QTimer>
 
 // system
 #include <sys/socket.h>
@@ -251,6 +255,9 @@ void WaylandServer::registerWindow(Window *window)
         });
     }
     m_windows << window;
+    if (window->surface()) {
+        m_windowsBySurface.insert(window->surface(), window);
+    }
 }
 
 void WaylandServer::registerXdgToplevelWindow(XdgToplevelWindow *window)
@@ -531,9 +538,50 @@ bool WaylandServer::init()
     m_toplevelTag = new XdgToplevelTagManagerV1(m_display, m_display);
     m_colorRepresentation = new ColorRepresentationManagerV1(m_display, m_display);
     m_pointerWarp = new PointerWarpV1(m_display, m_display);
+
+    if (environmentVariableBoolValue("KWIN_DEFER_SURFACE_COMMITS").value_or(false)) {
+        m_transactionQueue = new TransactionQueue(m_display);
+        connect(m_transactionQueue, &TransactionQueue::transactionQueued, this, &WaylandServer::handleTransactionQueued);
+
+        // If no frame is going to be composited, e.g. because the outputs are off, apply the commits anyway.
+        m_transactionQueueTimer = new QTimer(this);
+        m_transactionQueueTimer->setSingleShot(true);
+        m_transactionQueueTimer->setInterval(std::chrono::milliseconds(50));
+        connect(m_transactionQueueTimer, &QTimer::timeout, this, &WaylandServer::applyQueuedTransactions);
+    }
     return true;
 }
 
+void WaylandServer::handleTransactionQueued(Transaction *transaction)
+{
+    bool scheduled = false;
+    const QList<SurfaceInterface *> surfaces = transaction->surfaces();
+    for (SurfaceInterface *surface : surfaces) {
+        const QList<OutputInterface *> outputs = surface->outputs();
+        for (OutputInterface *output : outputs) {
+            if (Output *handle = output->handle()) {
+                handle->renderLoop()->scheduleRepaint();
+                scheduled = true;
+            }
+        }
+    }
+
+    if (!scheduled) {
+        // The surface is not on any output (yet), so there is no frame to wait for.
+        QMetaObject::invokeMethod(this, &WaylandServer::applyQueuedTransactions, Qt::QueuedConnection);
+    } else if (!m_transactionQueueTimer->isActive()) {
+        m_transactionQueueTimer->start();
+    }
+}
+
+void WaylandServer::applyQueuedTransactions()
+{
+    if (m_transactionQueue) {
+        m_transactionQueueTimer->stop();
+        m_transactionQueue->apply();
+    }
+}
+
 static const bool s_reenableWlDrm = environmentVariableBoolValue("KWIN_WAYLAND_REENABLE_WL_DRM").value_or(false);
 
 DrmClientBufferIntegration *WaylandServer::drm()
@@ -762,29 +810,30 @@ void WaylandServer::destroyInputMethodConnection()
 void WaylandServer::removeWindow(Window *c)
 {
     m_windows.removeAll(c);
+    if (c->surface()) {
+        if (auto it = m_windowsBySurface.find(c->surface()); it != m_windowsBySurface.end() && *it == c) {
+            m_windowsBySurface.erase(it);
+        }
+    } else {
+        // the surface is already gone, so the window can't be looked up by it
+        m_windowsBySurface.removeIf([c](const auto &entry) {
+            return entry.value() == c;
+        });
+    }
     if (c->readyForPainting()) {
         Q_EMIT windowRemoved(c);
     }
 }
 
-static Window *findWindowInList(const QList<Window *> &windows, const SurfaceInterface *surface)
-{
-    auto it = std::find_if(windows.begin(), windows.end(), [surface](Window *w) {
-        return w->surface() == surface;
-    });
-    if (it == windows.end()) {
-        return nullptr;
-    }
-    return *it;
-}
-
 Window *WaylandServer::findWindow(const SurfaceInterface *surface) const
 {
     if (!surface) {
         return nullptr;
     }
-    if (Window *c = findWindowInList(m_windows, surface)) {
-        return c;
+    // the surface might have been destroyed and its address reused by now
+    Window *window = m_windowsBySurface.value(surface);
+    if (window && window->surface() == surface) {
+        return window;
     }
     return nullptr;
 }
@@ -14,6 +14,8 @@
 #include <QPointer>
 #include <QSet>
 
+class QTimer;
+
 namespace KWin
 {
 
@@ -70,6 +72,8 @@ class AlphaModifierManagerV1;
 class FifoManagerV1;
 class SinglePixelBufferManagerV1;
 class ColorRepresentationManagerV1;
+class Transaction;
+class TransactionQueue;
 
 class KWIN_EXPORT WaylandServer : public QObject
 {
@@ -227,6 +231,14 @@ public:
 
     void setRenderBackend(RenderBackend *backend);
 
+    /**
+     * Applies the surface commits that have been deferred until the next frame, if any.
+     *
+     * Surface commits are only deferred if the KWIN_DEFER_SURFACE_COMMITS environment
+     * variable is set.
+     */
+    void applyQueuedTransactions();
+
 Q_SIGNALS:
     void windowAdded(KWin::Window *);
     void windowRemoved(KWin::Window *);
@@ -245,6 +257,7 @@ private:
     void handleOutputRemoved(Output *output);
     void handleOutputEnabled(Output *output);
     void handleOutputDisabled(Output *output);
+    void handleTransactionQueued(Transaction *transaction);
 
     class LockScreenPresentationWatcher : public QObject
     {
@@ -289,6 +302,7 @@ private:
     PresentationTime *m_presentationTime = nullptr;
     LinuxDrmSyncObjV1Interface *m_linuxDrmSyncObj = nullptr;
     QList<Window *> m_windows;
+    QHash<const SurfaceInterface *, Window *> m_windowsBySurface;
     QHash<Output *, OutputInterface *> m_waylandOutputs;
     QHash<Output *, OutputDeviceV2Interface *> m_waylandOutputDevices;
     DrmLeaseManagerV1 *m_leaseManager = nullptr;
@@ -302,6 +316,8 @@ private:
     XdgToplevelTagManagerV1 *m_toplevelTag = nullptr;
     ColorRepresentationManagerV1 *m_colorRepresentation = nullptr;
     PointerWarpV1 *m_pointerWarp = nullptr;
+    TransactionQueue *m_transactionQueue = nullptr;
+    QTimer *m_transactionQueueTimer = nullptr;
     KWIN_SINGLETON(WaylandServer)
 };
 
@@ -692,6 +692,7 @@ void Workspace::addX11Window(X11Window *window)
     }
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
+    addToWindowIndex(window);
     addToStack(window);
     window->updateLayer();
     if (window->isDesktop()) {
@@ -711,6 +712,7 @@ void Workspace::addUnmanaged(X11Window *window)
 {
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
+    addToWindowIndex(window);
     addToStack(window);
     updateXStackingOrder();
     updateStackingOrder(true);
@@ -734,6 +736,7 @@ void Workspace::removeUnmanaged(X11Window *window)
 {
     Q_ASSERT(m_windows.contains(window));
     m_windows.removeOne(window);
+    removeFromWindowIndex(window);
     Q_EMIT windowRemoved(window);
 }
 #endif
@@ -769,6 +772,7 @@ void Workspace::addWaylandWindow(Window *window)
     }
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
+    addToWindowIndex(window);
     addToStack(window);
 
     const bool shouldActivate = window->wantsInput() && !window->isPopupWindow()
@@ -810,6 +814,7 @@ void Workspace::removeWindow(Window *window)
     }
 
     m_windows.removeAll(window);
+    removeFromWindowIndex(window);
     if (window == m_delayFocusWindow) {
         cancelDelayFocus();
     }
@@ -1851,19 +1856,54 @@ X11Window *Workspace::findUnmanaged(std::function<bool(const X11Window *)> func)
 
 X11Window *Workspace::findUnmanaged(xcb_window_t w) const
 {
-    return findUnmanaged([w](const X11Window *u) {
-        return u->window() == w;
-    });
+    return m_x11Unmanaged.value(w);
 }
 
 X11Window *Workspace::findClient(xcb_window_t w) const
 {
-    return findClient([w](const X11Window *c) {
-        return c->window() == w;
-    });
+    return m_x11Clients.value(w);
 }
 #endif
 
+void Workspace::addToWindowIndex(Window *window)
+{
+    m_windowsById.insert(window->internalId(), window);
+#if KWIN_BUILD_X11
+    if (X11Window *x11Window = qobject_cast<X11Window *>(window)) {
+        auto &index = x11Window->isUnmanaged() ? m_x11Unmanaged : m_x11Clients;
+        // An unmanaged window can be mapped again before the old X11Window is released,
+        // the lookup keeps returning the one that was added first until it's gone
+        if (!index.contains(x11Window->window())) {
+            index.insert(x11Window->window(), x11Window);
+        }
+    }
+#endif
+}
+
+void Workspace::removeFromWindowIndex(Window *window)
+{
+    m_windowsById.remove(window->internalId());
+#if KWIN_BUILD_X11
+    if (X11Window *x11Window = qobject_cast<X11Window *>(window)) {
+        const bool unmanaged = x11Window->isUnmanaged();
+        auto &index = unmanaged ? m_x11Unmanaged : m_x11Clients;
+        const auto it = index.find(x11Window->window());
+        if (it == index.end() || *it != x11Window) {
+            return;
+        }
+        index.erase(it);
+
+        for (Window *other : std::as_const(m_windows)) {
+            X11Window *candidate = qobject_cast<X11Window *>(other);
+            if (candidate && candidate->isUnmanaged() == unmanaged && candidate->window() == x11Window->window()) {
+                index.insert(candidate->window(), candidate);
+                break;
+            }
+        }
+    }
+#endif
+}
+
 Window *Workspace::findWindow(std::function<bool(const Window *)> func) const
 {
     return Window::findInList(m_windows, func);
@@ -1871,9 +1911,7 @@ Window *Workspace::findWindow(std::function<bool(const Window *)> func) const
 
 Window *Workspace::findWindow(const QUuid &internalId) const
 {
-    return findWindow([internalId](const KWin::Window *l) -> bool {
-        return internalId == l->internalId();
-    });
+    return m_windowsById.value(internalId);
 }
 
 void Workspace::forEachWindow(std::function<void(Window *)> func)
@@ -1922,6 +1960,7 @@ void Workspace::addInternalWindow(InternalWindow *window)
 {
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
+    addToWindowIndex(window);
     addToStack(window);
 
     setupWindowConnections(window);
@@ -1944,6 +1983,7 @@ void Workspace::addInternalWindow(InternalWindow *window)
 void Workspace::removeInternalWindow(InternalWindow *window)
 {
     m_windows.removeOne(window);
+    removeFromWindowIndex(window);
 
     updateStackingOrder();
     Q_EMIT windowRemoved(window);
@@ -20,9 +20,11 @@
 // KF
 #include <netwm_def.h>
 // Qt
+#include <QHash>
 #include <QList>
 #include <QStringList>
 #include <QTimer>
+#include <QUuid>
 // std
 #include <functional>
 #include <memory>
@@ -610,6 +612,8 @@ private:
     void activateWindowOnDesktop(VirtualDesktop *desktop);
     Window *findWindowToActivateOnDesktop(VirtualDesktop *desktop);
     void removeWindow(Window *window);
+    void addToWindowIndex(Window *window);
+    void removeFromWindowIndex(Window *window);
 
     void updateOutputConfiguration();
     void updateOutputs(const std::optional<QList<Output *>> &outputOrder = std::nullopt);
@@ -653,6 +657,13 @@ private:
     QList<Window *> m_windows;
     QList<Window *> deleted;
 
+    // Lookup tables for m_windows
+    QHash<QUuid, Window *> m_windowsById;
+#if KWIN_BUILD_X11
+    QHash<xcb_window_t, X11Window *> m_x11Clients;
+    QHash<xcb_window_t, X11Window *> m_x11Unmanaged;
+#endif
+
     QList<Window *> unconstrained_stacking_order; // Topmost last
     QList<Window *> stacking_order; // Topmost last
     QList<Window *> should_get_focus; // Last is most recent